@@ -13,6 +13,10 @@ struct Pos {
     usize col;
 
     auto operator<=>(Pos const &) const = default;
+
+    Hash hash() const {
+        return Karm::hash(row, col);
+    }
 };
 
 enum struct Wheight {
@@ -0,0 +1,338 @@
+#include <karm-async/promise.h>
+#include <karm-cli/args.h>
+#include <karm-json/values.h>
+#include <karm-net/http/http.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/socket.h>
+#include <karm-sys/time.h>
+
+namespace Loadgen {
+
+// Responses with a bigger header are treated as failures.
+static constexpr usize MAX_HEADER = 16 * 1024;
+
+static constexpr Str USER_AGENT = "Karm Loadgen/" stringify$(__ck_version_value);
+
+struct Options {
+    u16 port = 8080;
+    Str path = "/";
+    usize connections = 16;
+
+    // When zero, requests are sent until `duration` has elapsed.
+    usize requests = 0;
+    TimeSpan duration = TimeSpan::fromSecs(10);
+
+    // Requests per second over all the connections,
+    // zero sends them as fast as the server answers.
+    usize rate = 0;
+};
+
+struct Bench {
+    Options options;
+    String request;
+
+    TimeSpan start{};
+    TimeSpan end{};
+    usize claimed = 0;
+
+    usize errors = 0;   // Responses that aren't 2xx
+    usize failures = 0; // Requests that never got a response
+    usize connects = 0;
+    usize bytes = 0;
+    Vec<TimeSpan> latencies;
+
+    // When the next request is due, or NONE once the run is over.
+    //
+    // At a fixed rate, requests follow a single schedule shared by
+    // all connections and their latency is measured from when they
+    // were due. A server falling behind shows up in the latency
+    // instead of just slowing the run down.
+    Opt<TimeSpan> claim() {
+        if (options.requests and claimed >= options.requests)
+            return NONE;
+
+        TimeSpan due = Sys::uptime();
+        if (options.rate)
+            due = start + TimeSpan::fromUSecs(claimed * 1000000 / options.rate);
+
+        if (not options.requests and due >= start + options.duration)
+            return NONE;
+
+        claimed++;
+        return due;
+    }
+};
+
+static Async::Task<usize> _fillAsync(Sys::TcpConnection &conn, Buf<u8> &buf) {
+    Array<u8, 4096> chunk;
+    auto len = co_trya$(conn.readAsync(mutBytes(chunk)));
+    if (len == 0)
+        co_return Error::unexpectedEof();
+    buf.insert(COPY, buf.len(), chunk.buf(), len);
+    co_return Ok(len);
+}
+
+// Read one response and skip its body, the connection
+// should be closed afterward if it returns false.
+// `responded` is set as soon as any byte of it arrived.
+static Async::Task<bool> _recvAsync(Bench &bench, Sys::TcpConnection &conn, Buf<u8> &buf, bool &responded) {
+    usize scanned = 0;
+    while (true) {
+        if (auto end = Net::Http::endOfHeader(next(bytes(buf), scanned))) {
+            scanned += end.unwrap();
+            break;
+        }
+        scanned = buf.len() > 3 ? buf.len() - 3 : 0;
+        if (buf.len() > MAX_HEADER)
+            co_return Error::invalidData("response header too large");
+        co_trya$(_fillAsync(conn, buf));
+        responded = true;
+    }
+
+    Io::SScan scan{Str{(char const *)buf.buf(), scanned}};
+    auto resp = co_try$(Net::Http::Response::parse(scan));
+
+    auto contentLength = resp.tryGet("Content-Length");
+    if (not contentLength)
+        co_return Error::invalidData("response without a content length");
+    usize remaining = co_try$(Io::atou(contentLength.unwrap()));
+
+    if (Net::Http::codeClass(resp.code) != Net::Http::CodeClass::SUCCESS)
+        bench.errors++;
+    bool keepAlive = resp.keepAlive();
+
+    bench.bytes += scanned + remaining;
+    buf.removeRange(0, scanned);
+
+    while (remaining) {
+        if (buf.len() == 0)
+            co_trya$(_fillAsync(conn, buf));
+        usize skip = min(remaining, buf.len());
+        buf.removeRange(0, skip);
+        remaining -= skip;
+    }
+
+    co_return Ok(keepAlive);
+}
+
+static Async::Task<bool> _exchangeAsync(Bench &bench, Sys::TcpConnection &conn, Buf<u8> &buf, bool &responded) {
+    co_trya$(Net::Http::writeAllAsync(conn, bytes(bench.request)));
+    co_return co_await _recvAsync(bench, conn, buf, responded);
+}
+
+static Res<Sys::TcpConnection> _connect(Bench &bench, Buf<u8> &buf) {
+    auto conn = try$(Sys::TcpConnection::connect(Sys::Ip4::localhost(bench.options.port)));
+    buf.trunc(0);
+    bench.connects++;
+    return Ok(std::move(conn));
+}
+
+// Send requests one after the other on a keep-alive connection,
+// reconnecting when the server closes it or the exchange fails.
+// Only failing to connect at all ends the worker.
+Async::Task<> workerAsync(Bench &bench) {
+    Opt<Sys::TcpConnection> conn = NONE;
+    Buf<u8> buf;
+
+    while (auto due = bench.claim()) {
+        if (due.unwrap() > Sys::uptime())
+            co_trya$(Sys::globalSched().sleepAsync(Sys::now() + (due.unwrap() - Sys::uptime())));
+
+        bool reused = conn.has();
+        if (not conn)
+            conn = co_try$(_connect(bench, buf));
+
+        bool responded = false;
+        auto keepAlive = co_await _exchangeAsync(bench, conn.unwrap(), buf, responded);
+
+        // The server may have closed the connection while it was idle,
+        // the request gets one more chance on a fresh connection.
+        if (not keepAlive and reused and not responded) {
+            conn = co_try$(_connect(bench, buf));
+            keepAlive = co_await _exchangeAsync(bench, conn.unwrap(), buf, responded);
+        }
+
+        if (not keepAlive) {
+            bench.failures++;
+            conn = NONE;
+            continue;
+        }
+
+        bench.latencies.pushBack(Sys::uptime() - due.unwrap());
+
+        if (not keepAlive.unwrap())
+            conn = NONE;
+    }
+
+    co_return Ok();
+}
+
+Async::Task<> runAsync(Bench &bench) {
+    bench.request = co_try$(Io::format(
+        "GET {} HTTP/1.1\r\n"
+        "Host: localhost:{}\r\n"
+        "User-Agent: {}\r\n"
+        "\r\n",
+        bench.options.path,
+        bench.options.port,
+        USER_AGENT
+    ));
+
+    // Workers can fail before their first suspension,
+    // so the future is taken before any of them start.
+    Async::Promise<> done;
+    auto finished = done.future();
+    usize running = bench.options.connections;
+    Opt<Error> firstError = NONE;
+
+    bench.start = Sys::uptime();
+    for (usize i = 0; i < bench.options.connections; i++) {
+        Async::detach(workerAsync(bench), [&](Res<> res) {
+            if (not res and not firstError)
+                firstError = res.none();
+            if (--running == 0)
+                done.resolve(Ok());
+        });
+    }
+    co_trya$(finished);
+    bench.end = Sys::uptime();
+
+    // Only give up when nothing at all went through.
+    if (firstError and bench.latencies.len() == 0)
+        co_return firstError.unwrap();
+    co_return Ok();
+}
+
+// MARK: Report ----------------------------------------------------------------
+
+struct Report {
+    usize requests;
+    usize errors;
+    usize failures;
+    usize connects;
+    usize bytes;
+    TimeSpan elapsed;
+    usize reqPerSec;
+    Array<TimeSpan, 4> percentiles;
+};
+
+static constexpr Array<usize, 4> PERCENTILES = {500, 900, 990, 999};
+static constexpr Array<Str, 4> PERCENTILE_NAMES = {"p50", "p90", "p99", "p99.9"};
+
+Report report(Bench &bench) {
+    sort(bench.latencies);
+
+    Report r{
+        .requests = bench.latencies.len(),
+        .errors = bench.errors,
+        .failures = bench.failures,
+        .connects = bench.connects,
+        .bytes = bench.bytes,
+        .elapsed = bench.end - bench.start,
+        .reqPerSec = 0,
+        .percentiles = {},
+    };
+
+    if (r.elapsed.toUSecs())
+        r.reqPerSec = r.requests * 1000000 / r.elapsed.toUSecs();
+
+    // Nearest rank, the smallest latency at least that
+    // many thousandths of the requests didn't exceed.
+    if (r.requests) {
+        for (usize i = 0; i < PERCENTILES.len(); i++) {
+            usize rank = (r.requests * PERCENTILES[i] + 999) / 1000;
+            r.percentiles[i] = bench.latencies[max(rank, 1uz) - 1];
+        }
+    }
+
+    return r;
+}
+
+void printText(Options const &options, Report const &r) {
+    Sys::println("{} requests in {}ms over {} connections to http://localhost:{}{}", r.requests, r.elapsed.toMSecs(), options.connections, options.port, options.path);
+    if (options.rate)
+        Sys::println("  target:   {} req/s", options.rate);
+    Sys::println("  rate:     {} req/s, {} KiB/s", r.reqPerSec, r.elapsed.toUSecs() ? r.bytes * 1000000 / r.elapsed.toUSecs() / 1024 : 0);
+    Sys::println("  errors:   {} non-2xx, {} failed, {} connects", r.errors, r.failures, r.connects);
+    for (usize i = 0; i < PERCENTILES.len(); i++)
+        Sys::println("  {}:\t{}us", PERCENTILE_NAMES[i], r.percentiles[i].toUSecs());
+}
+
+Res<> printJson(Options const &options, Report const &r) {
+    Json::Object latency;
+    for (usize i = 0; i < PERCENTILES.len(); i++)
+        latency.put(String{PERCENTILE_NAMES[i]}, (Json::Integer)r.percentiles[i].toUSecs());
+
+    Json::Object obj;
+    obj.put("port"s, (Json::Integer)options.port);
+    obj.put("path"s, String{options.path});
+    obj.put("connections"s, (Json::Integer)options.connections);
+    obj.put("rate"s, (Json::Integer)options.rate);
+    obj.put("requests"s, (Json::Integer)r.requests);
+    obj.put("errors"s, (Json::Integer)r.errors);
+    obj.put("failures"s, (Json::Integer)r.failures);
+    obj.put("connects"s, (Json::Integer)r.connects);
+    obj.put("bytes"s, (Json::Integer)r.bytes);
+    obj.put("elapsedUs"s, (Json::Integer)r.elapsed.toUSecs());
+    obj.put("reqPerSec"s, (Json::Integer)r.reqPerSec);
+    obj.put("latencyUs"s, latency);
+
+    Sys::println("{}", try$(Json::stringify(obj)));
+    return Ok();
+}
+
+} // namespace Loadgen
+
+Async::Task<> entryPointAsync(Sys::Context &ctx) {
+    auto portOption = Cli::option<isize>('p', "port"s, "Port of the server on localhost."s, 8080);
+    auto connectionsOption = Cli::option<isize>('c', "connections"s, "Number of concurrent connections."s, 16);
+    auto requestsOption = Cli::option<isize>('n', "requests"s, "Number of requests to send, instead of running for a duration."s, 0);
+    auto durationOption = Cli::option<isize>('d', "duration"s, "How long to run, in seconds."s, 10);
+    auto rateOption = Cli::option<isize>('r', "rate"s, "Requests per second, 0 to send as fast as possible."s, 0);
+    auto jsonFlag = Cli::flag('j', "json"s, "Print the report as JSON."s);
+    auto pathOperand = Cli::operand<Str>("path"s, "Path to request."s, "/"s);
+
+    Cli::Command cmd{
+        "loadgen"s,
+        NONE,
+        "Generate HTTP load against a server on localhost."s,
+        {portOption, connectionsOption, requestsOption, durationOption, rateOption, jsonFlag, pathOperand}
+    };
+
+    co_trya$(cmd.execAsync(ctx));
+
+    if (not cmd)
+        co_return Ok();
+
+    isize port = portOption;
+    isize connections = connectionsOption;
+    isize requests = requestsOption;
+    isize duration = durationOption;
+    isize rate = rateOption;
+
+    if (port <= 0 or port > 0xffff)
+        co_return Error::invalidInput("port out of range");
+    if (connections <= 0 or requests < 0 or duration <= 0 or rate < 0)
+        co_return Error::invalidInput("expected positive values");
+
+    Loadgen::Bench bench{
+        .options = {
+            .port = (u16)port,
+            .path = pathOperand,
+            .connections = (usize)connections,
+            .requests = (usize)requests,
+            .duration = TimeSpan::fromSecs(duration),
+            .rate = (usize)rate,
+        },
+    };
+
+    co_trya$(Loadgen::runAsync(bench));
+
+    auto report = Loadgen::report(bench);
+    if (jsonFlag)
+        co_try$(Loadgen::printJson(bench.options, report));
+    else
+        Loadgen::printText(bench.options, report);
+
+    co_return Ok();
+}
@@ -1,3 +1,4 @@
+#include <karm-base/lru.h>
 #include <karm-io/funcs.h>
 #include <karm-logger/logger.h>
 #include <karm-mime/mime.h>
@@ -6,86 +7,382 @@
 #include <karm-sys/entry.h>
 #include <karm-sys/file.h>
 #include <karm-sys/socket.h>
+#include <karm-sys/time.h>
 
 namespace Serv {
 
-Async::Task<> respondFile(Sys::_Connection &conn, Mime::Url const &url, Net::Http::Code code = Net::Http::Code::OK) {
+// Requests with a bigger header are refused.
+static constexpr usize MAX_HEADER = 16 * 1024;
+
+// Responses to pipelined requests are sent as soon
+// as this much is waiting, instead of piling up.
+static constexpr usize MAX_PENDING_OUT = 64 * 1024;
+
+// Connections are closed when a whole request
+// doesn't come in within this long.
+static constexpr TimeSpan KEEP_ALIVE_TIMEOUT = TimeSpan::fromSecs(5);
+
+// MARK: Cache -----------------------------------------------------------------
+
+// Files up to this size are kept in memory, bigger ones
+// are sent from the disk but still get their headers cached.
+static constexpr usize MAX_CACHED_FILE = 256 * 1024;
+static constexpr usize CACHE_ENTRIES = 256;
+
+// How long a cached file is served without checking
+// if it changed on the disk.
+static constexpr TimeSpan CACHE_FRESHNESS = TimeSpan::fromSecs(1);
+
+struct Asset {
+    Mime::Url url;
+    TimeStamp modified;
+    usize size;
+    TimeSpan checked;
+    String etag;
+
+    // Whether a precompressed sibling exists, responses
+    // then depend on the Accept-Encoding of the request.
+    bool vary;
+
+    // Header fields shared by every response serving this
+    // file, up to, but without, the blank line.
+    String fields;
+
+    // NONE when the file is too big to be kept in memory.
+    Opt<Vec<u8>> body = NONE;
+};
+
+// Keyed by the requested url, plus whether gzip was accepted.
+static Lru<String, Strong<Asset>> _cache{CACHE_ENTRIES};
+
+static Mime::Url _gzipSibling(Mime::Url const &url) {
+    auto gz = url.parent(1);
+    gz.append(Io::format("{}.gz", url.basename()).unwrap());
+    return gz;
+}
+
+static Res<Strong<Asset>> _loadAsset(Mime::Url const &url, bool gzip) {
+    auto stat = try$(Sys::stat(url));
+    if (stat.type == Sys::Type::DIR)
+        return _loadAsset(url / "index.html", gzip);
+
+    // The type comes from the original name, the
+    // precompressed sibling is only a different encoding.
     auto contentType = Mime::sniffSuffix(url.path.suffix())
                            .unwrapOr("application/octet-stream"_mime);
-    auto file = co_try$(Sys::File::open(url));
-    auto stat = co_try$(file.stat());
 
-    Io::StringWriter header;
-    co_try$(Io::format(
-        header,
-        "HTTP/1.1 {} {}\r\n"
-        "Connection: close\r\n"
+    // Responses depend on Accept-Encoding as soon as there
+    // is a sibling, even the ones that don't use it.
+    auto gz = _gzipSibling(url);
+    auto gzStat = Sys::stat(gz);
+    bool hasGzip = gzStat and gzStat.unwrap().type == Sys::Type::FILE;
+
+    auto served = url;
+    gzip = gzip and hasGzip;
+    if (gzip) {
+        served = gz;
+        stat = gzStat.unwrap();
+    }
+
+    auto asset = makeStrong<Asset>();
+    asset->url = served;
+    asset->modified = stat.modifyTime;
+    asset->size = stat.size;
+    asset->checked = Sys::uptime();
+    asset->vary = hasGzip;
+    asset->etag = try$(Io::format(
+        "\"{x}-{x}{}\"",
+        stat.modifyTime.val(),
+        stat.size,
+        gzip ? "-gz" : ""
+    ));
+
+    Io::StringWriter fields;
+    try$(Io::format(
+        fields,
         "Content-Type: {}\r\n"
         "Content-Length: {}\r\n"
-        "X-Powered-By: Karm Web\r\n"
+        "ETag: {}\r\n"
+        "X-Powered-By: Karm Web\r\n",
+        contentType,
+        stat.size,
+        asset->etag
+    ));
+    if (gzip)
+        try$(fields.writeStr("Content-Encoding: gzip\r\n"s));
+    if (hasGzip)
+        try$(fields.writeStr("Vary: Accept-Encoding\r\n"s));
+    asset->fields = fields.take();
+
+    if (stat.size <= MAX_CACHED_FILE) {
+        auto file = try$(Sys::File::open(served));
+        Vec<u8> body;
+        body.resize(stat.size);
+        usize len = 0;
+        while (len < stat.size) {
+            auto read = try$(file.read(mutNext(body, len)));
+            if (read == 0)
+                return Error::invalidData("file changed while reading it");
+            len += read;
+        }
+        asset->body = std::move(body);
+    }
+
+    return Ok(asset);
+}
+
+static Res<Strong<Asset>> _asset(Mime::Url const &url, bool gzip) {
+    auto key = try$(Io::format("{}{}", url, gzip ? " gzip" : ""));
+
+    if (auto cached = _cache.tryGet(key)) {
+        auto asset = cached.unwrap();
+        auto now = Sys::uptime();
+        if (now - asset->checked < CACHE_FRESHNESS)
+            return Ok(asset);
+
+        auto stat = Sys::stat(asset->url);
+        if (stat and
+            stat.unwrap().modifyTime == asset->modified and
+            stat.unwrap().size == asset->size) {
+            asset->checked = now;
+            return Ok(asset);
+        }
+    }
+
+    auto asset = try$(_loadAsset(url, gzip));
+    _cache.access(key, [&] {
+        return asset;
+    }) = asset;
+    return Ok(asset);
+}
+
+// MARK: Requests --------------------------------------------------------------
+
+static Res<> _writeHead(Io::Writer &out, Net::Http::Code code, Str fields, bool keepAlive) {
+    Io::StringWriter head;
+    try$(Io::format(
+        head,
+        "HTTP/1.1 {} {}\r\n"
+        "{}"
+        "Connection: {}\r\n"
         "\r\n",
         (usize)code,
         Net::Http::toStr(code),
-        contentType,
-        stat.size
+        fields,
+        keepAlive ? "keep-alive" : "close"
+    ));
+    try$(out.write(head.bytes()));
+    return Ok();
+}
+
+static Res<> _writeError(Io::Writer &out, Net::Http::Code code, bool keepAlive) {
+    Str body = Net::Http::toStr(code);
+    auto fields = try$(Io::format(
+        "Content-Type: text/plain; charset=UTF-8\r\n"
+        "Content-Length: {}\r\n"
+        "X-Powered-By: Karm Net\r\n",
+        body.len()
     ));
+    try$(_writeHead(out, code, fields, keepAlive));
+    try$(out.write(bytes(body)));
+    return Ok();
+}
 
-    co_try$(conn.write(header.bytes()));
-    co_try$(Io::copy(file, conn));
+static Async::Task<> _flushAsync(Sys::_Connection &conn, Io::BufferWriter &out) {
+    if (out.bytes().len())
+        co_trya$(Net::Http::writeAllAsync(conn, out.bytes()));
+    out.clear();
     co_return Ok();
 }
 
-Async::Task<> respond404(Sys::_Connection &conn) {
-    auto res = co_await respondFile(conn, "bundle://serv/public/404.html"_url, Net::Http::Code::NOT_FOUND);
-    if (res)
-        co_return Ok();
+// Send the body of an asset that isn't kept in memory, straight
+// from the file to the socket when there is nothing in between.
+static Async::Task<> _sendFileAsync(Sys::_Connection &conn, Asset const &asset) {
+    auto file = co_try$(Sys::File::open(asset.url));
 
-    Io::StringWriter header;
-    co_try$(Io::format(
-        header,
-        "HTTP/1.1 404 Not Found\r\n"
-        "Connection: close\r\n"
-        "Content-Type: text/plain; charset=UTF-8\r\n"
-        "Content-Length: 9\r\n"
-        "X-Powered-By: Karm Net\r\n"
-        "\r\n"
-        "Not Found"
-    ));
+    Opt<usize> sent = NONE;
+    if (auto fd = conn.directFd()) {
+        auto res = co_await Sys::globalSched().transferAsync(file.fd(), fd.unwrap(), 0, asset.size);
+        if (res or res.none() != Error::NOT_IMPLEMENTED)
+            sent = co_try$(res);
+    }
+
+    if (not sent)
+        sent = co_try$(Io::copy(file, conn, asset.size));
 
-    co_trya$(conn.writeAsync(header.bytes()));
+    // The length was already promised in the header,
+    // the connection can't be used anymore.
+    if (sent.unwrap() != asset.size)
+        co_return Error::invalidData("file changed while sending it");
     co_return Ok();
 }
 
-Async::Task<> handleRequest(Sys::_Connection &conn, Str request, Sys::SocketAddr addr) {
-    Io::SScan scan{request};
-    auto req = co_try$(Net::Http::Request::parse(scan));
+// Responses are written to `out` and only sent when there are no more
+// pipelined requests waiting, when too much is pending, or before a
+// body that isn't in memory.
+Async::Task<> respondAsync(Sys::_Connection &conn, Io::BufferWriter &out, Net::Http::Request const &req, bool keepAlive, Sys::SocketAddr addr) {
     auto url = "bundle://serv/public/"_url / req.path;
-
     logInfo("{}: {} {}", addr, req.method, req.path);
 
-    Res<> firstRes = co_await respondFile(conn, url, Net::Http::Code::OK);
-    if (firstRes) {
+    auto code = Net::Http::Code::OK;
+    bool gzip = req.acceptsEncoding("gzip"s);
+    auto asset = _asset(url, gzip);
+    if (not asset) {
+        logWarn("{}: {} {}: {}", addr, req.method, url, asset.none());
+        code = Net::Http::Code::NOT_FOUND;
+        asset = _asset("bundle://serv/public/404.html"_url, gzip);
+    }
+
+    if (not asset) {
+        co_try$(_writeError(out, code, keepAlive));
         co_return Ok();
     }
 
-    Res<> res = co_await respondFile(conn, url / "index.html", Net::Http::Code::OK);
-    if (res)
+    auto &a = *asset.unwrap();
+    if (code == Net::Http::Code::OK and req.matchesEtag(a.etag)) {
+        auto fields = co_try$(Io::format(
+            "ETag: {}\r\n"
+            "{}",
+            a.etag,
+            a.vary ? "Vary: Accept-Encoding\r\n" : ""
+        ));
+        co_try$(_writeHead(out, Net::Http::Code::NOT_MODIFIED, fields, keepAlive));
         co_return Ok();
+    }
 
-    logWarn("{}: {} {}: {}", addr, req.method, url, firstRes);
-    co_return co_await respond404(conn);
+    co_try$(_writeHead(out, code, a.fields, keepAlive));
+    if (req.method == Net::Http::Method::HEAD)
+        co_return Ok();
+
+    if (a.body) {
+        co_try$(out.write(bytes(a.body.unwrap())));
+        co_return Ok();
+    }
+
+    co_trya$(_flushAsync(conn, out));
+    co_return co_await _sendFileAsync(conn, a);
+}
+
+// MARK: Connections -----------------------------------------------------------
+
+// Shared between a connection and its watchdog, which only holds
+// the socket weakly so it doesn't keep it open once served.
+struct Idle {
+    Weak<Sys::Fd> fd;
+
+    // When the connection started waiting for a request,
+    // NONE while one is being answered.
+    Opt<TimeSpan> since;
+
+    Idle(Strong<Sys::Fd> fd)
+        : fd(fd), since(Sys::uptime()) {}
+};
+
+// Reads can't be canceled, so the socket is shut down instead,
+// which ends a pending read as if the client closed it.
+static Async::Task<> _watchAsync(Strong<Idle> idle, Sys::SocketAddr addr) {
+    while (true) {
+        auto now = Sys::uptime();
+        auto due = now + KEEP_ALIVE_TIMEOUT;
+        if (idle->since)
+            due = idle->since.unwrap() + KEEP_ALIVE_TIMEOUT;
+
+        if (due <= now) {
+            auto fd = idle->fd.upgrade();
+            if (not fd)
+                co_return Ok();
+            logDebug("{}: idle, closing", addr);
+            co_return Sys::shutdown(fd.take());
+        }
+
+        co_trya$(Sys::globalSched().sleepAsync(Sys::now() + (due - now)));
+        if (not idle->fd.upgrade())
+            co_return Ok();
+    }
+}
+
+// Serve requests from a connection until the client is done, the
+// ones pipelined in the same read are answered in a single write.
+Async::Task<> serveAsync(Sys::_Connection &conn, Buf<u8> buf, Sys::SocketAddr addr, Idle &idle) {
+    Io::BufferWriter out;
+    usize scanned = 0;
+
+    while (true) {
+        auto end = Net::Http::endOfHeader(next(bytes(buf), scanned));
+        if (not end) {
+            // Keep the last bytes, the end of the header
+            // might straddle two reads.
+            scanned = buf.len() > 3 ? buf.len() - 3 : 0;
+
+            if (buf.len() > MAX_HEADER) {
+                co_try$(_writeError(out, Net::Http::Code::REQUEST_HEADER_FIELDS_TOO_LARGE, false));
+                co_return co_await _flushAsync(conn, out);
+            }
+
+            co_trya$(_flushAsync(conn, out));
+
+            Array<u8, 4096> chunk;
+            auto len = co_trya$(conn.readAsync(mutBytes(chunk)));
+            if (len == 0)
+                co_return Ok();
+            buf.insert(COPY, buf.len(), chunk.buf(), len);
+            continue;
+        }
+
+        usize headerLen = scanned + end.unwrap();
+        scanned = 0;
+        idle.since = NONE;
+
+        Io::SScan scan{Str{(char const *)buf.buf(), headerLen}};
+        auto req = Net::Http::Request::parse(scan);
+        if (not req) {
+            co_try$(_writeError(out, Net::Http::Code::BAD_REQUEST, false));
+            co_return co_await _flushAsync(conn, out);
+        }
+
+        if (req.unwrap().method != Net::Http::Method::GET and
+            req.unwrap().method != Net::Http::Method::HEAD) {
+            co_try$(_writeError(out, Net::Http::Code::METHOD_NOT_ALLOWED, false));
+            co_return co_await _flushAsync(conn, out);
+        }
+
+        // Bodies aren't read, so there is no telling
+        // where the next request starts.
+        bool keepAlive = req.unwrap().keepAlive() and
+                         not req.unwrap().tryGet("Content-Length") and
+                         not req.unwrap().tryGet("Transfer-Encoding");
+
+        co_trya$(respondAsync(conn, out, req.unwrap(), keepAlive, addr));
+
+        // The request points into the buffer, so it's
+        // only dropped once the response is written.
+        buf.removeRange(0, headerLen);
+
+        if (not keepAlive)
+            co_return co_await _flushAsync(conn, out);
+
+        if (out.bytes().len() >= MAX_PENDING_OUT)
+            co_trya$(_flushAsync(conn, out));
+
+        idle.since = Sys::uptime();
+    }
 }
 
 Async::Task<> handleConnection(Sys::TcpConnection stream) {
-    Array<char, 4096> buf;
+    auto idle = makeStrong<Idle>(stream.fd());
+    Async::detach(_watchAsync(idle, stream.addr()));
+
+    Array<u8, 4096> buf;
     auto len = co_trya$(stream.readAsync(mutBytes(buf)));
-    if (not Tls::isHello(bytes(buf))) {
-        co_return co_await handleRequest(stream, Str{buf.buf(), len}, stream.addr());
+    if (not Tls::isHello(sub(buf, 0, len))) {
+        Buf<u8> pending = sub(buf, 0, len);
+        co_return co_await serveAsync(stream, std::move(pending), stream.addr(), *idle);
     } else {
         logDebug("{}: wants TLS", stream.addr());
-        auto tls = co_try$(Tls::TlsConnection::accept(stream, bytes(buf)));
+        auto tls = co_try$(Tls::TlsConnection::accept(stream, sub(buf, 0, len)));
         len = co_trya$(tls.readAsync(mutBytes(buf)));
-        co_return co_await handleRequest(tls, Str{buf.buf(), len}, stream.addr());
+        Buf<u8> pending = sub(buf, 0, len);
+        co_return co_await serveAsync(tls, std::move(pending), stream.addr(), *idle);
     }
 }
 
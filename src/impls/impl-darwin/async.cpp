@@ -1,6 +1,8 @@
 #include <sys/event.h>
+#include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 //
@@ -99,6 +101,59 @@ struct DarwinSched :
         co_return Ok(co_try$(fd->flush()));
     }
 
+    // NOTE: kqueue always reports regular files as ready,
+    //       so positional I/O is done synchronously.
+
+    Async::Task<usize> preadAsync(Strong<Fd> fd, MutBytes buf, usize offset) override {
+        isize res = ::pread(fd->handle().value(), buf.buf(), buf.len(), offset);
+        if (res < 0)
+            co_return Posix::fromLastErrno();
+        co_return Ok(static_cast<usize>(res));
+    }
+
+    Async::Task<usize> pwriteAsync(Strong<Fd> fd, Bytes buf, usize offset) override {
+        isize res = ::pwrite(fd->handle().value(), buf.buf(), buf.len(), offset);
+        if (res < 0)
+            co_return Posix::fromLastErrno();
+        co_return Ok(static_cast<usize>(res));
+    }
+
+    Async::Task<usize> readvAsync(Strong<Fd> fd, Slice<MutBytes> bufs, usize offset) override {
+        Vec<iovec> iovs;
+        for (auto buf : bufs)
+            iovs.pushBack(iovec{buf.buf(), buf.len()});
+
+        isize res = ::preadv(fd->handle().value(), iovs.buf(), iovs.len(), offset);
+        if (res < 0)
+            co_return Posix::fromLastErrno();
+        co_return Ok(static_cast<usize>(res));
+    }
+
+    Async::Task<usize> writevAsync(Strong<Fd> fd, Slice<Bytes> bufs, usize offset) override {
+        Vec<iovec> iovs;
+        for (auto &buf : bufs)
+            iovs.pushBack(iovec{const_cast<Byte *>(buf.buf()), buf.len()});
+
+        isize res = ::pwritev(fd->handle().value(), iovs.buf(), iovs.len(), offset);
+        if (res < 0)
+            co_return Posix::fromLastErrno();
+        co_return Ok(static_cast<usize>(res));
+    }
+
+    Async::Task<usize> transferAsync(Strong<Fd> from, Strong<Fd> to, usize offset, usize size) override {
+        // NOTE: Like positional I/O, this is done synchronously.
+        usize total = 0;
+        while (total < size) {
+            off_t len = min(size - total, 1uz << 30);
+            if (::sendfile(from->handle().value(), to->handle().value(), offset + total, &len, nullptr, 0) < 0 and len == 0)
+                co_return Posix::fromLastErrno();
+            if (len == 0)
+                break;
+            total += len;
+        }
+        co_return Ok(total);
+    }
+
     Async::Task<_Accepted> acceptAsync(Strong<Fd> fd) override {
         co_trya$(waitFor({
             .ident = fd->handle().value(),
@@ -8,6 +8,8 @@
 #include <karm-sys/_embed.h>
 #include <karm-sys/file.h>
 #include <karm-sys/launch.h>
+#include <karm-sys/mutex.h>
+#include <karm-sys/thread.h>
 
 namespace Karm::Sys::_Embed {
 
@@ -235,6 +237,10 @@ Res<Strong<Fd>> listenIpc(Mime::Url) {
     notImplemented();
 }
 
+Res<> shutdown(Strong<Fd>) {
+    notImplemented();
+}
+
 // MARK: Files -----------------------------------------------------------------
 
 static Opt<Json::Value> _index = NONE;
@@ -324,6 +330,10 @@ Res<Strong<Fd>> openFile(Mime::Url const &url) {
     return Ok(makeStrong<FileProto>(file));
 }
 
+Res<usize> transfer(Strong<Fd>, Strong<Fd>, usize) {
+    return Error::notImplemented();
+}
+
 Res<Vec<DirEntry>> readDir(Mime::Url const &) {
     return Error::notImplemented();
 }
@@ -456,6 +466,30 @@ Res<> exit(i32) {
         ;
 }
 
+// MARK: Threads ---------------------------------------------------------------
+
+Res<Strong<Thread>> spawnThread(Func<void()>) {
+    return Error::notImplemented();
+}
+
+usize concurrency() {
+    return 1;
+}
+
+Res<Strong<Sys::Sema>> createSema(usize) {
+    return Error::notImplemented();
+}
+
+static void *_currentWorker = nullptr;
+
+void *currentWorker() {
+    return _currentWorker;
+}
+
+void setCurrentWorker(void *worker) {
+    _currentWorker = worker;
+}
+
 // MARK: Sandboxing ------------------------------------------------------------
 
 void hardenSandbox() {
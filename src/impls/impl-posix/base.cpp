@@ -41,11 +41,11 @@ void relaxe() {
 }
 
 void enterCritical() {
-    // NOTE: We don't do any thread so we don't need to do anything here.
+    // NOTE: Threads are preemptively scheduled by the kernel, spinning is enough.
 }
 
 void leaveCritical() {
-    // NOTE: We don't do any thread so we don't need to do anything here.
+    // NOTE: Threads are preemptively scheduled by the kernel, spinning is enough.
 }
 
 } // namespace Karm::_Embed
@@ -3,8 +3,12 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <sys/mman.h>
+#ifdef __ck_sys_linux__
+#    include <sys/sendfile.h>
+#endif
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -19,7 +23,9 @@
 #include <karm-logger/logger.h>
 #include <karm-sys/_embed.h>
 #include <karm-sys/launch.h>
+#include <karm-sys/mutex.h>
 #include <karm-sys/proc.h>
+#include <karm-sys/thread.h>
 
 #include "fd.h"
 #include "utils.h"
@@ -126,6 +132,41 @@ Res<Pair<Strong<Fd>>> createPipe() {
     });
 }
 
+Res<usize> transfer(Strong<Fd> from, Strong<Fd> to, usize size) {
+#ifdef __ck_sys_linux__
+    usize total = 0;
+    while (total < size) {
+        // NOTE: Linux moves at most 0x7ffff000 bytes per call.
+        isize res = ::sendfile(
+            to->handle().value(),
+            from->handle().value(),
+            nullptr,
+            min(size - total, 0x7ffff000uz)
+        );
+
+        if (res < 0) {
+            // Not something that can be sent from or to, nothing
+            // was moved yet so the caller can still copy instead.
+            if (total == 0 and (errno == EINVAL or errno == ENOSYS))
+                return Error::notImplemented("sendfile not supported");
+            return Posix::fromLastErrno();
+        }
+
+        if (res == 0)
+            break;
+        total += res;
+    }
+    return Ok(total);
+#else
+    // NOTE: Darwin's sendfile() only sends to sockets
+    //       and doesn't move the file position.
+    (void)from;
+    (void)to;
+    (void)size;
+    return Error::notImplemented("sendfile not supported");
+#endif
+}
+
 Res<Strong<Fd>> createIn() {
     auto fd = makeStrong<Posix::Fd>(0);
     fd->_leak = true; // Don't close stdin when we close the fd
@@ -290,6 +331,12 @@ Res<Strong<Fd>> listenIpc(Mime::Url url) {
     return Ok(makeStrong<Posix::Fd>(fd));
 }
 
+Res<> shutdown(Strong<Fd> fd) {
+    if (::shutdown(fd->handle().value(), SHUT_RDWR) < 0)
+        return Posix::fromLastErrno();
+    return Ok();
+}
+
 // MARK: Time ------------------------------------------------------------------
 
 TimeSpan fromTimeSpec(struct timespec const &ts) {
@@ -427,6 +474,113 @@ Res<> exit(i32 res) {
     return Ok();
 }
 
+// MARK: Threads ---------------------------------------------------------------
+
+struct PosixThread : public Sys::Thread {
+    Func<void()> _fn;
+    pthread_t _thread{};
+    bool _joinable = false;
+
+    PosixThread(Func<void()> fn)
+        : _fn(std::move(fn)) {}
+
+    ~PosixThread() override {
+        if (_joinable)
+            pthread_join(_thread, nullptr);
+    }
+
+    static void *_entry(void *arg) {
+        static_cast<PosixThread *>(arg)->_fn();
+        return nullptr;
+    }
+
+    Res<> join() override {
+        if (not _joinable)
+            return Error::invalidInput("thread is not joinable");
+
+        _joinable = false;
+        if (auto err = pthread_join(_thread, nullptr); err != 0)
+            return Posix::fromErrno(err);
+        return Ok();
+    }
+};
+
+Res<Strong<Sys::Thread>> spawnThread(Func<void()> fn) {
+    auto thread = makeStrong<PosixThread>(std::move(fn));
+    if (auto err = pthread_create(&thread->_thread, nullptr, PosixThread::_entry, &thread.unwrap()); err != 0)
+        return Posix::fromErrno(err);
+    thread->_joinable = true;
+    return Ok(thread);
+}
+
+usize concurrency() {
+    auto n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? n : 1;
+}
+
+struct PosixSema : public Sys::Sema {
+    pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t _cond = PTHREAD_COND_INITIALIZER;
+    usize _count;
+
+    PosixSema(usize count)
+        : _count(count) {}
+
+    ~PosixSema() override {
+        pthread_cond_destroy(&_cond);
+        pthread_mutex_destroy(&_mutex);
+    }
+
+    void wait() override {
+        pthread_mutex_lock(&_mutex);
+        while (_count == 0)
+            pthread_cond_wait(&_cond, &_mutex);
+        _count--;
+        pthread_mutex_unlock(&_mutex);
+    }
+
+    bool tryWait() override {
+        pthread_mutex_lock(&_mutex);
+        bool res = _count > 0;
+        if (res)
+            _count--;
+        pthread_mutex_unlock(&_mutex);
+        return res;
+    }
+
+    void signal(usize n) override {
+        pthread_mutex_lock(&_mutex);
+        _count += n;
+        pthread_mutex_unlock(&_mutex);
+
+        if (n == 1)
+            pthread_cond_signal(&_cond);
+        else
+            pthread_cond_broadcast(&_cond);
+    }
+
+    usize count() override {
+        pthread_mutex_lock(&_mutex);
+        usize res = _count;
+        pthread_mutex_unlock(&_mutex);
+        return res;
+    }
+};
+
+Res<Strong<Sys::Sema>> createSema(usize count) {
+    return Ok(makeStrong<PosixSema>(count));
+}
+
+static thread_local void *_currentWorker = nullptr;
+
+void *currentWorker() {
+    return _currentWorker;
+}
+
+void setCurrentWorker(void *worker) {
+    _currentWorker = worker;
+}
+
 // MARK: Sandboxing ------------------------------------------------------------
 
 void hardenSandbox() {
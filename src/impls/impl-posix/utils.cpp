@@ -217,6 +217,8 @@ Sys::Stat fromStat(struct stat const &buf) {
     Sys::Type type = Sys::Type::FILE;
     if (S_ISDIR(buf.st_mode))
         type = Sys::Type::DIR;
+    else if (not S_ISREG(buf.st_mode))
+        type = Sys::Type::OTHER;
     stat.type = type;
     stat.size = (usize)buf.st_size;
     stat.accessTime = TimeStamp::epoch() + TimeSpan::fromSecs(buf.st_atime);
@@ -41,6 +41,26 @@ struct HjertSched : public Sys::Sched {
         co_return Error::notImplemented("not implemented");
     }
 
+    virtual Async::Task<usize> preadAsync(Strong<Fd>, MutBytes, usize) {
+        co_return Error::notImplemented("not implemented");
+    }
+
+    virtual Async::Task<usize> pwriteAsync(Strong<Fd>, Bytes, usize) {
+        co_return Error::notImplemented("not implemented");
+    }
+
+    virtual Async::Task<usize> readvAsync(Strong<Fd>, Slice<MutBytes>, usize) {
+        co_return Error::notImplemented("not implemented");
+    }
+
+    virtual Async::Task<usize> writevAsync(Strong<Fd>, Slice<Bytes>, usize) {
+        co_return Error::notImplemented("not implemented");
+    }
+
+    virtual Async::Task<usize> transferAsync(Strong<Fd>, Strong<Fd>, usize, usize) {
+        co_return Error::notImplemented("not implemented");
+    }
+
     virtual Async::Task<_Accepted> acceptAsync(Strong<Fd>) {
         co_return Error::notImplemented("not implemented");
     }
@@ -3,6 +3,8 @@
 #include <karm-logger/logger.h>
 #include <karm-sys/_embed.h>
 #include <karm-sys/launch.h>
+#include <karm-sys/mutex.h>
+#include <karm-sys/thread.h>
 
 #include "fd.h"
 
@@ -37,6 +39,10 @@ Res<Cons<Strong<Sys::Fd>, Strong<Sys::Fd>>> createPipe() {
     notImplemented();
 }
 
+Res<usize> transfer(Strong<Sys::Fd>, Strong<Sys::Fd>, usize) {
+    return Error::notImplemented();
+}
+
 Res<Strong<Sys::Fd>> createIn() {
     return Ok(makeStrong<Sys::NullFd>());
 }
@@ -85,6 +91,10 @@ Res<Strong<Sys::Fd>> listenIpc(Mime::Url) {
     notImplemented();
 }
 
+Res<> shutdown(Strong<Sys::Fd>) {
+    notImplemented();
+}
+
 // MARK: Time ------------------------------------------------------------------
 
 TimeStamp now() {
@@ -163,6 +173,30 @@ Res<> exit(i32) {
     notImplemented();
 }
 
+// MARK: Threads ---------------------------------------------------------------
+
+Res<Strong<Sys::Thread>> spawnThread(Func<void()>) {
+    notImplemented();
+}
+
+usize concurrency() {
+    return 1;
+}
+
+Res<Strong<Sys::Sema>> createSema(usize) {
+    return Error::notImplemented();
+}
+
+static void *_currentWorker = nullptr;
+
+void *currentWorker() {
+    return _currentWorker;
+}
+
+void setCurrentWorker(void *worker) {
+    _currentWorker = worker;
+}
+
 // MARK: Sandboxing ------------------------------------------------------------
 
 void hardenSandbox() {
@@ -1,8 +1,12 @@
 
+#include <fcntl.h>
 #include <liburing.h>
+#include <sys/socket.h>
+#include <unistd.h>
 //
 #include <impl-posix/fd.h>
 #include <impl-posix/utils.h>
+#include <karm-async/one.h>
 #include <karm-async/promise.h>
 #include <karm-base/map.h>
 #include <karm-logger/logger.h>
@@ -41,6 +45,25 @@ struct __kernel_timespec toKernelTimespec(TimeSpan ts) {
 struct UringSched : public Sys::Sched {
     static constexpr auto NCQES = 128;
 
+    // Slots in the table of registered files.
+    static constexpr auto NFILES = 1024;
+
+    // Buffers handed to the kernel for multishot receives.
+    static constexpr auto NBUFS = 512;
+    static constexpr auto BUF_LEN = 4096;
+    static constexpr auto BUF_GROUP = 0;
+
+    // User data of submissions nobody waits on.
+    static constexpr u64 NO_JOB = ~0ull;
+
+    // Offset telling the kernel to use, and move, the file position.
+    static constexpr u64 CURRENT_POS = ~0ull;
+
+    // Bytes moved per splice, the default capacity of a pipe,
+    // and how many idle pipes are kept around for the next ones.
+    static constexpr usize PIPE_LEN = 64 * 1024;
+    static constexpr usize MAX_PIPES = 16;
+
     struct _Job {
         virtual ~_Job() = default;
         virtual void submit(io_uring_sqe *sqe) = 0;
@@ -48,28 +71,421 @@ struct UringSched : public Sys::Sched {
     };
 
     io_uring _ring;
-    usize _id = 0;
-    Map<usize, Strong<_Job>> _jobs;
+
+    // Jobs in flight. The user data of a submission is the index of its
+    // slot, with the generation of the slot in the upper 32 bits. It
+    // changes every time the slot is freed, so a late completion or
+    // cancel can't reach the job that took the slot over.
+    struct _Slot {
+        Opt<Strong<_Job>> job;
+        u32 gen = 0;
+    };
+
+    Vec<_Slot> _jobs;
+    Vec<usize> _freeJobs;
+
+    // Registered file slots, released ones can only be reused
+    // once everything that was queued before has been submitted.
+    Vec<usize> _freeFiles;
+    Vec<usize> _releasedFiles;
+
+    // Idle pipes for splicing.
+    Vec<Pair<Strong<Fd>>> _pipes;
+
+    io_uring_buf_ring *_bufRing = nullptr;
+    Vec<Byte> _bufs;
 
     UringSched(io_uring ring)
-        : _ring(ring) {}
+        : _ring(ring) {
+        // Provided buffers and multishot operations need Linux 5.19,
+        // without them every operation is a one-shot.
+        int err = 0;
+        _bufRing = io_uring_setup_buf_ring(&_ring, NBUFS, BUF_GROUP, 0, &err);
+        if (_bufRing) {
+            _bufs.resize(NBUFS * BUF_LEN);
+            for (usize i = 0; i < NBUFS; i++)
+                io_uring_buf_ring_add(_bufRing, _buf(i), BUF_LEN, i, io_uring_buf_ring_mask(NBUFS), i);
+            io_uring_buf_ring_advance(_bufRing, NBUFS);
+        }
+
+        if (io_uring_register_files_sparse(&_ring, NFILES) == 0) {
+            for (usize i = NFILES; i > 0; i--)
+                _freeFiles.pushBack(i - 1);
+        }
+    }
 
     ~UringSched() {
+        if (_bufRing)
+            io_uring_free_buf_ring(&_ring, _bufRing, NBUFS, BUF_GROUP);
         io_uring_queue_exit(&_ring);
     }
 
-    void submit(Strong<_Job> job) {
-        auto id = _id++;
+    // MARK: Submission --------------------------------------------------------
+
+    io_uring_sqe *_sqe() {
         auto *sqe = io_uring_get_sqe(&_ring);
+        if (not sqe) {
+            // The submission queue is full, don't wait
+            // for the end of the iteration to flush it.
+            io_uring_submit(&_ring);
+            sqe = io_uring_get_sqe(&_ring);
+        }
+
         if (not sqe) [[unlikely]]
             panic("failed to get sqe");
-        sqe->user_data = id;
-        _jobs.put(id, job);
+        return sqe;
+    }
+
+    // Queue the job, it goes to the kernel with everything
+    // else on the next call to wait().
+    u64 submit(Strong<_Job> job) {
+        usize index;
+        if (_freeJobs.len()) {
+            index = _freeJobs.popBack();
+            _jobs[index].job = job;
+        } else {
+            index = _jobs.len();
+            _jobs.pushBack({job});
+        }
+
+        u64 id = ((u64)_jobs[index].gen << 32) | index;
+        auto *sqe = _sqe();
         job->submit(sqe);
-        io_uring_submit(&_ring);
+        io_uring_sqe_set_data64(sqe, id);
+        return id;
     }
 
+    // The slot of a job that is still in flight, if any.
+    Opt<usize> _lookup(u64 id) {
+        usize index = id & 0xffffffff;
+        if (index >= _jobs.len())
+            return NONE;
+        auto &slot = _jobs[index];
+        if (not slot.job or slot.gen != (id >> 32))
+            return NONE;
+        return index;
+    }
+
+    void _cancel(Opt<u64> id) {
+        // Already completed, there is nothing left to cancel
+        if (not id or not _lookup(*id))
+            return;
+        auto *sqe = _sqe();
+        io_uring_prep_cancel64(sqe, *id, 0);
+        io_uring_sqe_set_data64(sqe, NO_JOB);
+    }
+
+    // MARK: Registered Files --------------------------------------------------
+
+    Opt<usize> _registerFile(isize raw) {
+        if (not _freeFiles.len())
+            return NONE;
+
+        int fd = raw;
+        auto slot = _freeFiles.popBack();
+        if (io_uring_register_files_update(&_ring, slot, &fd, 1) < 0) {
+            _freeFiles.pushBack(slot);
+            return NONE;
+        }
+        return slot;
+    }
+
+    void _releaseFile(Opt<usize> slot) {
+        if (not slot)
+            return;
+        int fd = -1;
+        io_uring_register_files_update(&_ring, *slot, &fd, 1);
+        _releasedFiles.pushBack(*slot);
+    }
+
+    static void _useFile(io_uring_sqe *sqe, Opt<usize> slot) {
+        if (not slot)
+            return;
+        sqe->fd = *slot;
+        sqe->flags |= IOSQE_FIXED_FILE;
+    }
+
+    // MARK: Provided Buffers --------------------------------------------------
+
+    Byte *_buf(usize bid) {
+        return _bufs.buf() + bid * BUF_LEN;
+    }
+
+    void _recycle(u16 bid) {
+        io_uring_buf_ring_add(_bufRing, _buf(bid), BUF_LEN, bid, io_uring_buf_ring_mask(NBUFS), 0);
+        io_uring_buf_ring_advance(_bufRing, 1);
+    }
+
+    // MARK: Streams -----------------------------------------------------------
+
+    // Connections accepted by the scheduler, the kernel keeps receiving
+    // into provided buffers and reads are served from what is queued.
+
+    struct _Read {
+        MutBytes buf;
+        Async::Promise<usize> promise;
+    };
+
+    struct _Chunk {
+        u16 bid;
+        usize off;
+        usize len;
+    };
+
+    struct _Stream {
+        isize _raw;
+        Opt<usize> _file;
+        Opt<u64> _job;
+        bool _starved = false;
+        bool _closed = false;
+        Opt<Res<usize>> _ended;
+        Vec<_Chunk> _chunks;
+        Vec<_Read> _waiting;
+
+        _Stream(isize raw, Opt<usize> file)
+            : _raw(raw), _file(file) {}
+    };
+
+    Map<usize, Strong<_Stream>> _streams;
+
+    struct _StreamFd : public Posix::Fd {
+        UringSched &_sched;
+
+        _StreamFd(UringSched &sched, isize raw)
+            : Posix::Fd(raw), _sched(sched) {}
+
+        ~_StreamFd() override {
+            _sched._dropStream(_raw);
+        }
+    };
+
+    struct _RecvJob : public _Job {
+        UringSched &_sched;
+        Strong<_Stream> _stream;
+        bool _multishot;
+
+        _RecvJob(UringSched &sched, Strong<_Stream> stream, bool multishot)
+            : _sched(sched), _stream(stream), _multishot(multishot) {}
+
+        void submit(io_uring_sqe *sqe) override {
+            if (_multishot) {
+                io_uring_prep_recv_multishot(sqe, _stream->_raw, nullptr, 0, 0);
+                sqe->flags |= IOSQE_BUFFER_SELECT;
+                sqe->buf_group = BUF_GROUP;
+            } else {
+                // Out of provided buffers, receive straight
+                // into the buffer of the first reader.
+                auto buf = _stream->_waiting[0].buf;
+                io_uring_prep_recv(sqe, _stream->_raw, buf.buf(), buf.len(), 0);
+            }
+            _useFile(sqe, _stream->_file);
+        }
+
+        void complete(io_uring_cqe *cqe) override {
+            if (_multishot)
+                _completeMultishot(cqe);
+            else
+                _completeOnce(cqe);
+        }
+
+        void _completeMultishot(io_uring_cqe *cqe) {
+            auto &s = *_stream;
+            if (not(cqe->flags & IORING_CQE_F_MORE))
+                s._job = NONE;
+
+            if (cqe->flags & IORING_CQE_F_BUFFER) {
+                u16 bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+                if (s._closed or cqe->res <= 0)
+                    _sched._recycle(bid);
+                else
+                    s._chunks.pushBack({bid, 0, (usize)cqe->res});
+            }
+
+            if (s._closed)
+                return;
+
+            if (cqe->res == 0)
+                s._ended = Ok(0uz);
+            else if (cqe->res == -ENOBUFS)
+                s._starved = true;
+            else if (cqe->res < 0)
+                s._ended = Posix::fromErrno(-cqe->res);
+
+            _sched._pump(_stream);
+        }
+
+        void _completeOnce(io_uring_cqe *cqe) {
+            auto &s = *_stream;
+            s._job = NONE;
+            s._starved = false;
+
+            if (s._closed)
+                return;
+
+            if (cqe->res > 0)
+                s._waiting.popFront().promise.resolve(Ok((usize)cqe->res));
+            else if (cqe->res == 0)
+                s._ended = Ok(0uz);
+            else
+                s._ended = Posix::fromErrno(-cqe->res);
+
+            _sched._pump(_stream);
+        }
+    };
+
+    Res<usize> _drain(_Stream &s, MutBytes buf) {
+        if (not s._chunks.len())
+            return s._ended.unwrap();
+
+        usize n = 0;
+        while (n < buf.len() and s._chunks.len()) {
+            auto &chunk = s._chunks[0];
+            usize len = min(buf.len() - n, chunk.len - chunk.off);
+            copy(Bytes{_buf(chunk.bid) + chunk.off, len}, mutNext(buf, n));
+            chunk.off += len;
+            n += len;
+
+            if (chunk.off == chunk.len) {
+                _recycle(chunk.bid);
+                s._chunks.popFront();
+            }
+        }
+        return Ok(n);
+    }
+
+    // Hand what was received to the readers, and keep
+    // receiving as long as some of them are left waiting.
+    void _pump(Strong<_Stream> s) {
+        while (s->_waiting.len() and (s->_chunks.len() or s->_ended)) {
+            auto read = s->_waiting.popFront();
+            read.promise.resolve(_drain(*s, read.buf));
+        }
+
+        if (s->_waiting.len() and not s->_job and not s->_ended)
+            s->_job = submit(makeStrong<_RecvJob>(*this, s, not s->_starved));
+    }
+
+    Async::Task<usize> _readStream(Strong<_Stream> s, MutBytes buf) {
+        if (not s->_waiting.len() and (s->_chunks.len() or s->_ended))
+            return Async::makeTask(Async::One<Res<usize>>{_drain(*s, buf)});
+
+        Async::Promise<usize> promise;
+        auto future = promise.future();
+        s->_waiting.pushBack({buf, std::move(promise)});
+        _pump(s);
+        return Async::makeTask(future);
+    }
+
+    void _dropStream(usize handle) {
+        if (not _streams.has(handle))
+            return;
+
+        auto s = _streams.take(handle);
+        s->_closed = true;
+        for (auto &chunk : s->_chunks)
+            _recycle(chunk.bid);
+        s->_chunks.clear();
+        s->_waiting.clear();
+        _cancel(s->_job);
+        _releaseFile(s->_file);
+    }
+
+    _Accepted _accepted(isize raw) {
+        sockaddr_in addr{};
+        socklen_t addrLen = sizeof(addr);
+        ::getpeername(raw, (sockaddr *)&addr, &addrLen);
+
+        _streams.put(raw, makeStrong<_Stream>(raw, _registerFile(raw)));
+        return {makeStrong<_StreamFd>(*this, raw), Posix::fromSockAddr(addr)};
+    }
+
+    // MARK: Listeners ---------------------------------------------------------
+
+    // A multishot accept stays armed on every listening socket, connections
+    // that come in while nobody is waiting are queued.
+
+    struct _Listener {
+        Strong<Fd> _fd;
+        Opt<usize> _file;
+        Opt<u64> _job;
+        bool _closed = false;
+        Vec<Res<_Accepted>> _ready;
+        Vec<Async::Promise<_Accepted>> _waiting;
+
+        _Listener(Strong<Fd> fd, Opt<usize> file)
+            : _fd(fd), _file(file) {}
+
+        void deliver(Res<_Accepted> res) {
+            if (_waiting.len())
+                _waiting.popFront().resolve(std::move(res));
+            else
+                _ready.pushBack(std::move(res));
+        }
+    };
+
+    Map<usize, Strong<_Listener>> _listeners;
+
+    struct _AcceptJob : public _Job {
+        UringSched &_sched;
+        Strong<_Listener> _listener;
+
+        _AcceptJob(UringSched &sched, Strong<_Listener> listener)
+            : _sched(sched), _listener(listener) {}
+
+        void submit(io_uring_sqe *sqe) override {
+            io_uring_prep_multishot_accept(sqe, _listener->_fd->handle().value(), nullptr, nullptr, 0);
+            _useFile(sqe, _listener->_file);
+        }
+
+        void complete(io_uring_cqe *cqe) override {
+            auto &l = *_listener;
+            if (not(cqe->flags & IORING_CQE_F_MORE))
+                l._job = NONE;
+
+            if (l._closed) {
+                if (cqe->res >= 0)
+                    ::close(cqe->res);
+                return;
+            }
+
+            if (cqe->res < 0)
+                l.deliver(Posix::fromErrno(-cqe->res));
+            else
+                l.deliver(Ok(_sched._accepted(cqe->res)));
+
+            if (not l._job and l._waiting.len())
+                _sched._armAccept(_listener);
+        }
+    };
+
+    void _armAccept(Strong<_Listener> listener) {
+        listener->_job = submit(makeStrong<_AcceptJob>(*this, listener));
+    }
+
+    // Listening sockets belong to the caller, once we hold the
+    // last reference to one it's time to stop accepting on it.
+    void _sweepListeners() {
+        Vec<usize> closed;
+        for (auto const &[handle, listener] : _listeners.iter())
+            if (listener->_fd.strong() == 1)
+                closed.pushBack(handle);
+
+        for (auto handle : closed) {
+            auto listener = _listeners.take(handle);
+            listener->_closed = true;
+            listener->_ready.clear();
+            listener->_waiting.clear();
+            _cancel(listener->_job);
+            _releaseFile(listener->_file);
+        }
+    }
+
+    // MARK: Operations --------------------------------------------------------
+
     Async::Task<usize> readAsync(Strong<Fd> fd, MutBytes buf) override {
+        if (auto stream = _streams.tryGet(fd->handle().value()))
+            return _readStream(*stream, buf);
+
         struct Job : public _Job {
             Strong<Fd> _fd;
             MutBytes _buf;
@@ -79,7 +495,7 @@ struct UringSched : public Sys::Sched {
                 : _fd(fd), _buf(buf) {}
 
             void submit(io_uring_sqe *sqe) override {
-                io_uring_prep_read(sqe, _fd->handle().value(), _buf.buf(), _buf.len(), 0);
+                io_uring_prep_read(sqe, _fd->handle().value(), _buf.buf(), _buf.len(), CURRENT_POS);
             }
 
             void complete(io_uring_cqe *cqe) override {
@@ -104,13 +520,15 @@ struct UringSched : public Sys::Sched {
         struct Job : public _Job {
             Strong<Fd> _fd;
             Bytes _buf;
+            Opt<usize> _file;
             Async::Promise<usize> _promise;
 
-            Job(Strong<Fd> fd, Bytes buf)
-                : _fd(fd), _buf(buf) {}
+            Job(Strong<Fd> fd, Bytes buf, Opt<usize> file)
+                : _fd(fd), _buf(buf), _file(file) {}
 
             void submit(io_uring_sqe *sqe) override {
-                io_uring_prep_write(sqe, _fd->handle().value(), _buf.buf(), _buf.len(), 0);
+                io_uring_prep_write(sqe, _fd->handle().value(), _buf.buf(), _buf.len(), CURRENT_POS);
+                _useFile(sqe, _file);
             }
 
             void complete(io_uring_cqe *cqe) override {
@@ -126,7 +544,11 @@ struct UringSched : public Sys::Sched {
             }
         };
 
-        auto job = makeStrong<Job>(fd, buf);
+        Opt<usize> file = NONE;
+        if (auto stream = _streams.access(fd->handle().value()))
+            file = (*stream)->_file;
+
+        auto job = makeStrong<Job>(fd, buf, file);
         submit(job);
         return Async::makeTask(job->future());
     }
@@ -161,7 +583,168 @@ struct UringSched : public Sys::Sched {
         return Async::makeTask(job->future());
     }
 
+    struct _RwJob : public _Job {
+        Strong<Fd> _fd;
+        Vec<iovec> _iovs;
+        usize _offset;
+        bool _write;
+        Async::Promise<usize> _promise;
+
+        _RwJob(Strong<Fd> fd, usize offset, bool write)
+            : _fd(fd), _offset(offset), _write(write) {}
+
+        void submit(io_uring_sqe *sqe) override {
+            auto fd = _fd->handle().value();
+            if (_iovs.len() == 1 and _write)
+                io_uring_prep_write(sqe, fd, _iovs[0].iov_base, _iovs[0].iov_len, _offset);
+            else if (_iovs.len() == 1)
+                io_uring_prep_read(sqe, fd, _iovs[0].iov_base, _iovs[0].iov_len, _offset);
+            else if (_write)
+                io_uring_prep_writev(sqe, fd, _iovs.buf(), _iovs.len(), _offset);
+            else
+                io_uring_prep_readv(sqe, fd, _iovs.buf(), _iovs.len(), _offset);
+        }
+
+        void complete(io_uring_cqe *cqe) override {
+            if (cqe->res < 0)
+                _promise.resolve(Posix::fromErrno(-cqe->res));
+            else
+                _promise.resolve(Ok((usize)cqe->res));
+        }
+    };
+
+    Async::Task<usize> _rwAsync(Strong<_RwJob> job) {
+        // The vectors are read at submission, so they
+        // have to live in the job rather than on the stack.
+        auto future = job->_promise.future();
+        submit(job);
+        return Async::makeTask(future);
+    }
+
+    Async::Task<usize> preadAsync(Strong<Fd> fd, MutBytes buf, usize offset) override {
+        auto job = makeStrong<_RwJob>(fd, offset, false);
+        job->_iovs.pushBack(iovec{buf.buf(), buf.len()});
+        return _rwAsync(job);
+    }
+
+    Async::Task<usize> pwriteAsync(Strong<Fd> fd, Bytes buf, usize offset) override {
+        auto job = makeStrong<_RwJob>(fd, offset, true);
+        job->_iovs.pushBack(iovec{const_cast<Byte *>(buf.buf()), buf.len()});
+        return _rwAsync(job);
+    }
+
+    Async::Task<usize> readvAsync(Strong<Fd> fd, Slice<MutBytes> bufs, usize offset) override {
+        auto job = makeStrong<_RwJob>(fd, offset, false);
+        for (auto buf : bufs)
+            job->_iovs.pushBack(iovec{buf.buf(), buf.len()});
+        return _rwAsync(job);
+    }
+
+    Async::Task<usize> writevAsync(Strong<Fd> fd, Slice<Bytes> bufs, usize offset) override {
+        auto job = makeStrong<_RwJob>(fd, offset, true);
+        for (auto &buf : bufs)
+            job->_iovs.pushBack(iovec{const_cast<Byte *>(buf.buf()), buf.len()});
+        return _rwAsync(job);
+    }
+
+    // MARK: Splice ------------------------------------------------------------
+
+    struct _SpliceJob : public _Job {
+        Strong<Fd> _in;
+        u64 _offset;
+        Strong<Fd> _out;
+        usize _len;
+        Async::Promise<usize> _promise;
+
+        _SpliceJob(Strong<Fd> in, u64 offset, Strong<Fd> out, usize len)
+            : _in(in), _offset(offset), _out(out), _len(len) {}
+
+        void submit(io_uring_sqe *sqe) override {
+            io_uring_prep_splice(
+                sqe,
+                _in->handle().value(), _offset,
+                _out->handle().value(), CURRENT_POS,
+                _len, 0
+            );
+        }
+
+        void complete(io_uring_cqe *cqe) override {
+            if (cqe->res < 0)
+                _promise.resolve(Posix::fromErrno(-cqe->res));
+            else
+                _promise.resolve(Ok((usize)cqe->res));
+        }
+    };
+
+    Async::Task<usize> _spliceAsync(Strong<Fd> in, u64 offset, Strong<Fd> out, usize len) {
+        auto job = makeStrong<_SpliceJob>(in, offset, out, len);
+        auto future = job->_promise.future();
+        submit(job);
+        return Async::makeTask(future);
+    }
+
+    Res<Pair<Strong<Fd>>> _takePipe() {
+        if (_pipes.len())
+            return Ok(_pipes.popBack());
+
+        int fds[2];
+        if (::pipe2(fds, O_CLOEXEC) < 0)
+            return Posix::fromLastErrno();
+
+        return Ok(Pair<Strong<Fd>>{
+            makeStrong<Posix::Fd>(fds[0]),
+            makeStrong<Posix::Fd>(fds[1]),
+        });
+    }
+
+    Async::Task<usize> transferAsync(Strong<Fd> from, Strong<Fd> to, usize offset, usize size) override {
+        // The kernel only splices from or to a pipe, so the
+        // pages go from the file to a pipe, then to `to`.
+        auto [pipeOut, pipeIn] = co_try$(_takePipe());
+
+        usize total = 0;
+        while (total < size) {
+            usize filled = co_trya$(_spliceAsync(from, offset + total, pipeIn, min(size - total, PIPE_LEN)));
+            if (filled == 0)
+                break;
+
+            usize drained = 0;
+            while (drained < filled) {
+                usize n = co_trya$(_spliceAsync(pipeOut, CURRENT_POS, to, filled - drained));
+                if (n == 0)
+                    co_return Error::writeZero();
+                drained += n;
+            }
+
+            total += filled;
+        }
+
+        // Only pipes that were drained are reused, the
+        // others are closed as they go out of scope.
+        if (_pipes.len() < MAX_PIPES)
+            _pipes.pushBack(Pair<Strong<Fd>>{pipeOut, pipeIn});
+
+        co_return Ok(total);
+    }
+
     Async::Task<_Accepted> acceptAsync(Strong<Fd> fd) override {
+        if (_bufRing) {
+            auto handle = fd->handle().value();
+            if (not _listeners.has(handle))
+                _listeners.put(handle, makeStrong<_Listener>(fd, _registerFile(handle)));
+
+            auto listener = _listeners.get(handle);
+            if (listener->_ready.len())
+                return Async::makeTask(Async::One<Res<_Accepted>>{listener->_ready.popFront()});
+
+            Async::Promise<_Accepted> promise;
+            auto future = promise.future();
+            listener->_waiting.pushBack(std::move(promise));
+            if (not listener->_job)
+                _armAccept(listener);
+            return Async::makeTask(future);
+        }
+
         struct Job : public _Job {
             Strong<Fd> _fd;
             sockaddr_in _addr{};
@@ -314,7 +897,27 @@ struct UringSched : public Sys::Sched {
         return Async::makeTask(job->future());
     }
 
+    void _complete(io_uring_cqe *cqe) {
+        auto index = _lookup(io_uring_cqe_get_data64(cqe));
+        if (not index)
+            return;
+
+        // Completing the job might submit new ones and move the slab around.
+        Strong<_Job> job = _jobs[*index].job.unwrap();
+
+        // Multishot jobs keep their slot until the last completion.
+        if (not(cqe->flags & IORING_CQE_F_MORE)) {
+            _jobs[*index].job = NONE;
+            _jobs[*index].gen++;
+            _freeJobs.pushBack(*index);
+        }
+
+        job->complete(cqe);
+    }
+
     Res<> wait(TimeStamp until) override {
+        _sweepListeners();
+
         // HACK: io_uring_wait_cqes doesn't support absolute timeout
         //       so we have to do it ourselves
         TimeStamp now = Sys::now();
@@ -323,20 +926,22 @@ struct UringSched : public Sys::Sched {
         if (now < until)
             delta = until - now;
 
+        // Everything queued since the last iteration
+        // goes to the kernel in a single call.
         struct __kernel_timespec ts = toKernelTimespec(delta);
-        Array<io_uring_cqe *, NCQES> cqes{};
-        io_uring_wait_cqes(&_ring, cqes.buf(), 1, &ts, nullptr);
+        io_uring_cqe *cqe = nullptr;
+        io_uring_submit_and_wait_timeout(&_ring, &cqe, 1, &ts, nullptr);
 
-        for (auto *cqe : cqes) {
-            if (not cqe)
-                break;
+        _freeFiles.pushBack(_releasedFiles);
+        _releasedFiles.clear();
 
-            auto id = cqe->user_data;
-            auto job = _jobs.get(id);
-            job->complete(cqe);
-            _jobs.del(id);
-            io_uring_cqe_seen(&_ring, cqe);
+        Array<io_uring_cqe *, NCQES> cqes{};
+        while (usize n = io_uring_peek_batch_cqe(&_ring, cqes.buf(), NCQES)) {
+            for (usize i = 0; i < n; i++)
+                _complete(cqes[i]);
+            io_uring_cq_advance(&_ring, n);
         }
+
         return Ok();
     }
 };
@@ -3,6 +3,8 @@
 #include <karm-base/time.h>
 #include <karm-logger/logger.h>
 #include <karm-sys/_embed.h>
+#include <karm-sys/mutex.h>
+#include <karm-sys/thread.h>
 
 #include "externs.h"
 
@@ -93,6 +95,10 @@ Res<Strong<Sys::Fd>> unpackFd(Io::PackScan &) {
     notImplemented();
 }
 
+Res<usize> transfer(Strong<Sys::Fd>, Strong<Sys::Fd>, usize) {
+    return Error::notImplemented();
+}
+
 Res<Vec<DirEntry>> readDir(Mime::Url const &) {
     return Error::notImplemented("directory listing not supported");
 }
@@ -133,6 +139,10 @@ Res<Strong<Fd>> listenIpc(Mime::Url) {
     return Error::notImplemented("ipc sockets not supported");
 }
 
+Res<> shutdown(Strong<Fd>) {
+    return Error::notImplemented("raw sockets not supported");
+}
+
 // MARK: Memory Managment ------------------------------------------------------
 
 Res<MmapResult> memMap(MmapOptions const &, Strong<Fd>) {
@@ -171,6 +181,30 @@ Res<> populate(Vec<Sys::UserInfo> &) {
     return Ok();
 }
 
+// MARK: Threads ---------------------------------------------------------------
+
+Res<Strong<Sys::Thread>> spawnThread(Func<void()>) {
+    return Error::notImplemented();
+}
+
+usize concurrency() {
+    return 1;
+}
+
+Res<Strong<Sys::Sema>> createSema(usize) {
+    return Error::notImplemented();
+}
+
+static void *_currentWorker = nullptr;
+
+void *currentWorker() {
+    return _currentWorker;
+}
+
+void setCurrentWorker(void *worker) {
+    _currentWorker = worker;
+}
+
 // MARK: Sandboxing ------------------------------------------------------------
 
 void hardenSandbox() {
@@ -2,6 +2,7 @@
 
 #include <hal/vmm.h>
 #include <karm-base/array.h>
+#include <karm-base/hash.h>
 #include <karm-base/time.h>
 
 namespace Hj {
@@ -146,6 +147,10 @@ struct Cap {
 
     std::strong_ordering operator<=>(Cap const &other) const = default;
 
+    Hash hash() const {
+        return Karm::hash(_raw);
+    }
+
     usize slot() const {
         auto curr = _raw & MASK;
         auto upper = _raw >> SHIFT;
@@ -1,3 +1,4 @@
+#include <karm-base/align.h>
 #include <karm-base/bits.h>
 #include <karm-base/lock.h>
 #include <karm-base/size.h>
@@ -143,7 +144,10 @@ Res<> initMem(Handover::Payload &payload) {
 
     logInfo("mem: usable range: {x}-{x}", usableRange.start, usableRange.end());
 
-    usize bitsSize = Hal::pageAlignUp(usableRange.size / Hal::PAGE_SIZE / 8);
+    // The bitmap is followed by its summary, which needs to be word aligned
+    usize bitmapSize = alignUp(usableRange.size / Hal::PAGE_SIZE, 64) / 8;
+    usize summarySize = Bits::summaryLen(bitmapSize) * sizeof(u64);
+    usize bitsSize = Hal::pageAlignUp(bitmapSize + summarySize);
 
     auto pmmBits = _findBitmapSpace(payload, bitsSize);
 
@@ -156,9 +160,15 @@ Res<> initMem(Handover::Payload &payload) {
 
     _pmm.emplace(
         usableRange,
-        MutSlice{
-            reinterpret_cast<u8 *>(pmmBits.start + Hal::UPPER_HALF),
-            pmmBits.size,
+        Bits{
+            MutSlice{
+                reinterpret_cast<u8 *>(pmmBits.start + Hal::UPPER_HALF),
+                bitmapSize,
+            },
+            MutSlice{
+                reinterpret_cast<u64 *>(pmmBits.start + Hal::UPPER_HALF + bitmapSize),
+                Bits::summaryLen(bitmapSize),
+            },
         }
     );
 
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <karm-base/list.h>
+#include <karm-base/lock.h>
+#include <karm-base/mpmc.h>
+
+#include "awaiter.h"
+
+namespace Karm::Async {
+
+// A bounded queue that can be shared between threads, values
+// can be awaited from any of them.
+//
+// NOTE: When a value is handed to a waiting consumer, the consumer
+//       is resumed on the thread of the producer.
+template <typename T>
+struct MpmcQueue : Meta::Pinned {
+    struct _Listener {
+        LlItem<_Listener> item;
+        Opt<T> value;
+        virtual ~_Listener() = default;
+        virtual void complete() = 0;
+    };
+
+    Mpmc<T> _ring;
+    Lock _lock;
+    Ll<_Listener> _listeners;
+    Atomic<usize> _waiting{};
+
+    MpmcQueue(usize cap)
+        : _ring(cap) {}
+
+    // Returns false if the queue is full, `value` is
+    // only moved from if it was enqueued.
+    bool tryEnqueue(T &&value) {
+        if (not _ring.tryPush(std::move(value)))
+            return false;
+        _dispatch();
+        return true;
+    }
+
+    bool tryEnqueue(T const &value) {
+        if (not _ring.tryPush(value))
+            return false;
+        _dispatch();
+        return true;
+    }
+
+    // Returns how many values, from the start of `values`, were enqueued.
+    usize tryEnqueueMany(MutSlice<T> values) {
+        usize n = _ring.tryPushMany(values);
+        if (n)
+            _dispatch();
+        return n;
+    }
+
+    Opt<T> tryDequeue() {
+        return _ring.tryPop();
+    }
+
+    // Returns how many values were written at the start of `out`.
+    usize tryDequeueMany(MutSlice<T> out) {
+        return _ring.tryPopMany(out);
+    }
+
+    // Hand the values that were just pushed to the consumers waiting on them.
+    void _dispatch() {
+        // Pairs with the one in _GetOperation::start(), either the consumer
+        // sees the value or we see the consumer.
+        memoryBarier();
+        if (_waiting.load(RELAXED) == 0)
+            return;
+
+        while (true) {
+            _Listener *listener = nullptr;
+            {
+                LockScope scope{_lock};
+                if (_listeners.empty())
+                    return;
+
+                auto value = _ring.tryPop();
+                if (not value)
+                    return;
+
+                listener = _listeners.detach(_listeners.head());
+                listener->value = std::move(value);
+                _waiting.dec();
+            }
+            listener->complete();
+        }
+    }
+
+    template <Receiver<T> R>
+    struct _GetOperation : private _Listener {
+        using _Listener::value;
+
+        MpmcQueue *_q;
+        R _r;
+
+        _GetOperation(MpmcQueue *q, R r)
+            : _q{q}, _r{std::move(r)} {}
+
+        bool start() {
+            if (auto value = _q->_ring.tryPop()) {
+                _r.recv(INLINE, value.take());
+                return true;
+            }
+
+            Opt<T> late = NONE;
+            {
+                LockScope scope{_q->_lock};
+                _q->_waiting.inc();
+                late = _q->_ring.tryPop();
+                if (late) {
+                    _q->_waiting.dec();
+                } else {
+                    _q->_listeners.append(this, _q->_listeners.tail());
+                    return false;
+                }
+            }
+
+            _r.recv(INLINE, late.take());
+            return true;
+        }
+
+        void complete() override {
+            _r.recv(LATER, value.take());
+        }
+    };
+
+    struct _GetSender {
+        using Inner = T;
+        MpmcQueue *_q;
+
+        auto connect(Receiver<T> auto r) -> _GetOperation<decltype(r)> {
+            return {_q, std::move(r)};
+        }
+    };
+
+    auto dequeueAsync() {
+        return _GetSender{this};
+    }
+
+    bool empty() {
+        return _ring.empty();
+    }
+};
+
+} // namespace Karm::Async
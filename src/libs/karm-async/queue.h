@@ -1,7 +1,8 @@
 #pragma once
 
+#include <karm-base/clamp.h>
 #include <karm-base/list.h>
-#include <karm-base/vec.h>
+#include <karm-base/ring.h>
 
 #include "awaiter.h"
 
@@ -16,7 +17,7 @@ struct Queue {
         virtual void complete() = 0;
     };
 
-    Vec<T> _buf;
+    Ring<T> _buf;
     Ll<_Listener> _listeners;
 
     Queue() = default;
@@ -24,6 +25,8 @@ struct Queue {
     template <typename... Ts>
     void emplace(Ts &&...arg) {
         if (_listeners.empty()) {
+            if (_buf.rem() == 0)
+                _buf.ensure(max(_buf.cap() * 2, 16uz));
             _buf.emplaceBack(std::forward<Ts>(arg)...);
             return;
         }
@@ -82,7 +85,7 @@ struct Queue {
     }
 
     bool empty() {
-        return ::isEmpty(_buf);
+        return _buf.len() == 0;
     }
 
     Opt<T> dequeue() {
@@ -1,3 +1,4 @@
+#include <karm-async/mpmc.h>
 #include <karm-async/one.h>
 #include <karm-async/queue.h>
 #include <karm-test/macros.h>
@@ -49,4 +50,55 @@ test$("karm-queue-dequeue-enqueue") {
     return Ok();
 }
 
+test$("karm-queue-many") {
+    Queue<isize> q;
+    for (isize i = 0; i < 100; i++)
+        q.enqueue(i);
+
+    for (isize i = 0; i < 100; i++)
+        expectEq$(q.dequeue(), i);
+    expect$(q.empty());
+
+    return Ok();
+}
+
+test$("karm-mpmc-queue-enqueue-dequeue") {
+    MpmcQueue<isize> q{4};
+    expect$(q.tryEnqueue(42));
+    expect$(q.tryEnqueue(69));
+
+    auto res1 = Async::run(q.dequeueAsync());
+    auto res2 = Async::run(q.dequeueAsync());
+
+    expectEq$(res1, 42);
+    expectEq$(res2, 69);
+
+    return Ok();
+}
+
+test$("karm-mpmc-queue-dequeue-enqueue") {
+    MpmcQueue<isize> q{4};
+
+    isize res1 = 0;
+    isize res2 = 0;
+
+    Async::detach(q.dequeueAsync(), [&](isize v) {
+        res1 = v;
+    });
+
+    Async::detach(q.dequeueAsync(), [&](isize v) {
+        res2 = v;
+    });
+
+    Array<isize, 3> values = {42, 69, 96};
+    expectEq$(q.tryEnqueueMany(values), 3uz);
+
+    expectEq$(res1, 42);
+    expectEq$(res2, 69);
+    expectEq$(q.tryDequeue(), 96);
+    expect$(q.empty());
+
+    return Ok();
+}
+
 } // namespace Karm::Async::Tests
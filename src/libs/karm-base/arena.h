@@ -0,0 +1,431 @@
+#pragma once
+
+#include <karm-meta/nocopy.h>
+
+#include "align.h"
+#include "clamp.h"
+#include "manual.h"
+#include "size.h"
+#include "string.h"
+#include "vec.h"
+
+namespace Karm {
+
+#pragma clang unsafe_buffer_usage begin
+
+/// A chunked bump allocator.
+///
+/// Allocations are carved out of large chunks and are all released at once
+/// when the arena is reset or destroyed, there is no way to free a single
+/// allocation. This is a good fit for the many small objects built by a parser
+/// that all die together.
+///
+/// Objects created with `make()` have their destructor registered and run in
+/// reverse order of construction on reset.
+struct Arena : Meta::Pinned {
+    static constexpr usize CHUNK_SIZE = kib(64);
+    static constexpr usize ALIGN = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    struct _Chunk {
+        _Chunk *next;
+        usize cap;
+
+        u8 *buf() {
+            return reinterpret_cast<u8 *>(this + 1);
+        }
+    };
+
+    struct _Dtor {
+        _Dtor *next;
+        void (*fn)(void *);
+        void *obj;
+    };
+
+    usize _chunkSize;
+    _Chunk *_chunks = nullptr;
+    u8 *_ptr = nullptr;
+    u8 *_end = nullptr;
+    _Dtor *_dtors = nullptr;
+    usize _used = 0;
+
+    Arena(usize chunkSize = CHUNK_SIZE)
+        : _chunkSize(chunkSize) {}
+
+    ~Arena() {
+        reset();
+        _release(_chunks);
+    }
+
+    static _Chunk *_newChunk(usize cap) {
+        auto *chunk = reinterpret_cast<_Chunk *>(new u8[sizeof(_Chunk) + cap]);
+        chunk->next = nullptr;
+        chunk->cap = cap;
+        return chunk;
+    }
+
+    static void _release(_Chunk *chunk) {
+        while (chunk) {
+            auto *next = chunk->next;
+            delete[] reinterpret_cast<u8 *>(chunk);
+            chunk = next;
+        }
+    }
+
+    void *_allocSlow(usize size, usize align) {
+        usize need = size + align;
+
+        // Big allocations get a chunk of their own, so they
+        // don't waste what is left of the current one.
+        if (need > _chunkSize / 4) {
+            auto *chunk = _newChunk(need);
+            if (_chunks) {
+                chunk->next = _chunks->next;
+                _chunks->next = chunk;
+            } else {
+                _chunks = chunk;
+                _ptr = _end = chunk->buf() + chunk->cap;
+            }
+            _used += size;
+            return reinterpret_cast<void *>(alignUp(reinterpret_cast<usize>(chunk->buf()), align));
+        }
+
+        auto *chunk = _newChunk(_chunkSize);
+        chunk->next = _chunks;
+        _chunks = chunk;
+        _ptr = chunk->buf();
+        _end = _ptr + chunk->cap;
+        return alloc(size, align);
+    }
+
+    /// Allocate `size` bytes aligned to `align`, the memory is
+    /// uninitialized and lives until the arena is reset.
+    always_inline void *alloc(usize size, usize align = ALIGN) {
+        usize addr = alignUp(reinterpret_cast<usize>(_ptr), align);
+        if (_ptr and addr + size <= reinterpret_cast<usize>(_end)) [[likely]] {
+            _ptr = reinterpret_cast<u8 *>(addr + size);
+            _used += size;
+            return reinterpret_cast<void *>(addr);
+        }
+        return _allocSlow(size, align);
+    }
+
+    /// Try to extend the last allocation in place, returns false if it
+    /// isn't the last one or if there is no room left in the chunk.
+    bool grow(void *ptr, usize oldSize, usize newSize) {
+        auto *p = static_cast<u8 *>(ptr);
+        if (p + oldSize != _ptr or newSize > static_cast<usize>(_end - p))
+            return false;
+        _used += newSize - oldSize;
+        _ptr = p + newSize;
+        return true;
+    }
+
+    /// Construct a T in the arena, its destructor
+    /// will be called when the arena is reset.
+    template <typename T, typename... Args>
+    T &make(Args &&...args) {
+        if constexpr (Meta::TrivialyDestructible<T>) {
+            return *new (alloc(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        } else {
+            auto *dtor = static_cast<_Dtor *>(alloc(sizeof(_Dtor), alignof(_Dtor)));
+            auto *obj = new (alloc(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            *dtor = {
+                _dtors,
+                [](void *obj) {
+                    static_cast<T *>(obj)->~T();
+                },
+                obj,
+            };
+            _dtors = dtor;
+            return *obj;
+        }
+    }
+
+    /// Copy a string into the arena, the copy is null-terminated.
+    template <StaticEncoding E>
+    _Str<E> copy(_Str<E> str) {
+        using U = typename E::Unit;
+        auto *buf = static_cast<U *>(alloc(sizeof(U) * (str.len() + 1), alignof(U)));
+        if (str.len())
+            __builtin_memcpy(buf, str.buf(), sizeof(U) * str.len());
+        buf[str.len()] = 0;
+        return {buf, str.len()};
+    }
+
+    /// Run the registered destructors and release the memory, the first
+    /// chunk is kept around so that reusing the arena doesn't allocate.
+    void reset() {
+        while (_dtors) {
+            auto *dtor = _dtors;
+            _dtors = dtor->next;
+            dtor->fn(dtor->obj);
+        }
+
+        _Chunk *keep = nullptr;
+        _Chunk *chunk = _chunks;
+        while (chunk) {
+            auto *next = chunk->next;
+            if (not keep and chunk->cap == _chunkSize) {
+                keep = chunk;
+                keep->next = nullptr;
+            } else {
+                delete[] reinterpret_cast<u8 *>(chunk);
+            }
+            chunk = next;
+        }
+
+        _chunks = keep;
+        _ptr = keep ? keep->buf() : nullptr;
+        _end = keep ? keep->buf() + keep->cap : nullptr;
+        _used = 0;
+    }
+
+    /// Number of bytes handed out since the last reset.
+    usize used() const {
+        return _used;
+    }
+};
+
+/// A buffer backed by an arena, growing it doesn't release the
+/// old storage, it is reclaimed when the arena is reset.
+///
+/// NOTE: The arena must outlive the buffer.
+template <typename T>
+struct ArenaBuf {
+    using Inner = T;
+
+    Arena *_arena{};
+    Manual<T> *_buf{};
+    usize _cap{};
+    usize _len{};
+
+    ArenaBuf() = default;
+
+    ArenaBuf(Arena &arena, usize cap = 0)
+        : _arena(&arena) {
+        ensure(cap);
+    }
+
+    ArenaBuf(Arena &arena, Sliceable<T> auto const &other)
+        : _arena(&arena) {
+        ensure(other.len());
+
+        _len = other.len();
+        for (usize i = 0; i < _len; i++)
+            _buf[i].ctor(other[i]);
+    }
+
+    ArenaBuf(ArenaBuf const &other)
+        : _arena(other._arena) {
+        ensure(other._len);
+
+        _len = other._len;
+        for (usize i = 0; i < _len; i++)
+            _buf[i].ctor(other[i]);
+    }
+
+    ArenaBuf(ArenaBuf &&other) {
+        std::swap(_arena, other._arena);
+        std::swap(_buf, other._buf);
+        std::swap(_cap, other._cap);
+        std::swap(_len, other._len);
+    }
+
+    ~ArenaBuf() {
+        for (usize i = 0; i < _len; i++)
+            _buf[i].dtor();
+    }
+
+    ArenaBuf &operator=(ArenaBuf const &other) {
+        *this = ArenaBuf(other);
+        return *this;
+    }
+
+    ArenaBuf &operator=(ArenaBuf &&other) {
+        std::swap(_arena, other._arena);
+        std::swap(_buf, other._buf);
+        std::swap(_cap, other._cap);
+        std::swap(_len, other._len);
+        return *this;
+    }
+
+    constexpr T &operator[](usize i) lifetimebound {
+        return _buf[i].unwrap();
+    }
+
+    constexpr T const &operator[](usize i) const lifetimebound {
+        return _buf[i].unwrap();
+    }
+
+    void ensure(usize desired) {
+        if (desired <= _cap)
+            return;
+
+        if (not _arena) [[unlikely]]
+            panic("no arena");
+
+        usize newCap = max(_cap * 2, desired);
+
+        if (_buf and _arena->grow(_buf, _cap * sizeof(T), newCap * sizeof(T))) {
+            _cap = newCap;
+            return;
+        }
+
+        auto *tmp = static_cast<Manual<T> *>(_arena->alloc(newCap * sizeof(T), alignof(T)));
+        for (usize i = 0; i < _len; i++)
+            tmp[i].ctor(_buf[i].take());
+
+        _buf = tmp;
+        _cap = newCap;
+    }
+
+    void fit() {
+        // no-op, the memory can't be given back to the arena
+    }
+
+    template <typename... Args>
+    auto &emplace(usize index, Args &&...args) {
+        ensure(_len + 1);
+
+        for (usize i = _len; i > index; i--) {
+            _buf[i].ctor(_buf[i - 1].take());
+        }
+
+        _buf[index].ctor(std::forward<Args>(args)...);
+        _len++;
+        return _buf[index].unwrap();
+    }
+
+    void insert(usize index, T &&value) {
+        ensure(_len + 1);
+
+        for (usize i = _len; i > index; i--) {
+            _buf[i].ctor(_buf[i - 1].take());
+        }
+
+        _buf[index].ctor(std::move(value));
+        _len++;
+    }
+
+    void replace(usize index, T &&value) {
+        if (index >= _len) {
+            insert(index, std::move(value));
+            return;
+        }
+
+        _buf[index].dtor();
+        _buf[index].ctor(std::move(value));
+    }
+
+    void insert(Copy, usize index, T const *first, usize count) {
+        ensure(_len + count);
+
+        for (usize i = _len; i > index; i--) {
+            _buf[i + count - 1].ctor(_buf[i - 1].take());
+        }
+
+        for (usize i = 0; i < count; i++) {
+            _buf[index + i].ctor(first[i]);
+        }
+
+        _len += count;
+    }
+
+    void insert(Move, usize index, T *first, usize count) {
+        ensure(_len + count);
+
+        for (usize i = _len; i > index; i--) {
+            _buf[i + count - 1].ctor(_buf[i - 1].take());
+        }
+
+        for (usize i = 0; i < count; i++) {
+            _buf[index + i].ctor(std::move(first[i]));
+        }
+
+        _len += count;
+    }
+
+    T removeAt(usize index) {
+        if (index >= _len) [[unlikely]]
+            panic("index out of bounds");
+
+        T ret = _buf[index].take();
+        for (usize i = index; i < _len - 1; i++) {
+            _buf[i].ctor(_buf[i + 1].take());
+        }
+        _len--;
+        return ret;
+    }
+
+    void removeRange(usize index, usize count) {
+        if (index > _len) [[unlikely]]
+            panic("index out of bounds");
+
+        if (index + count > _len) [[unlikely]]
+            panic("index + count out of bounds");
+
+        for (usize i = index; i < index + count; i++)
+            _buf[i].dtor();
+
+        for (usize i = index; i < _len - count; i++)
+            _buf[i].ctor(_buf[i + count].take());
+
+        _len -= count;
+    }
+
+    void resize(usize newLen, T fill = {}) {
+        if (newLen > _len) {
+            ensure(newLen);
+            for (usize i = _len; i < newLen; i++) {
+                _buf[i].ctor(fill);
+            }
+        } else if (newLen < _len) {
+            for (usize i = newLen; i < _len; i++) {
+                _buf[i].dtor();
+            }
+        }
+        _len = newLen;
+    }
+
+    void trunc(usize newLen) {
+        if (newLen >= _len)
+            return;
+
+        for (usize i = newLen; i < _len; i++) {
+            _buf[i].dtor();
+        }
+
+        _len = newLen;
+    }
+
+    T *buf() lifetimebound {
+        if (_buf == nullptr)
+            return nullptr;
+        return &_buf->unwrap();
+    }
+
+    T const *buf() const lifetimebound {
+        if (_buf == nullptr)
+            return nullptr;
+        return &_buf->unwrap();
+    }
+
+    usize len() const {
+        return _len;
+    }
+
+    usize cap() const {
+        return _cap;
+    }
+
+    usize size() const {
+        return _len * sizeof(T);
+    }
+};
+
+template <typename T>
+using ArenaVec = _Vec<ArenaBuf<T>>;
+
+#pragma clang unsafe_buffer_usage end
+
+} // namespace Karm
@@ -0,0 +1,52 @@
+#include "atom.h"
+
+#include "lock.h"
+#include "map.h"
+
+namespace Karm {
+
+struct _AtomTable {
+    Lock lock;
+    _HashTable<_AtomEntry *> entries;
+
+    Opt<usize> find(Hash hash, Str str) {
+        return entries.find(entries.mix(hash), [&](_AtomEntry const *e) {
+            return e->hash == hash and Str{e->str} == str;
+        });
+    }
+};
+
+static _AtomTable &_atoms() {
+    static _AtomTable table;
+    return table;
+}
+
+_AtomEntry const *_atomIntern(Str str) {
+    if (str.len() == 0)
+        return nullptr;
+
+    auto &atoms = _atoms();
+    Hash h = hash(str);
+
+    LockScope scope{atoms.lock};
+    if (auto slot = atoms.find(h, str))
+        return atoms.entries.at(*slot);
+
+    auto *entry = new _AtomEntry{h, str};
+    atoms.entries.insert(atoms.entries.mix(h), entry, [](_AtomEntry const *e) {
+        return _HashTable<_AtomEntry *>::mix(e->hash);
+    });
+    return entry;
+}
+
+_AtomEntry const *_atomLookup(Str str) {
+    auto &atoms = _atoms();
+    Hash h = hash(str);
+
+    LockScope scope{atoms.lock};
+    if (auto slot = atoms.find(h, str))
+        return atoms.entries.at(*slot);
+    return nullptr;
+}
+
+} // namespace Karm
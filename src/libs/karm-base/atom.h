@@ -0,0 +1,92 @@
+#pragma once
+
+#include "hash.h"
+#include "opt.h"
+#include "string.h"
+
+namespace Karm {
+
+struct _AtomEntry {
+    Hash hash;
+    String str;
+};
+
+_AtomEntry const *_atomIntern(Str str);
+
+_AtomEntry const *_atomLookup(Str str);
+
+// An interned string, for identifiers that get compared a lot.
+//
+// Equal strings are interned to the same entry of a global table, so
+// comparing two atoms is comparing two pointers, and their hash is computed
+// once when they are interned.
+//
+// NOTE: Entries are never freed, so atoms should only be made of strings
+//       from a bounded set, like names and identifiers, not arbitrary text.
+struct Atom {
+    _AtomEntry const *_entry = nullptr; // nullptr is the empty string
+
+    constexpr Atom() = default;
+
+    Atom(Str str)
+        : _entry(_atomIntern(str)) {}
+
+    Atom(Sliceable<char> auto const &str)
+        : Atom(Str{str}) {}
+
+    Atom(char const *str)
+        : Atom(Str{str}) {}
+
+    // Returns the atom for the string, if it has already been interned,
+    // without interning it.
+    static Opt<Atom> lookup(Str str) {
+        if (str.len() == 0)
+            return Atom{};
+
+        auto *entry = _atomLookup(str);
+        if (not entry)
+            return NONE;
+
+        Atom atom;
+        atom._entry = entry;
+        return atom;
+    }
+
+    Str str() const {
+        if (not _entry)
+            return ""s;
+        return _entry->str;
+    }
+
+    operator Str() const {
+        return str();
+    }
+
+    usize len() const {
+        return str().len();
+    }
+
+    explicit operator bool() const {
+        return _entry != nullptr;
+    }
+
+    Hash hash() const {
+        if (not _entry)
+            return 0;
+        return _entry->hash;
+    }
+
+    bool operator==(Atom const &other) const = default;
+
+    bool operator==(Str other) const {
+        return str() == other;
+    }
+
+    std::strong_ordering operator<=>(Atom const &other) const {
+        if (_entry == other._entry)
+            return std::strong_ordering::equal;
+        return str() <=> other.str();
+    }
+};
+
+} // namespace Karm
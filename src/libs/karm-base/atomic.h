@@ -13,6 +13,10 @@ enum MemOrder {
     SEQ_CST = __ATOMIC_SEQ_CST
 };
 
+// Assumed size of a cache line, data written by different threads
+// is kept that far apart so they don't fight over the same line.
+static constexpr usize CACHE_LINE_SIZE = 64;
+
 inline void memoryBarier(MemOrder order = SEQ_CST) {
     __atomic_thread_fence(order);
 }
@@ -36,10 +40,14 @@ struct Atomic {
     }
 
     always_inline bool cmpxchg(T expected, T desired, MemOrder order = MemOrder::SEQ_CST) {
-        if (order == ACQ_REL or order == RELAXED)
-            return __atomic_compare_exchange_n(&_val, &expected, desired, false, RELAXED, ACQUIRE);
-
-        return __atomic_compare_exchange_n(&_val, &expected, desired, false, order, order);
+        // The failure ordering can't have a release part
+        MemOrder failure = order;
+        if (order == ACQ_REL)
+            failure = ACQUIRE;
+        else if (order == RELEASE)
+            failure = RELAXED;
+
+        return __atomic_compare_exchange_n(&_val, &expected, desired, false, order, failure);
     }
 
     always_inline T fetchAdd(T desired, MemOrder order = MemOrder::SEQ_CST) {
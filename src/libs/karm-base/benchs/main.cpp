@@ -0,0 +1,379 @@
+#include <karm-base/arena.h>
+#include <karm-base/bits.h>
+#include <karm-base/map.h>
+#include <karm-base/set.h>
+#include <karm-io/fmt.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+
+static constexpr isize SAMPLES = 100;
+
+static void bench(Str name, auto fn) {
+    Vec<TimeSpan> samples;
+
+    for (isize i = 0; i < SAMPLES; i++) {
+        auto start = Sys::now();
+        fn();
+        auto elapsed = Sys::now() - start;
+        samples.pushBack(elapsed);
+
+        Sys::print("{}: sampling {}/{}: {}\r", name, i + 1, SAMPLES, elapsed);
+    }
+
+    // median
+    sort(samples, [](auto &a, auto &b) {
+        return a.toUSecs() <=> b.toUSecs();
+    });
+
+    // average
+    f64 sum = 0;
+    for (auto &s : samples)
+        sum += s.toUSecs();
+
+    Sys::println("\n");
+    Sys::println("{}:", name);
+    Sys::println("  median: {}", samples[samples.len() / 2]);
+    Sys::println("  average: {}", TimeSpan::fromUSecs(sum / samples.len()));
+    Sys::println("  min: {}", first(samples));
+    Sys::println("  max: {}", last(samples));
+    Sys::println("");
+}
+
+// Keep the compiler from optimizing the benchmarked code away.
+static void sink(usize v) {
+    asm volatile("" : : "r,m"(v) : "memory");
+}
+
+static u64 next(u64 &state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// MARK: Map -------------------------------------------------------------------
+
+static constexpr usize LOOKUPS = 100000;
+
+static void benchMapLookup(usize entries) {
+    Map<usize, usize> map;
+    for (usize i = 0; i < entries; i++)
+        map.put(i * 7, i);
+
+    // Half of the lookups miss
+    Vec<usize> keys;
+    u64 state = 0x2545f4914f6cdd1d;
+    for (usize i = 0; i < LOOKUPS; i++)
+        keys.pushBack((next(state) % (entries * 2)) * 7 / 2);
+
+    bench(Io::format("map-lookup-{}", entries).unwrap(), [&] {
+        usize found = 0;
+        for (auto k : keys)
+            if (map.has(k))
+                found++;
+        sink(found);
+    });
+}
+
+static void benchMapStringLookup(usize entries) {
+    Map<String, usize> map;
+    Vec<String> keys;
+    for (usize i = 0; i < entries; i++) {
+        auto key = Io::format("key-{}", i).unwrap();
+        map.put(key, i);
+        keys.pushBack(key);
+    }
+
+    bench(Io::format("map-string-lookup-{}", entries).unwrap(), [&] {
+        usize sum = 0;
+        for (usize i = 0; i < LOOKUPS; i++)
+            sum += map.get(keys[i % entries]);
+        sink(sum);
+    });
+}
+
+static void benchMapInsert(usize entries) {
+    bench(Io::format("map-insert-{}", entries).unwrap(), [&] {
+        Map<usize, usize> map;
+        for (usize i = 0; i < entries; i++)
+            map.put(i * 7, i);
+        sink(map.len());
+    });
+}
+
+// MARK: Sort ------------------------------------------------------------------
+
+static constexpr usize SORT_LEN = 1000000;
+
+static void benchSort(Str pattern, Vec<u32> const &input) {
+    bench(Io::format("sort-{}", pattern).unwrap(), [&] {
+        auto v = input;
+        sort(v);
+        sink(v[0]);
+    });
+
+    bench(Io::format("stable-sort-{}", pattern).unwrap(), [&] {
+        auto v = input;
+        stableSort(v);
+        sink(v[0]);
+    });
+
+    bench(Io::format("radix-sort-{}", pattern).unwrap(), [&] {
+        auto v = input;
+        radixSort(v);
+        sink(v[0]);
+    });
+}
+
+static void benchSorts() {
+    Vec<u32> random, sorted, reversed, few;
+    u64 state = 0x2545f4914f6cdd1d;
+    for (usize i = 0; i < SORT_LEN; i++) {
+        random.pushBack(next(state));
+        sorted.pushBack(i);
+        reversed.pushBack(SORT_LEN - i);
+        few.pushBack(next(state) % 16);
+    }
+
+    benchSort("random", random);
+    benchSort("sorted", sorted);
+    benchSort("reversed", reversed);
+    benchSort("few-unique", few);
+}
+
+// MARK: Hash ------------------------------------------------------------------
+
+static void benchHashThroughput(usize len) {
+    Vec<Byte> buf;
+    for (usize i = 0; i < len; i++)
+        buf.pushBack(i * 13);
+
+    usize iters = max((64uz << 20) / len, 1uz);
+    bench(Io::format("hash-bytes-{}", len).unwrap(), [&] {
+        Hash res = 0;
+        for (usize i = 0; i < iters; i++)
+            res ^= hash(Bytes{buf.buf(), len});
+        sink(res);
+    });
+}
+
+static Array CSS_IDENTS = {
+    "align-content"s, "align-items"s, "align-self"s, "background"s,
+    "background-color"s, "background-image"s, "border"s, "border-bottom"s,
+    "border-color"s, "border-left"s, "border-radius"s, "border-right"s,
+    "border-top"s, "border-width"s, "bottom"s, "box-sizing"s, "color"s,
+    "column-gap"s, "content"s, "display"s, "flex"s, "flex-basis"s,
+    "flex-direction"s, "flex-grow"s, "flex-shrink"s, "flex-wrap"s, "float"s,
+    "font"s, "font-family"s, "font-size"s, "font-style"s, "font-weight"s,
+    "gap"s, "grid"s, "grid-template-columns"s, "height"s, "justify-content"s,
+    "left"s, "line-height"s, "margin"s, "margin-bottom"s, "margin-left"s,
+    "margin-right"s, "margin-top"s, "max-height"s, "max-width"s,
+    "min-height"s, "min-width"s, "opacity"s, "outline"s, "overflow"s,
+    "overflow-x"s, "overflow-y"s, "padding"s, "padding-bottom"s,
+    "padding-left"s, "padding-right"s, "padding-top"s, "position"s,
+    "right"s, "row-gap"s, "text-align"s, "text-decoration"s,
+    "text-transform"s, "top"s, "transform"s, "transition"s,
+    "vertical-align"s, "visibility"s, "white-space"s, "width"s,
+    "word-break"s, "z-index"s, "auto"s, "none"s, "inherit"s, "initial"s,
+    "block"s, "inline"s, "inline-block"s, "absolute"s, "relative"s,
+    "fixed"s, "hidden"s, "visible"s, "bold"s, "normal"s, "center"s,
+};
+
+static Array FONT_NAMES = {
+    "Inter"s, "Inter Bold"s, "Inter Italic"s, "Roboto"s, "Roboto Mono"s,
+    "Roboto Slab"s, "Noto Sans"s, "Noto Serif"s, "Noto Color Emoji"s,
+    "DejaVu Sans"s, "DejaVu Sans Mono"s, "DejaVu Serif"s, "Liberation Sans"s,
+    "Liberation Serif"s, "Liberation Mono"s, "Fira Code"s, "Fira Sans"s,
+    "Source Code Pro"s, "Source Sans Pro"s, "Source Serif Pro"s,
+    "Open Sans"s, "Lato"s, "Montserrat"s, "Ubuntu"s, "Ubuntu Mono"s,
+    "JetBrains Mono"s, "IBM Plex Sans"s, "IBM Plex Mono"s, "Cantarell"s,
+    "Material Design Icons"s,
+};
+
+static Vec<String> _variants(Slice<Str> base, usize count) {
+    Vec<String> res;
+    for (usize i = 0; i < count; i++) {
+        auto b = base[i % base.len()];
+        if (i < base.len())
+            res.pushBack(b);
+        else
+            res.pushBack(Io::format("{}-{}", b, i / base.len()).unwrap());
+    }
+    return res;
+}
+
+static Vec<String> _urls(usize count) {
+    Vec<String> res;
+    u64 state = 0x2545f4914f6cdd1d;
+    for (usize i = 0; i < count; i++) {
+        res.pushBack(Io::format(
+                         "https://cdn{}.example.com/assets/{}/img_{}.png?v={}",
+                         i % 4, next(state) % 100, i, next(state) % 1000
+        )
+                         .unwrap());
+    }
+    return res;
+}
+
+// Compare the collisions in a table of 2^bits buckets with the ones
+// expected from a perfectly random hash.
+static void benchHashCollisions(Str name, Vec<String> const &keys) {
+    usize n = keys.len();
+    usize bits = 1;
+    while ((1uz << bits) < n * 2)
+        bits++;
+    usize buckets = 1uz << bits;
+
+    Set<Hash> full;
+    Vec<bool> used;
+    used.resize(buckets, false);
+    usize collisions = 0;
+    for (auto &k : keys) {
+        Hash h = hash(k);
+        full.put(h);
+        if (used[h & (buckets - 1)])
+            collisions++;
+        used[h & (buckets - 1)] = true;
+    }
+
+    // Each key has a (1 - 1/buckets)^n chance of landing in an empty bucket
+    f64 empty = 1;
+    for (usize i = 0; i < n; i++)
+        empty *= 1 - 1.0 / buckets;
+    f64 expected = n - buckets * (1 - empty);
+    Sys::println("{}:", name);
+    Sys::println("  keys: {}", n);
+    Sys::println("  full collisions: {}", n - full.len());
+    Sys::println("  bucket collisions: {} in {} buckets (random: {})", collisions, buckets, (usize)expected);
+    Sys::println("");
+
+    bench(Io::format("hash-{}", name).unwrap(), [&] {
+        Hash res = 0;
+        for (auto &k : keys)
+            res ^= hash(k);
+        sink(res);
+    });
+}
+
+static void benchHashes() {
+    for (usize len : {8, 16, 64, 256, 4096, 1 << 20})
+        benchHashThroughput(len);
+
+    benchHashCollisions("css-idents", _variants(CSS_IDENTS, CSS_IDENTS.len()));
+    benchHashCollisions("css-idents-100k", _variants(CSS_IDENTS, 100000));
+    benchHashCollisions("font-names-10k", _variants(FONT_NAMES, 10000));
+    benchHashCollisions("urls-100k", _urls(100000));
+}
+
+// MARK: Arena -----------------------------------------------------------------
+
+static constexpr usize NODES = 100000;
+
+struct _HeapAttr {
+    String name;
+    String value;
+};
+
+struct _ArenaAttr {
+    Str name;
+    Str value;
+};
+
+static void benchArena() {
+    bench("alloc-heap", [] {
+        Vec<Vec<_HeapAttr>> nodes;
+        for (usize i = 0; i < NODES; i++) {
+            Vec<_HeapAttr> attrs;
+            attrs.pushBack({"class"s, "item"s});
+            nodes.pushBack(std::move(attrs));
+        }
+        sink(nodes.len());
+    });
+
+    Arena arena;
+    bench("alloc-arena", [&] {
+        Vec<ArenaVec<_ArenaAttr>> nodes;
+        for (usize i = 0; i < NODES; i++) {
+            ArenaVec<_ArenaAttr> attrs{arena};
+            attrs.pushBack({arena.copy("class"s), arena.copy("item"s)});
+            nodes.pushBack(std::move(attrs));
+        }
+        sink(nodes.len());
+        nodes.clear();
+        arena.reset();
+    });
+}
+
+// MARK: Bits ------------------------------------------------------------------
+
+// 16 GiB of 4 KiB pages
+static constexpr usize PAGES = 4 * 1024 * 1024;
+static constexpr usize ALLOCS = 1000;
+
+// Mostly used memory with small holes scattered around,
+// and all the free memory left at the very end.
+static void _fragment(Bits &bits, u64 seed) {
+    bits.fill(true);
+    for (usize i = 0; i < 256; i++) {
+        usize start = next(seed) % (PAGES - PAGES / 8);
+        bits.set({start, 1 + next(seed) % 4}, false);
+    }
+    bits.set({PAGES - PAGES / 8, PAGES / 8}, false);
+}
+
+static void benchBitsAlloc(Str name, Bits &bits, usize count) {
+    _fragment(bits, 0x2545f4914f6cdd1d);
+    bench(Io::format("bits-alloc-{}-{}", name, count).unwrap(), [&] {
+        Vec<BitsRange> ranges;
+        for (usize i = 0; i < ALLOCS; i++)
+            ranges.pushBack(bits.alloc(count, 0, false).unwrap());
+
+        // Give it all back so every sample starts from the same state
+        for (auto r : ranges)
+            bits.set(r, false);
+        sink(ranges.len());
+    });
+}
+
+static void benchBits() {
+    Vec<u8> wordsBuf;
+    wordsBuf.resize(PAGES / 8);
+    Bits words{mutSub(wordsBuf)};
+
+    Vec<u8> summarizedBuf;
+    summarizedBuf.resize(PAGES / 8);
+    Vec<u64> summary;
+    summary.resize(Bits::summaryLen(summarizedBuf.len()));
+    Bits summarized{mutSub(summarizedBuf), mutSub(summary)};
+
+    for (usize count : {1, 64}) {
+        benchBitsAlloc("words", words, count);
+        benchBitsAlloc("summary", summarized, count);
+    }
+
+    _fragment(summarized, 0x2545f4914f6cdd1d);
+    bench("bits-used", [&] {
+        sink(summarized.used());
+    });
+}
+
+Async::Task<> entryPointAsync(Sys::Context &) {
+    for (usize entries : {10, 1000, 1000000})
+        benchMapLookup(entries);
+
+    for (usize entries : {10, 1000, 100000})
+        benchMapStringLookup(entries);
+
+    for (usize entries : {10, 1000, 100000})
+        benchMapInsert(entries);
+
+    benchSorts();
+
+    benchHashes();
+
+    benchArena();
+
+    benchBits();
+
+    co_return Ok();
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "clamp.h"
 #include "opt.h"
 #include "range.h"
 #include "slice.h"
@@ -8,14 +9,261 @@ namespace Karm {
 
 using BitsRange = Range<usize, struct BitsRangeTag>;
 
+// A bitmap over borrowed memory, set bits are used and clear bits are free.
+//
+// Scanning is done a 64-bit word at a time. When given some storage for
+// it, a two-level summary keeps track of which words are full so that
+// long runs of used bits are skipped 4096 words at a time.
 struct Bits {
+    static constexpr usize WORD = 64;
+    static constexpr u64 FULL = ~0ull;
+
     u8 *_buf{};
     usize _len{};
 
+    // One bit per word of the bitmap, then one bit
+    // per word of the first level, set when full.
+    u64 *_l1{};
+    u64 *_l2{};
+
     Bits(MutSlice<u8> slice)
         : _buf(slice.buf()),
           _len(slice.len()) {}
 
+    Bits(MutSlice<u8> slice, MutSlice<u64> summary)
+        : _buf(slice.buf()),
+          _len(slice.len()) {
+        if (summary.len() < summaryLen(_len)) [[unlikely]]
+            panic("summary too small");
+
+        _l1 = summary.buf();
+        _l2 = _l1 + _div(_words(), WORD);
+        _rebuild();
+    }
+
+    // The number of words of summary needed for a bitmap of `bytes` bytes.
+    static constexpr usize summaryLen(usize bytes) {
+        usize l1 = _div(_div(bytes, 8), WORD);
+        return l1 + _div(l1, WORD);
+    }
+
+    static constexpr usize _div(usize n, usize d) {
+        return (n + d - 1) / d;
+    }
+
+    // MARK: Words -------------------------------------------------------------
+
+    usize _words() const {
+        return _div(_len, 8);
+    }
+
+    // Bits past the end read as used, so they are never handed out.
+    u64 _word(usize w) const {
+        usize off = w * 8;
+        if (off + 8 <= _len) [[likely]] {
+            u64 word;
+            __builtin_memcpy(&word, _buf + off, 8);
+            return toLe(word);
+        }
+
+        u64 word = FULL;
+        for (usize i = 0; off + i < _len; i++) {
+            word &= ~(0xffull << (i * 8));
+            word |= (u64)_buf[off + i] << (i * 8);
+        }
+        return word;
+    }
+
+    void _store(usize w, u64 word) {
+        usize off = w * 8;
+        if (off + 8 <= _len) [[likely]] {
+            word = toLe(word);
+            __builtin_memcpy(_buf + off, &word, 8);
+            return;
+        }
+
+        for (usize i = 0; off + i < _len; i++)
+            _buf[off + i] = word >> (i * 8);
+    }
+
+    static u64 _mask(usize from, usize to) {
+        u64 hi = to == WORD ? FULL : (1ull << to) - 1;
+        return hi & (FULL << from);
+    }
+
+    static void _setBits(u64 *words, usize start, usize end, bool value) {
+        for (usize w = start / WORD; w * WORD < end; w++) {
+            usize from = w * WORD < start ? start % WORD : 0;
+            usize to = min(end - w * WORD, WORD);
+            if (value)
+                words[w] |= _mask(from, to);
+            else
+                words[w] &= ~_mask(from, to);
+        }
+    }
+
+    // MARK: Summary -----------------------------------------------------------
+
+    bool _summarized() const {
+        return _l1 != nullptr;
+    }
+
+    void _rebuild() {
+        usize words = _words();
+        usize l1 = _div(words, WORD);
+
+        // Padding bits are set, missing words are always full.
+        for (usize i = 0; i < l1; i++)
+            _l1[i] = FULL;
+        for (usize i = 0; i < _div(l1, WORD); i++)
+            _l2[i] = FULL;
+
+        for (usize w = 0; w < words; w++)
+            if (_word(w) != FULL)
+                _l1[w / WORD] &= ~(1ull << (w % WORD));
+
+        for (usize i = 0; i < l1; i++)
+            if (_l1[i] != FULL)
+                _l2[i / WORD] &= ~(1ull << (i % WORD));
+    }
+
+    // Refresh the summary after the words in [start, end) changed.
+    void _sync(usize start, usize end) {
+        if (not _summarized() or start >= end)
+            return;
+
+        for (usize w = start; w < end; w++) {
+            if (_word(w) == FULL)
+                _l1[w / WORD] |= 1ull << (w % WORD);
+            else
+                _l1[w / WORD] &= ~(1ull << (w % WORD));
+        }
+
+        _syncL2(start / WORD, _div(end, WORD));
+    }
+
+    void _syncL2(usize start, usize end) {
+        for (usize i = start; i < end; i++) {
+            if (_l1[i] == FULL)
+                _l2[i / WORD] |= 1ull << (i % WORD);
+            else
+                _l2[i / WORD] &= ~(1ull << (i % WORD));
+        }
+    }
+
+    // The first word at or after `w` that has a free bit,
+    // or the number of words if there is none.
+    usize _nextNonFull(usize w) const {
+        usize words = _words();
+        if (not _summarized()) {
+            while (w < words and _word(w) == FULL)
+                w++;
+            return w;
+        }
+
+        if (w >= words)
+            return words;
+
+        usize i = w / WORD;
+        if (u64 free = ~_l1[i] & (FULL << (w % WORD)))
+            return i * WORD + __builtin_ctzll(free);
+
+        usize l1 = _div(words, WORD);
+        for (i++; i < l1; i = (i / WORD + 1) * WORD) {
+            if (u64 free = ~_l2[i / WORD] & (FULL << (i % WORD))) {
+                i = (i / WORD) * WORD + __builtin_ctzll(free);
+                return i * WORD + __builtin_ctzll(~_l1[i]);
+            }
+        }
+
+        return words;
+    }
+
+    // The last word before `w` that has a free bit, plus one,
+    // or zero if there is none.
+    usize _prevNonFull(usize w) const {
+        if (not _summarized()) {
+            while (w > 0 and _word(w - 1) == FULL)
+                w--;
+            return w;
+        }
+
+        if (w == 0)
+            return 0;
+
+        usize i = (w - 1) / WORD;
+        if (u64 free = ~_l1[i] & _mask(0, (w - 1) % WORD + 1))
+            return i * WORD + (WORD - __builtin_clzll(free));
+
+        while (i > 0) {
+            usize j = i - 1;
+            if (u64 free = ~_l2[j / WORD] & _mask(0, j % WORD + 1)) {
+                j = (j / WORD) * WORD + (WORD - 1 - __builtin_clzll(free));
+                return j * WORD + (WORD - __builtin_clzll(~_l1[j]));
+            }
+            i = (j / WORD) * WORD;
+        }
+
+        return 0;
+    }
+
+    // MARK: Scanning ----------------------------------------------------------
+
+    // The first free bit at or after `i`, or len() if there is none.
+    usize nextFree(usize i) const {
+        if (i >= len())
+            return len();
+
+        usize w = i / WORD;
+        if (u64 free = ~_word(w) & (FULL << (i % WORD)))
+            return w * WORD + __builtin_ctzll(free);
+
+        w = _nextNonFull(w + 1);
+        if (w >= _words())
+            return len();
+        return w * WORD + __builtin_ctzll(~_word(w));
+    }
+
+    // The first used bit in [i, limit), or `limit` if there is none.
+    usize nextUsed(usize i, usize limit) const {
+        while (i < limit) {
+            usize w = i / WORD;
+            if (u64 used = _word(w) & (FULL << (i % WORD)))
+                return min(w * WORD + __builtin_ctzll(used), limit);
+            i = (w + 1) * WORD;
+        }
+        return limit;
+    }
+
+    // One past the last free bit before `i`, or 0 if there is none.
+    usize prevFree(usize i) const {
+        i = min(i, len());
+        if (i == 0)
+            return 0;
+
+        usize w = (i - 1) / WORD;
+        if (u64 free = ~_word(w) & _mask(0, (i - 1) % WORD + 1))
+            return w * WORD + (WORD - __builtin_clzll(free));
+
+        w = _prevNonFull(w);
+        if (w == 0)
+            return 0;
+        return (w - 1) * WORD + (WORD - __builtin_clzll(~_word(w - 1)));
+    }
+
+    // One past the last used bit in [limit, i), or `limit` if there is none.
+    usize prevUsed(usize i, usize limit) const {
+        while (i > limit) {
+            usize w = (i - 1) / WORD;
+            if (u64 used = _word(w) & _mask(0, (i - 1) % WORD + 1))
+                return max(w * WORD + (WORD - __builtin_clzll(used)), limit);
+            i = w * WORD;
+        }
+        return limit;
+    }
+
+    // MARK: Access ------------------------------------------------------------
+
     bool get(usize index) const {
         return _buf[index / 8] & (1 << (index % 8));
     }
@@ -26,48 +274,90 @@ struct Bits {
         } else {
             _buf[index / 8] &= ~(1 << (index % 8));
         }
+        _sync(index / WORD, index / WORD + 1);
     }
 
     void set(BitsRange range, bool value) {
-        for (usize i = range.start; i < range.end(); i++) {
-            set(i, value);
+        if (range.size == 0)
+            return;
+
+        usize first = range.start / WORD;
+        usize last = (range.end() - 1) / WORD;
+
+        for (usize w : {first, last}) {
+            u64 mask = _mask(
+                w == first ? range.start % WORD : 0,
+                w == last ? (range.end() - 1) % WORD + 1 : WORD
+            );
+            _store(w, value ? _word(w) | mask : _word(w) & ~mask);
+            if (first == last)
+                break;
+        }
+        _sync(first, first + 1);
+        _sync(last, last + 1);
+
+        // Whole words in between
+        if (last > first + 1) {
+            ::fill(
+                MutBytes(_buf + (first + 1) * 8, (last - first - 1) * 8),
+                value ? 0xff_byte : 0x00_byte
+            );
+
+            if (_summarized()) {
+                _setBits(_l1, first + 1, last, value);
+                _syncL2((first + 1) / WORD, _div(last, WORD));
+            }
         }
     }
 
     void fill(bool value) {
         ::fill(mutBytes(), value ? 0xff_byte : 0x00_byte);
+        if (_summarized())
+            _rebuild();
     }
 
     usize len() const {
         return _len * 8;
     }
 
+    // Find `count` free bits in a row and mark them as used, searching
+    // upward from `start`, or downward from it when `upper` is set.
     Opt<BitsRange> alloc(usize count, usize start, bool upper = true) {
         start = min(start, len());
 
-        if (_len == 0) {
+        if (_len == 0 or count == 0) {
             return NONE;
         }
 
-        BitsRange range = {};
-
-        for (usize i = start;
-             upper ? i > 0 : i < len();
-             i += upper ? -1 : 1) {
+        if (upper) {
+            usize end = start;
+            while (end >= count) {
+                end = prevFree(end);
+                if (end < count)
+                    break;
 
-            if (get(i)) {
-                range = {};
-            } else {
-                if (range.size == 0 or upper) {
-                    range.start = i;
+                usize used = prevUsed(end, end - count);
+                if (used == end - count) {
+                    BitsRange range = {end - count, count};
+                    set(range, true);
+                    return range;
                 }
-
-                range.size++;
+                end = used - 1;
             }
+        } else {
+            usize i = start;
+            while (i + count <= len()) {
+                i = nextFree(i);
+                if (i + count > len())
+                    break;
 
-            if (range.size == count) {
-                set(range, true);
-                return range;
+                usize used = nextUsed(i, i + count);
+                if (used == i + count) {
+                    BitsRange range = {i, count};
+                    set(range, true);
+                    return range;
+                }
+                i = used + 1;
             }
         }
 
@@ -75,33 +365,22 @@ struct Bits {
     }
 
     usize used() const {
+        usize words = _words();
         usize res = 0;
+        for (usize w = 0; w < words; w++)
+            res += __builtin_popcountll(_word(w));
 
-        for (usize i = 0; i < len(); i++) {
-            if (get(i)) {
-                res++;
-            }
-        }
-
-        return res;
+        // Don't count the padding of the last word
+        return res - (words * WORD - len());
     }
 
+    // Call `cb` with each run of free bits.
     void visit(auto cb) {
-        BitsRange range = {};
-        for (usize i = 0; i < len(); i++) {
-            if (get(i)) {
-                if (range.size > 0) {
-                    cb(range);
-                }
-
-                range = {};
-            } else {
-                if (range.size == 0) {
-                    range.start = i;
-                }
-
-                range.size++;
-            }
+        usize i = 0;
+        while ((i = nextFree(i)) < len()) {
+            usize end = nextUsed(i, len());
+            cb(BitsRange{i, end - i});
+            i = end;
         }
     }
 
@@ -481,6 +481,267 @@ struct InlineBuf {
     }
 };
 
+/// A buffer that stores up to N elements inline and only moves
+/// them to the heap once it grows past that.
+template <typename T, usize N>
+struct SmallBuf {
+    using Inner = T;
+
+    Array<Manual<T>, N> _inline = {};
+    Manual<T> *_heap = nullptr;
+    usize _cap = N;
+    usize _len = 0;
+
+    constexpr SmallBuf() = default;
+
+    SmallBuf(usize cap) {
+        ensure(cap);
+    }
+
+    SmallBuf(T const *buf, usize len) {
+        ensure(len);
+
+        _len = len;
+        for (usize i = 0; i < _len; i++)
+            _data()[i].ctor(buf[i]);
+    }
+
+    SmallBuf(std::initializer_list<T> other) {
+        ensure(other.size());
+
+        _len = other.size();
+        for (usize i = 0; i < _len; i++)
+            _data()[i].ctor(std::move(other.begin()[i]));
+    }
+
+    SmallBuf(Sliceable<T> auto const &other)
+        : SmallBuf(other.buf(), other.len()) {
+    }
+
+    SmallBuf(SmallBuf const &other)
+        : SmallBuf(other.buf(), other.len()) {
+    }
+
+    SmallBuf(SmallBuf &&other) {
+        _steal(other);
+    }
+
+    ~SmallBuf() {
+        trunc(0);
+        delete[] _heap;
+    }
+
+    SmallBuf &operator=(SmallBuf const &other) {
+        *this = SmallBuf(other);
+        return *this;
+    }
+
+    SmallBuf &operator=(SmallBuf &&other) {
+        if (this == &other)
+            return *this;
+
+        trunc(0);
+        delete[] std::exchange(_heap, nullptr);
+        _cap = N;
+        _steal(other);
+        return *this;
+    }
+
+    // Takes the elements of `other`, which must be empty afterward,
+    // while this buffer must be empty and inline.
+    void _steal(SmallBuf &other) {
+        if (other._heap) {
+            _heap = std::exchange(other._heap, nullptr);
+            _cap = std::exchange(other._cap, N);
+        } else {
+            for (usize i = 0; i < other._len; i++)
+                _inline[i].ctor(other._inline[i].take());
+        }
+        _len = std::exchange(other._len, 0);
+    }
+
+    Manual<T> *_data() {
+        return _heap ? _heap : _inline.buf();
+    }
+
+    Manual<T> const *_data() const {
+        return _heap ? _heap : _inline.buf();
+    }
+
+    void _moveTo(Manual<T> *dest) {
+        auto *src = _data();
+        for (usize i = 0; i < _len; i++)
+            dest[i].ctor(src[i].take());
+    }
+
+    constexpr T &operator[](usize i) lifetimebound {
+        return _data()[i].unwrap();
+    }
+
+    constexpr T const &operator[](usize i) const lifetimebound {
+        return _data()[i].unwrap();
+    }
+
+    void ensure(usize desired) {
+        if (desired <= _cap)
+            return;
+
+        usize newCap = max(_cap * 2, desired);
+        Manual<T> *tmp = new Manual<T>[newCap];
+        _moveTo(tmp);
+
+        delete[] _heap;
+        _heap = tmp;
+        _cap = newCap;
+    }
+
+    void fit() {
+        if (not _heap or _len == _cap)
+            return;
+
+        if (_len <= N) {
+            _moveTo(_inline.buf());
+            delete[] std::exchange(_heap, nullptr);
+            _cap = N;
+            return;
+        }
+
+        Manual<T> *tmp = new Manual<T>[_len];
+        _moveTo(tmp);
+        delete[] _heap;
+        _heap = tmp;
+        _cap = _len;
+    }
+
+    template <typename... Args>
+    auto &emplace(usize index, Args &&...args) {
+        ensure(_len + 1);
+
+        auto *data = _data();
+        for (usize i = _len; i > index; i--)
+            data[i].ctor(data[i - 1].take());
+
+        data[index].ctor(std::forward<Args>(args)...);
+        _len++;
+        return data[index].unwrap();
+    }
+
+    void insert(usize index, T &&value) {
+        emplace(index, std::move(value));
+    }
+
+    void replace(usize index, T &&value) {
+        if (index >= _len) {
+            insert(index, std::move(value));
+            return;
+        }
+
+        _data()[index].dtor();
+        _data()[index].ctor(std::move(value));
+    }
+
+    void insert(Copy, usize index, T const *first, usize count) {
+        ensure(_len + count);
+
+        auto *data = _data();
+        for (usize i = _len; i > index; i--)
+            data[i - 1 + count].ctor(data[i - 1].take());
+
+        for (usize i = 0; i < count; i++)
+            data[index + i].ctor(first[i]);
+
+        _len += count;
+    }
+
+    void insert(Move, usize index, T *first, usize count) {
+        ensure(_len + count);
+
+        auto *data = _data();
+        for (usize i = _len; i > index; i--)
+            data[i - 1 + count].ctor(data[i - 1].take());
+
+        for (usize i = 0; i < count; i++)
+            data[index + i].ctor(std::move(first[i]));
+
+        _len += count;
+    }
+
+    T removeAt(usize index) {
+        if (index >= _len) [[unlikely]]
+            panic("index out of bounds");
+
+        auto *data = _data();
+        T ret = data[index].take();
+        for (usize i = index; i < _len - 1; i++)
+            data[i].ctor(data[i + 1].take());
+        _len--;
+        return ret;
+    }
+
+    void removeRange(usize index, usize count) {
+        if (index > _len) [[unlikely]]
+            panic("index out of bounds");
+
+        if (index + count > _len) [[unlikely]]
+            panic("index + count out of bounds");
+
+        auto *data = _data();
+        for (usize i = index; i < index + count; i++)
+            data[i].dtor();
+
+        for (usize i = index; i < _len - count; i++)
+            data[i].ctor(data[i + count].take());
+
+        _len -= count;
+    }
+
+    void resize(usize newLen, T fill = {}) {
+        if (newLen > _len) {
+            ensure(newLen);
+            for (usize i = _len; i < newLen; i++)
+                _data()[i].ctor(fill);
+        } else {
+            trunc(newLen);
+        }
+        _len = newLen;
+    }
+
+    void trunc(usize newLen) {
+        if (newLen >= _len)
+            return;
+
+        auto *data = _data();
+        for (usize i = newLen; i < _len; i++)
+            data[i].dtor();
+
+        _len = newLen;
+    }
+
+    T *buf() lifetimebound {
+        return &_data()->unwrap();
+    }
+
+    T const *buf() const lifetimebound {
+        return &_data()->unwrap();
+    }
+
+    usize len() const {
+        return _len;
+    }
+
+    usize cap() const {
+        return _cap;
+    }
+
+    usize size() const {
+        return _len * sizeof(T);
+    }
+
+    bool spilled() const {
+        return _heap != nullptr;
+    }
+};
+
 /// A buffer that does not own its backing storage.
 template <typename T>
 struct ViewBuf {
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "checked.h"
+#include "cons.h"
+#include "simd.h"
 #include "slice.h"
 
 namespace Karm {
@@ -16,10 +18,55 @@ concept Hashable = requires(T t) {
 };
 
 template <Hashable T>
-Hash hash(T const &v) {
+constexpr Hash hash(T const &v) {
     return Hasher<T>::hash(v);
 }
 
+// MARK: Primitives ------------------------------------------------------------
+
+// The building blocks of wyhash, see https://github.com/wangyi-fudan/wyhash
+static constexpr u64 _HASH_P0 = 0x2d358dccaa6c78a5;
+static constexpr u64 _HASH_P1 = 0x8bb84b93962eacc9;
+static constexpr u64 _HASH_P2 = 0x4b33a62ed433d4a3;
+static constexpr u64 _HASH_P3 = 0x4d5a2da51de1aa47;
+
+// Multiply and fold the 128 bits result.
+always_inline constexpr u64 _hashMix(u64 a, u64 b) {
+    u128 r = static_cast<u128>(a) * b;
+    return static_cast<u64>(r) ^ static_cast<u64>(r >> 64);
+}
+
+// NOTE: Compilers turn these into single loads.
+template <typename B>
+always_inline constexpr u64 _hashRead8(B const *p) {
+    u64 v = 0;
+    for (usize i = 0; i < 8; i++)
+        v |= static_cast<u64>(static_cast<u8>(p[i])) << (i * 8);
+    return v;
+}
+
+template <typename B>
+always_inline constexpr u64 _hashRead4(B const *p) {
+    u64 v = 0;
+    for (usize i = 0; i < 4; i++)
+        v |= static_cast<u64>(static_cast<u8>(p[i])) << (i * 8);
+    return v;
+}
+
+// Mix the hash of a value into the hash of the values before it,
+// the order of the values matters.
+constexpr Hash hashCombine(Hash seed, Hash hash) {
+    return _hashMix(seed ^ _HASH_P0, hash ^ _HASH_P1);
+}
+
+template <Hashable T, Hashable... Ts>
+constexpr Hash hash(T const &first, Ts const &...rest) {
+    Hash res = hash(first);
+    ((res = hashCombine(res, hash(rest))), ...);
+    return res;
+}
+
+// A hash is its own hash.
 template <>
 struct Hasher<Hash> {
     static constexpr Hash hash(Hash h) {
@@ -27,38 +74,226 @@ struct Hasher<Hash> {
     }
 };
 
+// MARK: Bytes -----------------------------------------------------------------
+
+// Keys longer than this are hashed in 64 bytes stripes accumulated into
+// 8 independent lanes, in the style of XXH3.
+static constexpr usize _HASH_LONG = 256;
+static constexpr usize _HASH_STRIPE = 64;
+static constexpr usize _HASH_SCRAMBLE = 16; // Stripes between two scrambles
+
+// Plain version of _hashLongSimd(), for when it's evaluated at compile time.
+template <typename B>
+constexpr u64 _hashLong(B const *p, usize len, u64 seed) {
+    u64 key[8] = {
+        _HASH_P0 ^ seed, _HASH_P1 ^ seed, _HASH_P2 ^ seed, _HASH_P3 ^ seed,
+        _HASH_P3 ^ (seed * _HASH_P0), _HASH_P2 ^ (seed * _HASH_P0),
+        _HASH_P1 ^ (seed * _HASH_P0), _HASH_P0 ^ (seed * _HASH_P0)
+    };
+
+    u64 acc[8];
+    for (usize i = 0; i < 8; i++)
+        acc[i] = key[(i + 4) % 8];
+
+    auto stripe = [&](B const *s) {
+        u64 d[8];
+        for (usize i = 0; i < 8; i++)
+            d[i] = _hashRead8(s + i * 8);
+
+        for (usize i = 0; i < 8; i++) {
+            u64 k = d[i] ^ key[i];
+            acc[i] += (k & 0xffffffff) * (k >> 32) + d[i ^ 1];
+        }
+    };
+
+    usize stripes = (len - 1) / _HASH_STRIPE;
+    for (usize i = 0; i < stripes; i++) {
+        stripe(p + i * _HASH_STRIPE);
+        if (i % _HASH_SCRAMBLE == _HASH_SCRAMBLE - 1)
+            for (usize j = 0; j < 8; j++)
+                acc[j] = (acc[j] ^ (acc[j] >> 47) ^ key[(j + 4) % 8]) * 0x9e3779b1;
+    }
+    stripe(p + len - _HASH_STRIPE);
+
+    u64 res = len * _HASH_P0;
+    for (usize i = 0; i < 8; i += 2)
+        res += _hashMix(acc[i] ^ key[i], acc[i + 1] ^ key[i + 1]);
+    return _hashMix(res ^ _HASH_P2, seed ^ _HASH_P3);
+}
+
+inline u64 _hashLongSimd(Byte const *p, usize len, u64 seed) {
+    u64x4 key0 = u64x4{_HASH_P0, _HASH_P1, _HASH_P2, _HASH_P3} ^ seed;
+    u64x4 key1 = u64x4{_HASH_P3, _HASH_P2, _HASH_P1, _HASH_P0} ^ (seed * _HASH_P0);
+    u64x4 acc0 = key1;
+    u64x4 acc1 = key0;
+
+    auto stripe = [&](Byte const *s) {
+        u64x4 d0, d1;
+        __builtin_memcpy(&d0, s, sizeof(d0));
+        __builtin_memcpy(&d1, s + sizeof(d0), sizeof(d1));
+
+        // The 32x32 bits multiplications map onto vector instructions,
+        // the data itself is kept so multiplying by zero doesn't lose it.
+        u64x4 k0 = d0 ^ key0;
+        u64x4 k1 = d1 ^ key1;
+        acc0 += (k0 & 0xffffffff) * (k0 >> 32) + __builtin_shufflevector(d0, d0, 1, 0, 3, 2);
+        acc1 += (k1 & 0xffffffff) * (k1 >> 32) + __builtin_shufflevector(d1, d1, 1, 0, 3, 2);
+    };
+
+    usize stripes = (len - 1) / _HASH_STRIPE;
+    for (usize i = 0; i < stripes; i++) {
+        stripe(p + i * _HASH_STRIPE);
+        if (i % _HASH_SCRAMBLE == _HASH_SCRAMBLE - 1) {
+            acc0 = (acc0 ^ (acc0 >> 47) ^ key1) * static_cast<u64>(0x9e3779b1);
+            acc1 = (acc1 ^ (acc1 >> 47) ^ key0) * static_cast<u64>(0x9e3779b1);
+        }
+    }
+
+    // The last stripe overlaps the previous one when the length isn't
+    // a multiple of the stripe size.
+    stripe(p + len - _HASH_STRIPE);
+
+    u64 res = len * _HASH_P0;
+    for (usize i = 0; i < 4; i += 2) {
+        res += _hashMix(acc0[i] ^ key0[i], acc0[i + 1] ^ key0[i + 1]);
+        res += _hashMix(acc1[i] ^ key1[i], acc1[i + 1] ^ key1[i + 1]);
+    }
+    return _hashMix(res ^ _HASH_P2, seed ^ _HASH_P3);
+}
+
+static constexpr u64 _HASH_SEED = 0xa0761d6478bd642f;
+
+// wyhash, reading the key 8 or 16 bytes at a time, with three independent
+// chains for keys longer than 48 bytes.
+template <typename B>
+constexpr u64 _hashBytes(B const *p, usize len, u64 seed = _HASH_SEED) {
+    if (len > _HASH_LONG) {
+        if consteval {
+            return _hashLong(p, len, seed);
+        } else {
+            return _hashLongSimd(reinterpret_cast<Byte const *>(p), len, seed);
+        }
+    }
+
+    seed ^= _hashMix(seed ^ _HASH_P0, _HASH_P1);
+
+    u64 a = 0, b = 0;
+    if (len <= 16) {
+        if (len >= 4) {
+            usize shift = (len >> 3) << 2;
+            a = (_hashRead4(p) << 32) | _hashRead4(p + shift);
+            b = (_hashRead4(p + len - 4) << 32) | _hashRead4(p + len - 4 - shift);
+        } else if (len > 0) {
+            a = (static_cast<u64>(static_cast<u8>(p[0])) << 16) |
+                (static_cast<u64>(static_cast<u8>(p[len >> 1])) << 8) |
+                static_cast<u8>(p[len - 1]);
+        }
+    } else {
+        usize i = len;
+        if (i > 48) {
+            u64 see1 = seed, see2 = seed;
+            do {
+                seed = _hashMix(_hashRead8(p) ^ _HASH_P1, _hashRead8(p + 8) ^ seed);
+                see1 = _hashMix(_hashRead8(p + 16) ^ _HASH_P2, _hashRead8(p + 24) ^ see1);
+                see2 = _hashMix(_hashRead8(p + 32) ^ _HASH_P3, _hashRead8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+
+        while (i > 16) {
+            seed = _hashMix(_hashRead8(p) ^ _HASH_P1, _hashRead8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+
+        a = _hashRead8(p + i - 16);
+        b = _hashRead8(p + i - 8);
+    }
+
+    u128 r = static_cast<u128>(a ^ _HASH_P1) * (b ^ seed);
+    return _hashMix(static_cast<u64>(r) ^ _HASH_P0 ^ len, static_cast<u64>(r >> 64) ^ _HASH_P1);
+}
+
 template <>
 struct Hasher<Bytes> {
-    static constexpr Hash hash(Bytes bytes) {
-        Hash hash = 0;
-        for (auto &b : bytes)
-            hash = (1000003 * hash) ^ b;
-        hash ^= bytes.len();
-        return hash;
+    static constexpr Hash hash(Bytes bytes, u64 seed = _HASH_SEED) {
+        return _hashBytes(bytes.buf(), bytes.len(), seed);
     }
 };
 
+// MARK: Values ----------------------------------------------------------------
+
+// Slices of bytes, like strings, are hashed as a whole, other slices
+// combine the hashes of their elements in order.
 template <Sliceable T>
 struct Hasher<T> {
     static constexpr Hash hash(T const &v) {
-        Hash hash{0};
-        for (auto &e : v)
-            hash = hash + ::hash(e);
-        return hash;
+        using U = typename T::Inner;
+        if constexpr (Meta::Integral<U> and sizeof(U) == 1) {
+            return _hashBytes(v.buf(), v.len());
+        } else {
+            Hash hash = Hasher<Hash>::hash(v.len());
+            for (auto &e : v)
+                hash = hashCombine(hash, Karm::hash(e));
+            return hash;
+        }
     }
 };
 
 template <Meta::Integral T>
 struct Hasher<T> {
     static constexpr Hash hash(T const &v) {
-        return Hasher<Bytes>::hash({reinterpret_cast<Byte const *>(&v), sizeof(v)});
+        return _hashMix(static_cast<u64>(v) ^ _HASH_P0, sizeof(T) ^ _HASH_P1);
     }
 };
 
 template <Meta::Float T>
 struct Hasher<T> {
     static constexpr Hash hash(T const &v) {
-        return Hasher<Bytes>::hash({reinterpret_cast<Byte const *>(&v), sizeof(v)});
+        // Both zeros are equal, so they must hash the same
+        if (v == 0)
+            return Hasher<u64>::hash(0);
+
+        if constexpr (sizeof(T) == sizeof(u64))
+            return Hasher<u64>::hash(__builtin_bit_cast(u64, v));
+        else if constexpr (sizeof(T) == sizeof(u32))
+            return Hasher<u32>::hash(__builtin_bit_cast(u32, v));
+        else
+            return Hasher<Bytes>::hash({reinterpret_cast<Byte const *>(&v), sizeof(v)});
+    }
+};
+
+template <Meta::Enum T>
+struct Hasher<T> {
+    static constexpr Hash hash(T const &v) {
+        return Hasher<Meta::UnderlyingType<T>>::hash(static_cast<Meta::UnderlyingType<T>>(v));
+    }
+};
+
+template <typename T>
+struct Hasher<T *> {
+    static Hash hash(T const *v) {
+        return Hasher<usize>::hash(reinterpret_cast<usize>(v));
+    }
+};
+
+template <typename Car, typename Cdr>
+struct Hasher<Cons<Car, Cdr>> {
+    static constexpr Hash hash(Cons<Car, Cdr> const &v) {
+        return Karm::hash(v.car, v.cdr);
+    }
+};
+
+// Types can provide their own hash by having a `hash()` method.
+template <typename T>
+    requires requires(T const &v) {
+        { v.hash() } -> Meta::Same<Hash>;
+    }
+struct Hasher<T> {
+    static constexpr Hash hash(T const &v) {
+        return v.hash();
     }
 };
 
@@ -8,6 +8,7 @@ namespace Karm {
 template <typename K, typename V>
 struct Lru {
     struct Item {
+        K key;
         V value;
         LlItem<Item> item{};
     };
@@ -43,7 +44,7 @@ struct Lru {
         while (_ll.len() > _cap) {
             auto *item = _ll.tail();
             _ll.detach(item);
-            _map.removeFirst(item);
+            _map.del(item->key);
             delete item;
         }
     }
@@ -54,7 +55,7 @@ struct Lru {
             return item->value;
         }
 
-        item = new Item{make()};
+        item = new Item{key, make()};
         _ll.prepend(item, _ll.head());
         _map.put(key, item);
         _evict();
@@ -1,126 +1,512 @@
 #pragma once
 
+#include "cons.h"
 #include "cursor.h"
+#include "hash.h"
+#include "manual.h"
 #include "vec.h"
 
 namespace Karm {
 
-template <typename K, typename V>
-struct Map {
-    Vec<Cons<K, V>> _els{};
+// MARK: Hash Table ------------------------------------------------------------
 
-    Map() = default;
+// Open addressing hash table in the style of Swiss tables.
+//
+// Slots are grouped by 8, each one with a control byte holding 7 bits of the
+// hash of its entry, so a whole group is searched at once without touching
+// the entries, and groups are probed in triangular order. The table is kept
+// at most 7/8 full so every probe sequence ends on an empty slot.
+template <typename T>
+struct _HashTable {
+    static constexpr usize GROUP = 8;
+    static constexpr u8 EMPTY = 0x80;
+    static constexpr u8 DELETED = 0xfe;
 
-    Map(std::initializer_list<Cons<K, V>> &&list)
-        : _els(std::move(list)) {}
+    static constexpr u64 LSB = 0x0101010101010101;
+    static constexpr u64 MSB = 0x8080808080808080;
 
-    void put(K const &key, V value) {
-        for (auto &i : ::mutIter(_els)) {
-            if (i.car == key) {
-                i.cdr = std::move(value);
+    u8 *_ctrl = nullptr;
+    Manual<T> *_slots = nullptr;
+    usize _cap = 0;
+    usize _len = 0;
+    usize _dead = 0;
+
+    _HashTable() = default;
+
+    _HashTable(_HashTable const &other) {
+        *this = other;
+    }
+
+    _HashTable(_HashTable &&other)
+        : _ctrl(std::exchange(other._ctrl, nullptr)),
+          _slots(std::exchange(other._slots, nullptr)),
+          _cap(std::exchange(other._cap, 0)),
+          _len(std::exchange(other._len, 0)),
+          _dead(std::exchange(other._dead, 0)) {}
+
+    ~_HashTable() {
+        clear();
+    }
+
+    _HashTable &operator=(_HashTable const &other) {
+        if (this == &other)
+            return *this;
+
+        clear();
+        if (not other._cap)
+            return *this;
+
+        _alloc(other._cap);
+        for (usize i = 0; i < _cap; i++) {
+            _ctrl[i] = other._ctrl[i];
+            if (_used(i))
+                _slots[i].ctor(other._slots[i].unwrap());
+        }
+        _len = other._len;
+        _dead = other._dead;
+        return *this;
+    }
+
+    _HashTable &operator=(_HashTable &&other) {
+        std::swap(_ctrl, other._ctrl);
+        std::swap(_slots, other._slots);
+        std::swap(_cap, other._cap);
+        std::swap(_len, other._len);
+        std::swap(_dead, other._dead);
+        return *this;
+    }
+
+    // Spread the bits of a hash so both its lowest and highest bits can be
+    // used, whatever the quality of the hasher.
+    static u64 mix(Hash hash) {
+        u64 h = static_cast<u64>(hash) * 0x9e3779b97f4a7c15;
+        return h ^ (h >> 32);
+    }
+
+    static u8 _h2(u64 h) {
+        return h >> 57;
+    }
+
+    // NOTE: Compilers turn this into a single load.
+    static u64 _load(u8 const *ctrl) {
+        u64 group = 0;
+        for (usize i = 0; i < GROUP; i++)
+            group |= static_cast<u64>(ctrl[i]) << (i * 8);
+        return group;
+    }
+
+    // NOTE: This can report false positives, entries are compared anyway.
+    static u64 _match(u64 group, u8 h2) {
+        u64 x = group ^ (LSB * h2);
+        return (x - LSB) & ~x & MSB;
+    }
+
+    static u64 _matchEmpty(u64 group) {
+        return group & ~(group << 6) & MSB;
+    }
+
+    static u64 _matchFree(u64 group) {
+        return group & MSB;
+    }
+
+    static usize _first(u64 mask) {
+        return __builtin_ctzll(mask) / 8;
+    }
+
+    bool _used(usize slot) const {
+        return not(_ctrl[slot] & 0x80);
+    }
+
+    void _alloc(usize cap) {
+        _ctrl = new u8[cap];
+        _slots = new Manual<T>[cap];
+        _cap = cap;
+        for (usize i = 0; i < cap; i++)
+            _ctrl[i] = EMPTY;
+    }
+
+    // Returns the slot of the entry for which `eq` returns true.
+    Opt<usize> find(u64 h, auto eq) const {
+        if (_len == 0)
+            return NONE;
+
+        usize mask = _cap / GROUP - 1;
+        usize group = h & mask;
+        for (usize i = 1;; i++) {
+            u64 ctrl = _load(_ctrl + group * GROUP);
+            for (u64 m = _match(ctrl, _h2(h)); m; m &= m - 1) {
+                usize slot = group * GROUP + _first(m);
+                if (eq(_slots[slot].unwrap()))
+                    return slot;
+            }
+
+            if (_matchEmpty(ctrl))
+                return NONE;
+
+            group = (group + i) & mask;
+        }
+    }
+
+    void _place(u64 h, T &&value) {
+        usize mask = _cap / GROUP - 1;
+        usize group = h & mask;
+        for (usize i = 1;; i++) {
+            u64 free = _matchFree(_load(_ctrl + group * GROUP));
+            if (free) {
+                usize slot = group * GROUP + _first(free);
+                if (_ctrl[slot] == DELETED)
+                    _dead--;
+                _ctrl[slot] = _h2(h);
+                _slots[slot].ctor(std::move(value));
+                _len++;
                 return;
             }
+
+            group = (group + i) & mask;
+        }
+    }
+
+    // Rebuild the table with the given capacity, dropping the tombstones.
+    void rehash(usize cap, auto hashOf) {
+        auto *ctrl = _ctrl;
+        auto *slots = _slots;
+        usize oldCap = _cap;
+
+        _alloc(cap);
+        _len = 0;
+        _dead = 0;
+
+        for (usize i = 0; i < oldCap; i++) {
+            if (ctrl[i] & 0x80)
+                continue;
+            _place(hashOf(slots[i].unwrap()), slots[i].take());
         }
 
-        _els.pushBack(Cons<K, V>{key, std::move(value)});
+        delete[] ctrl;
+        delete[] slots;
     }
 
-    bool has(K const &key) const {
-        for (auto &i : _els) {
-            if (i.car == key) {
-                return true;
-            }
+    // Insert an entry that isn't in the table yet.
+    void insert(u64 h, T value, auto hashOf) {
+        if ((_len + _dead + 1) * 8 > _cap * 7) {
+            // Only grow if the tombstones aren't to blame
+            usize cap = max(_cap, GROUP * 2);
+            if ((_len + 1) * 16 > _cap * 7)
+                cap = max(_cap * 2, GROUP * 2);
+            rehash(cap, hashOf);
         }
 
-        return false;
+        _place(h, std::move(value));
     }
 
-    V &get(K const &key) {
-        for (auto &i : _els) {
-            if (i.car == key) {
-                return i.cdr;
-            }
+    void erase(usize slot) {
+        _slots[slot].dtor();
+        _ctrl[slot] = DELETED;
+        _len--;
+        _dead++;
+    }
+
+    T &at(usize slot) {
+        return _slots[slot].unwrap();
+    }
+
+    T const &at(usize slot) const {
+        return _slots[slot].unwrap();
+    }
+
+    // Returns the next used slot, starting at `slot`.
+    usize next(usize slot) const {
+        while (slot < _cap and not _used(slot))
+            slot++;
+        return slot;
+    }
+
+    usize len() const {
+        return _len;
+    }
+
+    void clear() {
+        if (not _ctrl)
+            return;
+
+        for (usize i = 0; i < _cap; i++)
+            if (_used(i))
+                _slots[i].dtor();
+
+        delete[] _ctrl;
+        delete[] _slots;
+
+        _ctrl = nullptr;
+        _slots = nullptr;
+        _cap = 0;
+        _len = 0;
+        _dead = 0;
+    }
+};
+
+// MARK: Map -------------------------------------------------------------------
+
+// A hash map, iterated in no particular order.
+template <typename K, typename V>
+struct Map {
+    _HashTable<Cons<K, V>> _table{};
+
+    Map() = default;
+
+    Map(std::initializer_list<Cons<K, V>> &&list) {
+        for (auto &i : list)
+            put(i.car, i.cdr);
+    }
+
+    static u64 _hash(K const &key) {
+        return _HashTable<Cons<K, V>>::mix(hash(key));
+    }
+
+    static u64 _hashOf(Cons<K, V> const &entry) {
+        return _hash(entry.car);
+    }
+
+    Opt<usize> _find(K const &key) const {
+        return _table.find(_hash(key), [&](Cons<K, V> const &e) {
+            return e.car == key;
+        });
+    }
+
+    void put(K const &key, V value) {
+        u64 h = _hash(key);
+        auto slot = _table.find(h, [&](Cons<K, V> const &e) {
+            return e.car == key;
+        });
+
+        if (slot) {
+            _table.at(*slot).cdr = std::move(value);
+            return;
         }
 
-        panic("key not found");
+        _table.insert(h, Cons<K, V>{key, std::move(value)}, _hashOf);
+    }
+
+    bool has(K const &key) const {
+        return _find(key).has();
+    }
+
+    V &get(K const &key) {
+        auto slot = _find(key);
+        if (not slot)
+            panic("key not found");
+        return _table.at(*slot).cdr;
     }
 
     MutCursor<V> access(K const &key) {
-        for (auto &i : _els)
-            if (i.car == key)
-                return &i.cdr;
-        return {};
+        auto slot = _find(key);
+        if (not slot)
+            return {};
+        return &_table.at(*slot).cdr;
     }
 
     Cursor<V> access(K const &key) const {
-        for (auto &i : _els)
-            if (i.car == key)
-                return &i.cdr;
-        return {};
+        auto slot = _find(key);
+        if (not slot)
+            return {};
+        return &_table.at(*slot).cdr;
     }
 
     V take(K const &key) {
-        for (usize i = 0; i < _els.len(); i++) {
-            if (_els[i].car == key) {
-                V value = std::move(_els[i].cdr);
-                _els.removeAt(i);
-                return value;
-            }
-        }
+        auto slot = _find(key);
+        if (not slot)
+            panic("key not found");
 
-        panic("key not found");
+        V value = std::move(_table.at(*slot).cdr);
+        _table.erase(*slot);
+        return value;
     }
 
     Opt<V> tryGet(K const &key) const {
-        for (auto &i : _els) {
-            if (i.car == key) {
-                return i.cdr;
+        auto slot = _find(key);
+        if (not slot)
+            return NONE;
+        return _table.at(*slot).cdr;
+    }
+
+    bool del(K const &key) {
+        auto slot = _find(key);
+        if (not slot)
+            return false;
+        _table.erase(*slot);
+        return true;
+    }
+
+    bool removeAll(V const &value) {
+        bool changed = false;
+        for (usize i = _table.next(0); i < _table._cap; i = _table.next(i + 1)) {
+            if (_table.at(i).cdr == value) {
+                _table.erase(i);
+                changed = true;
             }
         }
-
-        return NONE;
+        return changed;
     }
 
-    bool del(K const &key) {
-        for (usize i = 0; i < _els.len(); i++) {
-            if (_els[i].car == key) {
-                _els.removeAt(i);
+    bool removeFirst(V const &value) {
+        for (usize i = _table.next(0); i < _table._cap; i = _table.next(i + 1)) {
+            if (_table.at(i).cdr == value) {
+                _table.erase(i);
                 return true;
             }
         }
-
         return false;
     }
 
+    auto iter() const {
+        return Iter{[this, i = 0uz] mutable -> Cons<K, V> const * {
+            i = _table.next(i);
+            if (i >= _table._cap)
+                return nullptr;
+            return &_table.at(i++);
+        }};
+    }
+
+    usize len() const {
+        return _table.len();
+    }
+
+    void clear() {
+        _table.clear();
+    }
+};
+
+// MARK: Ordered Map -----------------------------------------------------------
+
+// A hash map that iterates in insertion order, for when the order is
+// observable, eg. when serializing.
+//
+// NOTE: Removing an entry shifts the ones after it, so it's O(n).
+template <typename K, typename V>
+struct OrderedMap {
+    Vec<Cons<K, V>> _els{};
+    _HashTable<usize> _index{};
+
+    OrderedMap() = default;
+
+    OrderedMap(std::initializer_list<Cons<K, V>> &&list) {
+        for (auto &i : list)
+            put(i.car, i.cdr);
+    }
+
+    static u64 _hash(K const &key) {
+        return _HashTable<usize>::mix(hash(key));
+    }
+
+    Opt<usize> _find(K const &key) const {
+        return _index.find(_hash(key), [&](usize i) {
+            return _els[i].car == key;
+        });
+    }
+
+    void _insert(u64 h, Cons<K, V> entry) {
+        _els.pushBack(std::move(entry));
+        _index.insert(h, _els.len() - 1, [&](usize i) {
+            return _hash(_els[i].car);
+        });
+    }
+
+    void _remove(usize slot) {
+        usize removed = _index.at(slot);
+        _index.erase(slot);
+        _els.removeAt(removed);
+
+        for (usize i = _index.next(0); i < _index._cap; i = _index.next(i + 1))
+            if (_index.at(i) > removed)
+                _index.at(i)--;
+    }
+
+    void put(K const &key, V value) {
+        u64 h = _hash(key);
+        auto slot = _index.find(h, [&](usize i) {
+            return _els[i].car == key;
+        });
+
+        if (slot) {
+            _els[_index.at(*slot)].cdr = std::move(value);
+            return;
+        }
+
+        _insert(h, {key, std::move(value)});
+    }
+
+    bool has(K const &key) const {
+        return _find(key).has();
+    }
+
+    V &get(K const &key) {
+        auto slot = _find(key);
+        if (not slot)
+            panic("key not found");
+        return _els[_index.at(*slot)].cdr;
+    }
+
+    MutCursor<V> access(K const &key) {
+        auto slot = _find(key);
+        if (not slot)
+            return {};
+        return &_els[_index.at(*slot)].cdr;
+    }
+
+    Cursor<V> access(K const &key) const {
+        auto slot = _find(key);
+        if (not slot)
+            return {};
+        return &_els[_index.at(*slot)].cdr;
+    }
+
+    V take(K const &key) {
+        auto slot = _find(key);
+        if (not slot)
+            panic("key not found");
+
+        V value = std::move(_els[_index.at(*slot)].cdr);
+        _remove(*slot);
+        return value;
+    }
+
+    Opt<V> tryGet(K const &key) const {
+        auto slot = _find(key);
+        if (not slot)
+            return NONE;
+        return _els[_index.at(*slot)].cdr;
+    }
+
+    bool del(K const &key) {
+        auto slot = _find(key);
+        if (not slot)
+            return false;
+        _remove(*slot);
+        return true;
+    }
+
     bool removeAll(V const &value) {
         bool changed = false;
-
-        for (usize i = 1; i < _els.len() + 1; i++) {
-            if (_els[i - 1].cdr == value) {
-                _els.removeAt(i - 1);
+        for (usize i = 0; i < _els.len();) {
+            if (_els[i].cdr == value) {
+                del(K{_els[i].car});
                 changed = true;
-                i--;
+            } else {
+                i++;
             }
         }
-
         return changed;
     }
 
     bool removeFirst(V const &value) {
-        for (usize i = 1; i < _els.len() + 1; i++) {
-            if (_els[i - 1].cdr == value) {
-                _els.removeAt(i - 1);
+        for (auto &i : _els) {
+            if (i.cdr == value) {
+                del(K{i.car});
                 return true;
             }
         }
-
         return false;
     }
 
-    auto iter() {
-        return ::iter(_els);
-    }
-
     auto iter() const {
         return ::iter(_els);
     }
@@ -135,6 +521,7 @@ struct Map {
 
     void clear() {
         _els.clear();
+        _index.clear();
     }
 };
 
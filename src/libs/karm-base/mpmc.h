@@ -0,0 +1,160 @@
+#pragma once
+
+#include <karm-meta/nocopy.h>
+
+#include "atomic.h"
+#include "cons.h"
+#include "manual.h"
+#include "opt.h"
+#include "slice.h"
+
+namespace Karm {
+
+// A bounded lock-free queue for any number of producer and consumer
+// threads, the capacity is rounded up to a power of two.
+//
+// Every cell carries a sequence number telling which lap of the ring
+// it is ready for, producers and consumers claim cells by bumping
+// their position and then only touch the cells they claimed.
+// See "Bounded MPMC queue", Dmitry Vyukov.
+template <typename T>
+struct Mpmc : Meta::Pinned {
+    struct _Cell {
+        Atomic<usize> seq;
+        Manual<T> value;
+    };
+
+    _Cell *_cells{};
+    usize _mask{};
+
+    alignas(CACHE_LINE_SIZE) Atomic<usize> _head{};
+    alignas(CACHE_LINE_SIZE) Atomic<usize> _tail{};
+
+    Mpmc(usize cap) {
+        usize size = 2;
+        while (size < cap)
+            size <<= 1;
+        _cells = new _Cell[size];
+        _mask = size - 1;
+        for (usize i = 0; i < size; i++)
+            _cells[i].seq.store(i, RELAXED);
+    }
+
+    ~Mpmc() {
+        while (tryPop())
+            ;
+        delete[] _cells;
+    }
+
+    // Claim up to `max` consecutive cells starting at the current
+    // position of `pos`, a cell can be claimed if its sequence number
+    // is `index + offset`. Returns the first index and the number of
+    // cells claimed, which is 0 if there are none available.
+    Pair<usize> _claim(Atomic<usize> &pos, usize offset, usize max) {
+        usize index = pos.load(RELAXED);
+        while (true) {
+            usize n = 0;
+            while (n < max) {
+                usize seq = _cells[(index + n) & _mask].seq.load(ACQUIRE);
+                if (seq != index + n + offset)
+                    break;
+                n++;
+            }
+
+            if (n == 0) {
+                // Either the queue is full/empty or someone
+                // else moved the position in the meantime.
+                usize curr = pos.load(RELAXED);
+                if (curr == index)
+                    return {index, 0};
+                index = curr;
+                continue;
+            }
+
+            if (pos.cmpxchg(index, index + n, RELAXED))
+                return {index, n};
+            index = pos.load(RELAXED);
+        }
+    }
+
+    // MARK: Push --------------------------------------------------------------
+
+    template <typename... Args>
+    bool tryEmplace(Args &&...args) {
+        auto [index, n] = _claim(_head, 0, 1);
+        if (n == 0)
+            return false;
+
+        auto &cell = _cells[index & _mask];
+        cell.value.ctor(std::forward<Args>(args)...);
+        cell.seq.store(index + 1, RELEASE);
+        return true;
+    }
+
+    // Returns false if the queue is full, `value` is
+    // only moved from if it was pushed.
+    bool tryPush(T &&value) {
+        return tryEmplace(std::move(value));
+    }
+
+    bool tryPush(T const &value) {
+        return tryEmplace(value);
+    }
+
+    // Move as many values as possible into the queue in one go,
+    // returns how many of them, from the start of `values`, were pushed.
+    usize tryPushMany(MutSlice<T> values) {
+        auto [index, n] = _claim(_head, 0, values.len());
+        for (usize i = 0; i < n; i++) {
+            auto &cell = _cells[(index + i) & _mask];
+            cell.value.ctor(std::move(values[i]));
+            cell.seq.store(index + i + 1, RELEASE);
+        }
+        return n;
+    }
+
+    // MARK: Pop ---------------------------------------------------------------
+
+    Opt<T> tryPop() {
+        auto [index, n] = _claim(_tail, 1, 1);
+        if (n == 0)
+            return NONE;
+
+        auto &cell = _cells[index & _mask];
+        T value = cell.value.take();
+        cell.seq.store(index + _mask + 1, RELEASE);
+        return value;
+    }
+
+    // Move as many values as possible out of the queue in one go,
+    // returns how many were written at the start of `out`.
+    usize tryPopMany(MutSlice<T> out) {
+        auto [index, n] = _claim(_tail, 1, out.len());
+        for (usize i = 0; i < n; i++) {
+            auto &cell = _cells[(index + i) & _mask];
+            out[i] = cell.value.take();
+            cell.seq.store(index + i + _mask + 1, RELEASE);
+        }
+        return n;
+    }
+
+    // MARK: Any Thread --------------------------------------------------------
+
+    // NOTE: Other threads might be pushing or popping at the same
+    //       time, so this is only a snapshot.
+    usize len() {
+        usize tail = _tail.load(ACQUIRE);
+        usize head = _head.load(ACQUIRE);
+        return head > tail ? head - tail : 0;
+    }
+
+    bool empty() {
+        return len() == 0;
+    }
+
+    usize cap() const {
+        return _mask + 1;
+    }
+};
+
+} // namespace Karm
@@ -91,7 +91,7 @@ struct [[nodiscard]] Opt {
     always_inline constexpr Opt &operator=(U &&value) {
         clear();
         _present = true;
-        std::construct_at(&_value, std::move(value));
+        std::construct_at(&_value, std::forward<U>(value));
         return *this;
     }
 
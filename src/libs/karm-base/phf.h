@@ -0,0 +1,136 @@
+#pragma once
+
+#include "array.h"
+#include "cons.h"
+#include "hash.h"
+#include "opt.h"
+#include "string.h"
+
+namespace Karm {
+
+// A read-only map from strings to values with a collision-free layout
+// computed at compile time, a lookup is one hash, two table reads
+// and a single string comparison.
+//
+// Keys are spread into buckets, then each bucket, largest first, gets
+// the first seed that sends all of its keys to free slots.
+// See "Hash, displace, and compress", Belazzougui et al.
+template <typename V, usize N>
+struct PerfectMap {
+    static_assert(N > 0 and N < 0xffff, "PerfectMap needs between 1 and 65534 entries");
+
+    static constexpr usize _slotsFor(usize n) {
+        usize slots = 1;
+        while (slots < n + n / 4)
+            slots <<= 1;
+        return slots;
+    }
+
+    static constexpr usize SLOTS = _slotsFor(N);
+    static constexpr usize BUCKETS = N / 4 + 1;
+
+    // Past that many tries, the keys can't be told apart,
+    // there must be duplicates.
+    static constexpr u32 MAX_SEED = 1 << 16;
+
+    Array<Cons<Str, V>, N> _entries;
+    Array<u32, BUCKETS> _seeds{};
+    Array<u16, SLOTS> _slots{};
+
+    // NOTE: Hash is only 32 bits wide on some targets, so
+    //       the bucket comes from a second mix, not its top half.
+    static constexpr usize _bucket(Hash h) {
+        return _hashMix(h, _HASH_P2) % BUCKETS;
+    }
+
+    static constexpr usize _slot(Hash h, u32 seed) {
+        return _hashMix(h ^ seed, _HASH_P1) & (SLOTS - 1);
+    }
+
+    constexpr PerfectMap(Array<Cons<Str, V>, N> const &entries)
+        : _entries(entries) {
+        Array<Hash, N> hashes{};
+        for (usize i = 0; i < N; i++)
+            hashes[i] = hash(_entries[i].car);
+
+        // Sort the keys by bucket
+        Array<usize, BUCKETS + 1> starts{};
+        for (usize i = 0; i < N; i++)
+            starts[_bucket(hashes[i]) + 1]++;
+
+        usize largest = 0;
+        for (usize b = 0; b < BUCKETS; b++) {
+            largest = max(largest, starts[b + 1]);
+            starts[b + 1] += starts[b];
+        }
+
+        Array<usize, BUCKETS> ends{};
+        Array<u16, N> keys{};
+        for (usize b = 0; b < BUCKETS; b++)
+            ends[b] = starts[b];
+        for (usize i = 0; i < N; i++)
+            keys[ends[_bucket(hashes[i])]++] = i;
+
+        // Place the largest buckets first while there is still room
+        Array<bool, SLOTS> used{};
+        for (usize size = largest; size > 0; size--) {
+            for (usize b = 0; b < BUCKETS; b++) {
+                if (ends[b] - starts[b] != size)
+                    continue;
+
+                for (u32 seed = 0;; seed++) {
+                    if (seed == MAX_SEED)
+                        panic("duplicate keys in perfect map");
+
+                    usize placed = 0;
+                    for (; placed < size; placed++) {
+                        usize slot = _slot(hashes[keys[starts[b] + placed]], seed);
+                        if (used[slot])
+                            break;
+                        used[slot] = true;
+                    }
+
+                    if (placed == size) {
+                        _seeds[b] = seed;
+                        for (usize k = starts[b]; k < ends[b]; k++)
+                            _slots[_slot(hashes[keys[k]], seed)] = keys[k];
+                        break;
+                    }
+
+                    // Give back the slots of this try
+                    for (usize k = 0; k < placed; k++)
+                        used[_slot(hashes[keys[starts[b] + k]], seed)] = false;
+                }
+            }
+        }
+    }
+
+    constexpr Cons<Str, V> const *_lookup(Str key) const {
+        Hash h = hash(key);
+        // NOTE: Free slots point at the first entry,
+        //       the comparison takes care of them.
+        auto const &entry = _entries[_slots[_slot(h, _seeds[_bucket(h)])]];
+        if (entry.car != key)
+            return nullptr;
+        return &entry;
+    }
+
+    constexpr Opt<V> get(Str key) const {
+        if (auto *entry = _lookup(key))
+            return entry->cdr;
+        return NONE;
+    }
+
+    constexpr bool has(Str key) const {
+        return _lookup(key) != nullptr;
+    }
+
+    constexpr usize len() const {
+        return N;
+    }
+};
+
+template <typename V, usize N>
+PerfectMap(Array<Cons<Str, V>, N> const &) -> PerfectMap<V, N>;
+
+} // namespace Karm
@@ -2,21 +2,27 @@
 
 #include <karm-meta/traits.h>
 
+#include "atomic.h"
 #include "cursor.h"
+#include "hash.h"
 #include "lock.h"
 #include "opt.h"
 
 namespace Karm {
 
 /// A reference-counted object heap cell.
+///
+/// The counts are atomic so references can be shared between threads. All
+/// the strong references together hold one weak reference, the object is
+/// destroyed with the last strong reference and the cell with the last weak
+/// one.
 struct _Cell {
     static constexpr u64 MAGIC = 0xCAFEBABECAFEBABE;
 
     u64 _magic = MAGIC;
-    Lock _lock;
     bool _clear = false;
-    isize _strong = 0;
-    isize _weak = 0;
+    Atomic<isize> _strong = 0;
+    Atomic<isize> _weak = 1;
 
     virtual ~_Cell() = default;
 
@@ -26,61 +32,53 @@ struct _Cell {
 
     virtual Meta::Type<> inspect() = 0;
 
-    void collectAndRelease() {
-        if (_strong == 0 and not _clear) {
-            clear();
-            _clear = true;
-        }
-
-        if (_strong == 0 and _weak == 0) {
-            _lock.release();
-            delete this;
-        } else {
-            _lock.release();
-        }
-    }
-
     _Cell *refStrong() lifetimebound {
-        LockScope scope(_lock);
-
         if (_clear) [[unlikely]]
             panic("refStrong() called on cleared cell");
 
-        _strong++;
-        if (_strong < 0) [[unlikely]]
+        if (_strong.fetchInc(RELAXED) < 0) [[unlikely]]
             panic("refStrong() overflow");
 
         return this;
     }
 
-    void derefStrong() {
-        _lock.acquire();
+    // Take a strong reference unless the object is already gone.
+    bool tryRefStrong() {
+        isize strong = _strong.load(RELAXED);
+        while (strong > 0) {
+            if (_strong.cmpxchg(strong, strong + 1))
+                return true;
+            strong = _strong.load(RELAXED);
+        }
+        return false;
+    }
 
-        _strong--;
-        if (_strong < 0) [[unlikely]]
+    void derefStrong() {
+        isize prev = _strong.fetchDec(ACQ_REL);
+        if (prev <= 0) [[unlikely]]
             panic("derefStrong() underflow");
 
-        collectAndRelease();
+        if (prev == 1) {
+            clear();
+            _clear = true;
+            derefWeak();
+        }
     }
 
     _Cell *refWeak() lifetimebound {
-        LockScope scope(_lock);
-
-        _weak++;
-        if (_weak < 0) [[unlikely]]
+        if (_weak.fetchInc(RELAXED) < 0) [[unlikely]]
             panic("refWeak() overflow");
 
         return this;
     }
 
     void derefWeak() {
-        _lock.acquire();
-
-        _weak--;
-        if (_weak < 0) [[unlikely]]
+        isize prev = _weak.fetchDec(ACQ_REL);
+        if (prev <= 0) [[unlikely]]
             panic("derefWeak() underflow");
 
-        collectAndRelease();
+        if (prev == 1)
+            delete this;
     }
 
     template <typename T>
@@ -189,12 +187,13 @@ struct Strong {
 
     /// Returns the number of strong references to the object.
     constexpr usize strong() const {
-        return _cell ? _cell->_strong : 0;
+        return _cell ? _cell->_strong.load(RELAXED) : 0;
     }
 
     /// Returns the number of weak references to the object.
     constexpr usize weak() const {
-        return _cell ? _cell->_weak : 0;
+        // Not counting the one held by the strong references
+        return _cell ? _cell->_weak.load(RELAXED) - 1 : 0;
     }
 
     /// Returns the total number of references to the object.
@@ -302,6 +301,13 @@ struct Strong {
     }
 };
 
+template <Hashable T>
+struct Hasher<Strong<T>> {
+    static Hash hash(Strong<T> const &v) {
+        return Karm::hash(v.unwrap());
+    }
+};
+
 /// A weak reference to a an object of type `T`.
 ///
 /// A weak reference does not keep the object alive, but can be
@@ -355,9 +361,11 @@ struct Weak {
     ///
     /// Returns `NONE` if the object has been deallocated.
     Opt<Strong<T>> upgrade() const {
-        if (not _cell or _cell->_clear)
+        if (not _cell or not _cell->tryRefStrong())
             return NONE;
-        return Strong<T>(MOVE, _cell);
+        Strong<T> res{MOVE, _cell};
+        _cell->derefStrong();
+        return res;
     }
 };
 
@@ -55,21 +55,43 @@ struct Ring {
         return *this;
     }
 
-    void pushBack(T value) {
+    void ensure(usize cap) {
+        if (cap <= _cap)
+            return;
+
+        Manual<T> *tmp = new Manual<T>[cap];
+        for (usize i = 0; i < _len; i++)
+            tmp[i].ctor(_buf[(_tail + i) % _cap].take());
+
+        delete[] _buf;
+        _buf = tmp;
+        _cap = cap;
+        _tail = 0;
+        _head = _len;
+    }
+
+    template <typename... Args>
+    T &emplaceBack(Args &&...args) {
         if (_len == _cap) [[unlikely]]
             panic("push on full ring");
 
-        _buf[_head].ctor(value);
+        auto &slot = _buf[_head];
+        slot.ctor(std::forward<Args>(args)...);
         _head = (_head + 1) % _cap;
         _len++;
+        return slot.unwrap();
+    }
+
+    void pushBack(T value) {
+        emplaceBack(std::move(value));
     }
 
     T popBack() {
         if (_len == 0) [[unlikely]]
             panic("pop on empty ring");
 
+        _head = (_head + _cap - 1) % _cap;
         T value = _buf[_head].take();
-        _head = (_head - 1) % _cap;
         _len--;
         return value;
     }
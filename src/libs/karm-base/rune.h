@@ -6,6 +6,7 @@
 #include "array.h"
 #include "buf.h"
 #include "cursor.h"
+#include "simd.h"
 
 namespace Karm {
 
@@ -123,6 +124,12 @@ struct Utf8 {
 
         Unit first = in.next();
 
+        // Most of the text we deal with is ascii, don't make it pay for the rest
+        if (static_cast<u8>(first) < 0x80) [[likely]] {
+            result = first;
+            return true;
+        }
+
         if (unitLen(first) > in.rem() + 1) {
             result = U'�';
             return false;
@@ -171,6 +178,154 @@ struct Utf8 {
 
         return true;
     }
+
+    /// Returns the length of the run of ascii units at the start of `units`.
+    /// The units are checked 32 at a time.
+    static usize asciiLen(Slice<Unit> units) {
+        auto const *buf = reinterpret_cast<u8 const *>(units.buf());
+        usize len = units.len();
+        usize i = 0;
+
+        for (; i + 32 <= len; i += 32) {
+            u64x4 v;
+            __builtin_memcpy(&v, buf + i, sizeof(v));
+            v &= 0x8080808080808080;
+            if (v[0] | v[1] | v[2] | v[3])
+                break;
+        }
+
+        for (; i + 8 <= len; i += 8) {
+            u64 v;
+            __builtin_memcpy(&v, buf + i, sizeof(v));
+            if (v & 0x8080808080808080)
+                break;
+        }
+
+        while (i < len and buf[i] < 0x80)
+            i++;
+
+        return i;
+    }
+
+    /// Returns the length of the well-formed sequence at the start of `buf`,
+    /// or 0 if it's ill-formed, in which case `bad` is set to the length of
+    /// its maximal subpart, the units to replace with a single U+FFFD.
+    ///
+    /// See The Unicode Standard, Table 3-7 "Well-Formed UTF-8 Byte Sequences".
+    static usize _sequenceLen(u8 const *buf, usize len, usize &bad) {
+        u8 lead = buf[0];
+        if (lead < 0x80)
+            return 1;
+
+        usize need;
+        u8 lo = 0x80, hi = 0xbf;
+        if (lead >= 0xc2 and lead <= 0xdf) {
+            need = 1;
+        } else if (lead >= 0xe0 and lead <= 0xef) {
+            need = 2;
+            if (lead == 0xe0)
+                lo = 0xa0; // Overlong
+            else if (lead == 0xed)
+                hi = 0x9f; // Surrogates
+        } else if (lead >= 0xf0 and lead <= 0xf4) {
+            need = 3;
+            if (lead == 0xf0)
+                lo = 0x90; // Overlong
+            else if (lead == 0xf4)
+                hi = 0x8f; // Above U+10FFFF
+        } else {
+            bad = 1;
+            return 0;
+        }
+
+        for (usize i = 1; i <= need; i++) {
+            if (i >= len or buf[i] < lo or buf[i] > hi) {
+                bad = i;
+                return 0;
+            }
+            lo = 0x80;
+            hi = 0xbf;
+        }
+
+        return need + 1;
+    }
+
+    static Rune _decodeSequence(u8 const *buf, usize len) {
+        switch (len) {
+        case 2:
+            return ((buf[0] & 0x1f) << 6) | (buf[1] & 0x3f);
+        case 3:
+            return ((buf[0] & 0x0f) << 12) | ((buf[1] & 0x3f) << 6) | (buf[2] & 0x3f);
+        case 4:
+            return ((buf[0] & 0x07) << 18) | ((buf[1] & 0x3f) << 12) | ((buf[2] & 0x3f) << 6) | (buf[3] & 0x3f);
+        default:
+            return buf[0];
+        }
+    }
+
+    /// Returns the length of the longest well-formed prefix of `units`.
+    static usize validLen(Slice<Unit> units) {
+        auto const *buf = reinterpret_cast<u8 const *>(units.buf());
+        usize len = units.len();
+        usize i = 0;
+
+        while (i < len) {
+            if (buf[i] < 0x80) {
+                i += asciiLen({units.buf() + i, len - i});
+                continue;
+            }
+
+            usize bad = 0;
+            usize n = _sequenceLen(buf + i, len - i, bad);
+            if (n == 0)
+                return i;
+            i += n;
+        }
+
+        return i;
+    }
+
+    /// Check that `units` is well-formed UTF-8, rejecting overlong
+    /// encodings, surrogates and runes above U+10FFFF.
+    static bool validate(Slice<Unit> units) {
+        return validLen(units) == units.len();
+    }
+
+    /// Decode runes from `in` into `out` until one of them is exhausted,
+    /// ill-formed sequences are decoded as U+FFFD.
+    /// Returns the number of runes written to `out`.
+    static usize decode(Cursor<Unit> &in, MutSlice<Rune> out) {
+        auto const *buf = reinterpret_cast<u8 const *>(in.buf());
+        usize len = in.rem();
+        Rune *res = out.buf();
+        usize cap = out.len();
+
+        usize i = 0, o = 0;
+        while (i < len and o < cap) {
+            if (buf[i] < 0x80) {
+                usize n = asciiLen({in.buf() + i, min(len - i, cap - o)});
+                for (usize j = 0; j < n; j++)
+                    res[o + j] = buf[i + j];
+                i += n;
+                o += n;
+                continue;
+            }
+
+            usize bad = 0;
+            usize n = _sequenceLen(buf + i, len - i, bad);
+            if (n == 0) {
+                res[o++] = U'�';
+                i += bad;
+                continue;
+            }
+
+            res[o++] = _decodeSequence(buf + i, n);
+            i += n;
+        }
+
+        in.next(i);
+        return o;
+    }
 };
 
 [[gnu::used]] inline Utf8 UTF8;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "iter.h"
+#include "manual.h"
 #include "range.h"
 
 namespace Karm {
@@ -423,35 +424,223 @@ constexpr usize zeroFill(MutSlice<T> slice) {
     return fill(slice, {});
 }
 
-always_inline constexpr void sort(MutSliceable auto &slice, auto cmp) {
-    if (slice.len() <= 1)
-        return;
+// Insertion sort, fast on small or almost sorted inputs, and stable.
+template <typename T>
+constexpr void _insertionSort(T *buf, usize len, auto &cmp) {
+    for (usize i = 1; i < len; i++) {
+        if (not(cmp(buf[i], buf[i - 1]) < 0))
+            continue;
+
+        T tmp = std::move(buf[i]);
+        usize j = i;
+        do {
+            buf[j] = std::move(buf[j - 1]);
+            j--;
+        } while (j > 0 and cmp(tmp, buf[j - 1]) < 0);
+        buf[j] = std::move(tmp);
+    }
+}
 
-    auto pivot = slice[slice.len() / 2];
-    auto left = 0uz;
-    auto right = slice.len() - 1;
+// Same as _insertionSort() but gives up, returning false, once it moved too
+// many elements.
+template <typename T>
+constexpr bool _partialInsertionSort(T *buf, usize len, auto &cmp) {
+    static constexpr usize LIMIT = 8;
+
+    usize moves = 0;
+    for (usize i = 1; i < len; i++) {
+        if (not(cmp(buf[i], buf[i - 1]) < 0))
+            continue;
+
+        T tmp = std::move(buf[i]);
+        usize j = i;
+        do {
+            buf[j] = std::move(buf[j - 1]);
+            j--;
+        } while (j > 0 and cmp(tmp, buf[j - 1]) < 0);
+        buf[j] = std::move(tmp);
 
-    while (left <= right) {
-        while (cmp(slice[left], pivot) < 0) {
-            left++;
+        moves += i - j;
+        if (moves > LIMIT)
+            return false;
+    }
+    return true;
+}
+
+template <typename T>
+constexpr void _siftDown(T *buf, usize len, usize i, auto &cmp) {
+    while (true) {
+        usize child = i * 2 + 1;
+        if (child >= len)
+            return;
+        if (child + 1 < len and cmp(buf[child], buf[child + 1]) < 0)
+            child++;
+        if (not(cmp(buf[i], buf[child]) < 0))
+            return;
+        std::swap(buf[i], buf[child]);
+        i = child;
+    }
+}
+
+template <typename T>
+constexpr void _heapSort(T *buf, usize len, auto &cmp) {
+    for (usize i = len / 2; i > 0; i--)
+        _siftDown(buf, len, i - 1, cmp);
+
+    for (usize end = len - 1; end > 0; end--) {
+        std::swap(buf[0], buf[end]);
+        _siftDown(buf, end, 0, cmp);
+    }
+}
+
+// Order the elements at a, b and c.
+template <typename T>
+constexpr void _sort3(T *buf, usize a, usize b, usize c, auto &cmp) {
+    if (cmp(buf[b], buf[a]) < 0)
+        std::swap(buf[a], buf[b]);
+    if (cmp(buf[c], buf[b]) < 0)
+        std::swap(buf[b], buf[c]);
+    if (cmp(buf[b], buf[a]) < 0)
+        std::swap(buf[a], buf[b]);
+}
+
+// Partition around the first element, elements equal to the pivot go right.
+// Returns where the pivot ended up and whether nothing had to be moved.
+template <typename T>
+constexpr Cons<usize, bool> _partitionRight(T *buf, usize len, auto &cmp) {
+    T pivot = std::move(buf[0]);
+
+    usize first = 1;
+    usize last = len;
+    while (first < last and cmp(buf[first], pivot) < 0)
+        first++;
+    while (first < last and not(cmp(buf[last - 1], pivot) < 0))
+        last--;
+
+    bool partitioned = first >= last;
+    while (first < last) {
+        std::swap(buf[first++], buf[--last]);
+        while (first < last and cmp(buf[first], pivot) < 0)
+            first++;
+        while (first < last and not(cmp(buf[last - 1], pivot) < 0))
+            last--;
+    }
+
+    usize pos = first - 1;
+    buf[0] = std::move(buf[pos]);
+    buf[pos] = std::move(pivot);
+    return {pos, partitioned};
+}
+
+// Partition around the first element, elements equal to the pivot go left.
+template <typename T>
+constexpr usize _partitionLeft(T *buf, usize len, auto &cmp) {
+    T pivot = std::move(buf[0]);
+
+    usize first = 1;
+    usize last = len;
+    while (true) {
+        while (first < last and not(cmp(pivot, buf[first]) < 0))
+            first++;
+        while (first < last and cmp(pivot, buf[last - 1]) < 0)
+            last--;
+        if (first >= last)
+            break;
+        std::swap(buf[first++], buf[--last]);
+    }
+
+    usize pos = first - 1;
+    buf[0] = std::move(buf[pos]);
+    buf[pos] = std::move(pivot);
+    return pos;
+}
+
+// Pattern-defeating quicksort, see https://arxiv.org/abs/2106.05123
+//
+// Falls back to heap sort after too many unbalanced partitions so it's
+// O(n log n) in the worst case, and only recurses into the smaller side
+// so the stack stays O(log n).
+template <typename T>
+constexpr void _pdqSort(T *buf, usize len, auto &cmp, usize badAllowed, bool leftmost) {
+    static constexpr usize INSERTION = 24;
+    static constexpr usize NINTHER = 128;
+
+    while (true) {
+        if (len < INSERTION) {
+            _insertionSort(buf, len, cmp);
+            return;
         }
 
-        while (cmp(slice[right], pivot) > 0) {
-            right--;
+        usize half = len / 2;
+        if (len > NINTHER) {
+            _sort3(buf, 0, half, len - 1, cmp);
+            _sort3(buf, 1, half - 1, len - 2, cmp);
+            _sort3(buf, 2, half + 1, len - 3, cmp);
+            _sort3(buf, half - 1, half, half + 1, cmp);
+            std::swap(buf[0], buf[half]);
+        } else {
+            _sort3(buf, half, 0, len - 1, cmp);
         }
 
-        if (left <= right) {
-            std::swap(slice[left], slice[right]);
-            left++;
-            right--;
+        // The element before us was a pivot, if it's equal to this one,
+        // everything equal to it is already in place.
+        if (not leftmost and not(cmp(buf[-1], buf[0]) < 0)) {
+            usize pos = _partitionLeft(buf, len, cmp);
+            buf += pos + 1;
+            len -= pos + 1;
+            continue;
+        }
+
+        auto [pos, partitioned] = _partitionRight(buf, len, cmp);
+        usize leftLen = pos;
+        usize rightLen = len - pos - 1;
+
+        if (leftLen < len / 8 or rightLen < len / 8) {
+            if (--badAllowed == 0) {
+                _heapSort(buf, len, cmp);
+                return;
+            }
+
+            // Break patterns that lead to bad pivots
+            if (leftLen >= INSERTION) {
+                std::swap(buf[0], buf[leftLen / 4]);
+                std::swap(buf[pos - 1], buf[pos - leftLen / 4]);
+            }
+
+            if (rightLen >= INSERTION) {
+                std::swap(buf[pos + 1], buf[pos + 1 + rightLen / 4]);
+                std::swap(buf[len - 1], buf[len - rightLen / 4]);
+            }
+        } else if (partitioned and
+                   _partialInsertionSort(buf, leftLen, cmp) and
+                   _partialInsertionSort(buf + pos + 1, rightLen, cmp)) {
+            // The input was most likely already sorted
+            return;
+        }
+
+        if (leftLen < rightLen) {
+            _pdqSort(buf, leftLen, cmp, badAllowed, leftmost);
+            buf += pos + 1;
+            len = rightLen;
+            leftmost = false;
+        } else {
+            _pdqSort(buf + pos + 1, rightLen, cmp, badAllowed, false);
+            len = leftLen;
         }
     }
+}
 
-    auto rightSlice = mutSub(slice, 0, right + 1);
-    sort(rightSlice, cmp);
+// Sort the slice, the order of equal elements isn't kept.
+always_inline constexpr void sort(MutSliceable auto &slice, auto cmp) {
+    usize len = slice.len();
+    if (len <= 1)
+        return;
+
+    usize badAllowed = 0;
+    for (usize n = len; n; n >>= 1)
+        badAllowed++;
 
-    auto leftSlice = mutSub(slice, left, slice.len());
-    sort(leftSlice, cmp);
+    _pdqSort(slice.buf(), len, cmp, badAllowed, true);
 }
 
 always_inline constexpr void sort(MutSliceable auto &slice) {
@@ -460,18 +649,184 @@ always_inline constexpr void sort(MutSliceable auto &slice) {
     });
 }
 
-always_inline constexpr void stableSort(MutSliceable auto &slice, auto cmp) {
-    for (usize i = 1; i < slice.len(); i++) {
-        auto key = slice[i];
-        isize j = i - 1;
+// Scratch memory for the sorts that can't work in place.
+template <typename T>
+struct _SortBuf {
+    Manual<T> *_buf = nullptr;
+    usize _cap;
 
-        while (j >= 0 and cmp(slice[j], key) > 0) {
-            slice[j + 1] = slice[j];
-            j--;
+    _SortBuf(usize cap) : _cap(cap) {}
+
+    ~_SortBuf() {
+        delete[] _buf;
+    }
+
+    T *buf() {
+        if (not _buf)
+            _buf = new Manual<T>[_cap];
+        return &_buf[0].unwrap();
+    }
+};
+
+// Length of the run at the start of the buffer, strictly descending runs are
+// reversed so runs are always ascending.
+template <typename T>
+constexpr usize _countRun(T *buf, usize len, auto &cmp) {
+    if (len < 2)
+        return len;
+
+    usize i = 2;
+    if (cmp(buf[1], buf[0]) < 0) {
+        while (i < len and cmp(buf[i], buf[i - 1]) < 0)
+            i++;
+        for (usize j = 0; j < i / 2; j++)
+            std::swap(buf[j], buf[i - j - 1]);
+    } else {
+        while (i < len and not(cmp(buf[i], buf[i - 1]) < 0))
+            i++;
+    }
+    return i;
+}
+
+// Merge the sorted runs [0, mid) and [mid, len), moving the shortest of the
+// two to the scratch buffer.
+template <typename T>
+constexpr void _merge(T *buf, usize mid, usize len, _SortBuf<T> &scratch, auto &cmp) {
+    // Elements of the left run smaller than the whole right run, and the
+    // elements of the right run bigger than the whole left run are already
+    // in place.
+    usize lo = 0, hi = mid;
+    while (lo < hi) {
+        usize m = lo + (hi - lo) / 2;
+        if (cmp(buf[mid], buf[m]) < 0)
+            hi = m;
+        else
+            lo = m + 1;
+    }
+    usize start = lo;
+
+    lo = mid, hi = len;
+    while (lo < hi) {
+        usize m = lo + (hi - lo) / 2;
+        if (cmp(buf[m], buf[mid - 1]) < 0)
+            lo = m + 1;
+        else
+            hi = m;
+    }
+    usize end = lo;
+
+    if (start == mid or end == mid)
+        return;
+
+    buf += start;
+    mid -= start;
+    len = end - start;
+
+    T *tmp = scratch.buf();
+    if (mid <= len - mid) {
+        for (usize i = 0; i < mid; i++)
+            new (&tmp[i]) T(std::move(buf[i]));
+
+        usize i = 0, j = mid, o = 0;
+        while (i < mid and j < len) {
+            if (cmp(buf[j], tmp[i]) < 0)
+                buf[o++] = std::move(buf[j++]);
+            else
+                buf[o++] = std::move(tmp[i++]);
+        }
+        while (i < mid)
+            buf[o++] = std::move(tmp[i++]);
+
+        for (usize k = 0; k < mid; k++)
+            tmp[k].~T();
+    } else {
+        usize right = len - mid;
+        for (usize i = 0; i < right; i++)
+            new (&tmp[i]) T(std::move(buf[mid + i]));
+
+        usize i = mid, j = right, o = len;
+        while (i > 0 and j > 0) {
+            if (cmp(tmp[j - 1], buf[i - 1]) < 0)
+                buf[--o] = std::move(buf[--i]);
+            else
+                buf[--o] = std::move(tmp[--j]);
+        }
+        while (j > 0)
+            buf[--o] = std::move(tmp[--j]);
+
+        for (usize k = 0; k < right; k++)
+            tmp[k].~T();
+    }
+}
+
+// Adaptive merge sort in the spirit of timsort.
+//
+// Natural runs are found and extended to a minimum length with insertion
+// sort, then merged while keeping the lengths of the pending runs shrinking
+// faster than the Fibonacci sequence, so merges stay balanced.
+template <typename T>
+constexpr void _mergeSort(T *buf, usize len, auto &cmp) {
+    usize minRun = len;
+    usize extra = 0;
+    while (minRun >= 64) {
+        extra |= minRun & 1;
+        minRun >>= 1;
+    }
+    minRun += extra;
+
+    struct Run {
+        usize start;
+        usize len;
+    };
+
+    // Enough for 2^64 elements given the invariants on the run lengths
+    Run runs[96];
+    usize count = 0;
+    _SortBuf<T> scratch{len / 2};
+
+    auto mergeAt = [&](usize k) {
+        auto &a = runs[k];
+        auto &b = runs[k + 1];
+        _merge(buf + a.start, a.len, a.len + b.len, scratch, cmp);
+        a.len += b.len;
+        for (usize i = k + 1; i + 1 < count; i++)
+            runs[i] = runs[i + 1];
+        count--;
+    };
+
+    usize i = 0;
+    while (i < len) {
+        usize run = _countRun(buf + i, len - i, cmp);
+        if (run < minRun) {
+            run = min(minRun, len - i);
+            _insertionSort(buf + i, run, cmp);
         }
 
-        slice[j + 1] = key;
+        runs[count++] = {i, run};
+        i += run;
+
+        while (count > 1) {
+            usize k = count - 2;
+            if ((k > 0 and runs[k - 1].len <= runs[k].len + runs[k + 1].len) or
+                (k > 1 and runs[k - 2].len <= runs[k - 1].len + runs[k].len)) {
+                if (runs[k - 1].len < runs[k + 1].len)
+                    k--;
+            } else if (runs[k].len > runs[k + 1].len) {
+                break;
+            }
+            mergeAt(k);
+        }
     }
+
+    while (count > 1)
+        mergeAt(count - 2);
+}
+
+// Sort the slice, keeping the order of equal elements.
+always_inline constexpr void stableSort(MutSliceable auto &slice, auto cmp) {
+    if (slice.len() <= 1)
+        return;
+    _mergeSort(slice.buf(), slice.len(), cmp);
 }
 
 always_inline constexpr void stableSort(MutSliceable auto &slice) {
@@ -480,6 +835,92 @@ always_inline constexpr void stableSort(MutSliceable auto &slice) {
     });
 }
 
+// Map an integer to an unsigned one with the same ordering.
+template <Meta::Integral K>
+constexpr u64 _radixBits(K key) {
+    u64 bits = static_cast<u64>(key);
+    if constexpr (sizeof(K) < sizeof(u64))
+        bits &= (1ull << (sizeof(K) * 8)) - 1;
+    if constexpr (Meta::Signed<K>)
+        bits ^= 1ull << (sizeof(K) * 8 - 1);
+    return bits;
+}
+
+// Sort the slice by an integer key, in linear time, keeping the order of
+// equal keys.
+//
+// This is a least significant digit first radix sort, with one pass per byte
+// of the key, passes where all the keys have the same digit are skipped.
+always_inline constexpr void radixSort(MutSliceable auto &slice, auto key) {
+    using T = Meta::RemoveConstVolatileRef<decltype(slice[0uz])>;
+    using K = decltype(key(slice[0uz]));
+    static constexpr usize DIGITS = sizeof(K);
+
+    usize len = slice.len();
+    if (len < 64) {
+        stableSort(slice, [&](auto const &a, auto const &b) {
+            return key(a) <=> key(b);
+        });
+        return;
+    }
+
+    usize counts[DIGITS][256] = {};
+    for (usize i = 0; i < len; i++) {
+        u64 bits = _radixBits(key(slice[i]));
+        for (usize d = 0; d < DIGITS; d++)
+            counts[d][(bits >> (d * 8)) & 0xff]++;
+    }
+
+    _SortBuf<T> scratch{len};
+    T *src = slice.buf();
+    T *dst = scratch.buf();
+    bool constructed = false;
+
+    for (usize d = 0; d < DIGITS; d++) {
+        auto &count = counts[d];
+        bool trivial = false;
+        for (usize b = 0; b < 256; b++)
+            if (count[b] == len)
+                trivial = true;
+        if (trivial)
+            continue;
+
+        usize offsets[256];
+        usize offset = 0;
+        for (usize b = 0; b < 256; b++) {
+            offsets[b] = offset;
+            offset += count[b];
+        }
+
+        for (usize i = 0; i < len; i++) {
+            usize digit = (_radixBits(key(src[i])) >> (d * 8)) & 0xff;
+            T *out = &dst[offsets[digit]++];
+            if (dst == scratch.buf() and not constructed)
+                new (out) T(std::move(src[i]));
+            else
+                *out = std::move(src[i]);
+        }
+
+        if (dst == scratch.buf())
+            constructed = true;
+        std::swap(src, dst);
+    }
+
+    if (src != slice.buf())
+        for (usize i = 0; i < len; i++)
+            slice[i] = std::move(src[i]);
+
+    if (constructed)
+        for (usize i = 0; i < len; i++)
+            scratch.buf()[i].~T();
+}
+
+always_inline constexpr void radixSort(MutSliceable auto &slice) {
+    radixSort(slice, [](auto const &v) {
+        return v;
+    });
+}
+
 template <Sliceable T, typename U = T::Inner>
 always_inline constexpr Opt<usize> indexOf(T const &slice, Meta::Equatable<U> auto const &needle) {
     for (usize i = 0; i < slice.len(); i++)
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <karm-meta/nocopy.h>
+
+#include "atomic.h"
+#include "manual.h"
+#include "opt.h"
+
+namespace Karm {
+
+// A bounded lock-free queue for exactly one producer thread
+// and one consumer thread, the capacity is rounded up to a
+// power of two.
+//
+// Each side keeps a cached copy of the other side's index
+// and only reloads it when the queue looks full or empty,
+// so most operations don't touch the other side's cache line.
+template <typename T>
+struct Spsc : Meta::Pinned {
+    Manual<T> *_buf{};
+    usize _mask{};
+
+    // Producer side
+    alignas(CACHE_LINE_SIZE) Atomic<usize> _head{};
+    usize _tailCache{};
+
+    // Consumer side
+    alignas(CACHE_LINE_SIZE) Atomic<usize> _tail{};
+    usize _headCache{};
+
+    Spsc(usize cap) {
+        usize size = 1;
+        while (size < cap)
+            size <<= 1;
+        _buf = new Manual<T>[size];
+        _mask = size - 1;
+    }
+
+    ~Spsc() {
+        usize tail = _tail.load(RELAXED);
+        usize head = _head.load(RELAXED);
+        for (; tail != head; tail++)
+            _buf[tail & _mask].dtor();
+        delete[] _buf;
+    }
+
+    // MARK: Producer ----------------------------------------------------------
+
+    template <typename... Args>
+    bool tryEmplace(Args &&...args) {
+        usize head = _head.load(RELAXED);
+        if (head - _tailCache > _mask) {
+            _tailCache = _tail.load(ACQUIRE);
+            if (head - _tailCache > _mask)
+                return false;
+        }
+
+        _buf[head & _mask].ctor(std::forward<Args>(args)...);
+        _head.store(head + 1, RELEASE);
+        return true;
+    }
+
+    // Returns false if the queue is full, `value` is
+    // only moved from if it was pushed.
+    bool tryPush(T &&value) {
+        return tryEmplace(std::move(value));
+    }
+
+    bool tryPush(T const &value) {
+        return tryEmplace(value);
+    }
+
+    // MARK: Consumer ----------------------------------------------------------
+
+    Opt<T> tryPop() {
+        usize tail = _tail.load(RELAXED);
+        if (tail == _headCache) {
+            _headCache = _head.load(ACQUIRE);
+            if (tail == _headCache)
+                return NONE;
+        }
+
+        T value = _buf[tail & _mask].take();
+        _tail.store(tail + 1, RELEASE);
+        return value;
+    }
+
+    // MARK: Any Thread --------------------------------------------------------
+
+    // NOTE: The other side might be pushing or popping at the same
+    //       time, so this is only a snapshot.
+    usize len() {
+        usize tail = _tail.load(ACQUIRE);
+        return _head.load(ACQUIRE) - tail;
+    }
+
+    bool empty() {
+        return len() == 0;
+    }
+
+    usize cap() const {
+        return _mask + 1;
+    }
+};
+
+} // namespace Karm
@@ -100,34 +100,55 @@ struct _InlineString {
 template <usize N>
 using InlineString = _InlineString<Utf8, N>;
 
+// NOTE: Short strings live inside the object, so a Str taken from
+//       a String doesn't survive the String being moved, this
+//       includes a Vec or a Map it's stored in growing.
 template <StaticEncoding E>
 struct _String {
     using Encoding = E;
     using Unit = typename E::Unit;
     using Inner = Unit;
 
-    static constexpr Array<Unit, 1> _EMPTY = {0};
+    struct _Heap {
+        Unit const *buf;
+        usize len;
+    };
 
-    Unit const *_buf = nullptr;
-    usize _len = 0;
+    // Short strings are stored inline, the last byte holds
+    // their length, or _HEAP if the string lives on the heap.
+    static constexpr usize _SIZE = sizeof(_Heap) + sizeof(usize);
+    static constexpr usize _INLINE = (_SIZE - 1) / sizeof(Unit) - 1;
+    static constexpr u8 _HEAP = 0xff;
 
-    constexpr _String() = default;
+    static_assert(_INLINE < _HEAP);
+
+    union {
+        _Heap _heap;
+        Unit _inline[_INLINE + 1];
+        u8 _raw[_SIZE];
+    };
+
+    constexpr _String() : _raw{} {}
 
     always_inline _String(Move, Unit const *buf, usize len)
-        : _buf(buf),
-          _len(len) {
+        : _heap{buf, len} {
+        _tag() = _HEAP;
     }
 
-    _String(Unit const *buf, usize len)
-        : _len(len) {
-        if (len == 0)
-            // Allow initializing the string using "" and not allocating memory.
+    _String(Unit const *buf, usize len) : _raw{} {
+        if (len <= _INLINE) {
+            // NOTE: The inline storage is zeroed,
+            //       so the string stays null-terminated.
+            memcpy(_inline, buf, len * sizeof(Unit));
+            _tag() = len;
             return;
+        }
 
         auto store = new Unit[len + 1];
         store[len] = 0;
         memcpy(store, buf, len * sizeof(Unit));
-        _buf = store;
+        _heap = {store, len};
+        _tag() = _HEAP;
     }
 
     always_inline _String(_Str<E> str)
@@ -137,19 +158,17 @@ struct _String {
         : _String(other.buf(), other.len()) {}
 
     always_inline _String(_String const &other)
-        : _String(other._buf, other._len) {
+        : _String(other.buf(), other.len()) {
     }
 
-    always_inline _String(_String &&other)
-        : _buf(std::exchange(other._buf, nullptr)),
-          _len(std::exchange(other._len, 0)) {
+    always_inline _String(_String &&other) {
+        memcpy(_raw, other._raw, _SIZE);
+        memset(other._raw, 0, _SIZE);
     }
 
     ~_String() {
-        if (_buf) {
-            _len = 0;
-            delete[] std::exchange(_buf, nullptr);
-        }
+        if (_onHeap())
+            delete[] _heap.buf;
     }
 
     always_inline _String &operator=(_String const &other) {
@@ -158,22 +177,34 @@ struct _String {
     }
 
     always_inline _String &operator=(_String &&other) {
-        std::swap(_buf, other._buf);
-        std::swap(_len, other._len);
+        u8 tmp[_SIZE];
+        memcpy(tmp, _raw, _SIZE);
+        memcpy(_raw, other._raw, _SIZE);
+        memcpy(other._raw, tmp, _SIZE);
         return *this;
     }
 
+    always_inline u8 &_tag() { return _raw[_SIZE - 1]; }
+
+    always_inline u8 _tag() const { return _raw[_SIZE - 1]; }
+
+    always_inline bool _onHeap() const { return _tag() == _HEAP; }
+
     always_inline _Str<E> str() const lifetimebound { return *this; }
 
     always_inline Unit const &operator[](usize i) const lifetimebound {
-        if (i >= _len) [[unlikely]]
+        if (i >= len()) [[unlikely]]
             panic("index out of bounds");
         return buf()[i];
     }
 
-    always_inline Unit const *buf() const lifetimebound { return _len ? _buf : _EMPTY.buf(); }
+    always_inline Unit const *buf() const lifetimebound {
+        return _onHeap() ? _heap.buf : _inline;
+    }
 
-    always_inline usize len() const { return _len; }
+    always_inline usize len() const {
+        return _onHeap() ? _heap.len : _tag();
+    }
 
     always_inline auto operator<=>(Unit const *cstr) const
         requires(Meta::Same<Unit, char>)
@@ -187,8 +218,8 @@ struct _String {
         return str() == _Str<E>(cstr);
     }
 
-    always_inline constexpr explicit operator bool() const {
-        return _len > 0;
+    always_inline explicit operator bool() const {
+        return len() > 0;
     }
 };
 
@@ -252,6 +283,9 @@ using Str = _Str<Utf8>;
 
 using String = _String<Utf8>;
 
+static_assert(sizeof(String) == sizeof(usize) * 3);
+static_assert(String::_INLINE == sizeof(usize) * 3 - 2);
+
 template <auto N>
 struct StrLit {
     char _buf[N];
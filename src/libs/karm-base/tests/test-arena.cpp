@@ -0,0 +1,124 @@
+#include <karm-base/arena.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Base::Tests {
+
+test$("arena-alloc") {
+    Arena arena;
+
+    auto *a = static_cast<u8 *>(arena.alloc(3, 1));
+    auto *b = static_cast<u64 *>(arena.alloc(sizeof(u64), alignof(u64)));
+    expect$(a != nullptr);
+    expect$(isAlign(reinterpret_cast<usize>(b), alignof(u64)));
+    expect$(reinterpret_cast<u8 *>(b) >= a + 3);
+    expectEq$(arena.used(), 11uz);
+
+    // Allocations bigger than a chunk get their own
+    auto *big = static_cast<u8 *>(arena.alloc(Arena::CHUNK_SIZE * 2, 1));
+    big[Arena::CHUNK_SIZE * 2 - 1] = 42;
+    expectEq$(big[Arena::CHUNK_SIZE * 2 - 1], 42);
+
+    arena.reset();
+    expectEq$(arena.used(), 0uz);
+
+    return Ok();
+}
+
+test$("arena-grow") {
+    Arena arena;
+
+    auto *a = arena.alloc(16, 1);
+    expect$(arena.grow(a, 16, 32));
+
+    auto *b = arena.alloc(16, 1);
+    expectEq$(b, static_cast<u8 *>(a) + 32);
+    expect$(not arena.grow(a, 32, 64));
+
+    return Ok();
+}
+
+test$("arena-make-dtor") {
+    Vec<int> order;
+
+    struct Probe {
+        Vec<int> &order;
+        int id;
+
+        ~Probe() {
+            order.pushBack(id);
+        }
+    };
+
+    {
+        Arena arena;
+        auto &p = arena.make<Probe>(order, 1);
+        arena.make<Probe>(order, 2);
+        expectEq$(p.id, 1);
+
+        arena.reset();
+        expectEq$(order, (Vec<int>{2, 1}));
+
+        arena.make<Probe>(order, 3);
+    }
+
+    expectEq$(order, (Vec<int>{2, 1, 3}));
+
+    return Ok();
+}
+
+test$("arena-copy-str") {
+    Arena arena;
+
+    Str str;
+    {
+        String tmp = "hello"s;
+        str = arena.copy(tmp.str());
+    }
+
+    expectEq$(str, "hello"s);
+    expectEq$(str.buf()[5], '\0');
+
+    return Ok();
+}
+
+test$("arena-vec") {
+    Arena arena;
+    ArenaVec<int> vec{arena};
+
+    for (int i = 0; i < 1000; i++)
+        vec.pushBack(i);
+
+    expectEq$(vec.len(), 1000uz);
+    for (int i = 0; i < 1000; i++)
+        expectEq$(vec[i], i);
+
+    vec.removeAt(0);
+    vec.insert(0, -1);
+    expectEq$(vec[0], -1);
+    expectEq$(vec[1], 1);
+
+    auto copy = vec;
+    copy.pushBack(1000);
+    expectEq$(copy.len(), 1001uz);
+    expectEq$(vec.len(), 1000uz);
+
+    return Ok();
+}
+
+test$("arena-vec-strings") {
+    Arena arena;
+    ArenaVec<String> vec{arena};
+
+    for (int i = 0; i < 100; i++)
+        vec.pushBack("string"s);
+
+    expectEq$(vec.len(), 100uz);
+    expectEq$(vec[99], "string"s);
+
+    vec.clear();
+    expectEq$(vec.len(), 0uz);
+
+    return Ok();
+}
+
+} // namespace Karm::Base::Tests
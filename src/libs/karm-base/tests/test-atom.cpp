@@ -0,0 +1,51 @@
+#include <karm-base/atom.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Base::Tests {
+
+test$("atom-intern") {
+    Atom a = "foo"s;
+    Atom b = String{"foo"s};
+    Atom c = "bar"s;
+
+    expectEq$(a, b);
+    expectEq$(a._entry, b._entry);
+    expectNe$(a, c);
+    expectEq$(a.str(), "foo"s);
+    expectEq$(a.hash(), b.hash());
+
+    return Ok();
+}
+
+test$("atom-empty") {
+    Atom a;
+    Atom b = ""s;
+
+    expectEq$(a, b);
+    expect$(not a);
+    expectEq$(a.str(), ""s);
+
+    return Ok();
+}
+
+test$("atom-lookup") {
+    expectEq$(Atom::lookup("atom-lookup-never-interned"s), NONE);
+
+    Atom a = "atom-lookup-interned"s;
+    expectEq$(Atom::lookup("atom-lookup-interned"s), a);
+
+    return Ok();
+}
+
+test$("atom-compare") {
+    Atom a = "abc"s;
+    Atom b = "abd"s;
+
+    expect$(a < b);
+    expect$(a == "abc"s);
+    expect$(a != "abd"s);
+
+    return Ok();
+}
+
+} // namespace Karm::Base::Tests
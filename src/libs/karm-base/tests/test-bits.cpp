@@ -0,0 +1,177 @@
+#include <karm-base/bits.h>
+#include <karm-base/vec.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Base::Tests {
+
+static u64 _next(u64 &state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// A bitmap of `bytes` bytes, with or without a summary.
+struct _TestBits {
+    Vec<u8> buf;
+    Vec<u64> summary;
+    Opt<Bits> bits;
+
+    _TestBits(usize bytes, bool summarized) {
+        buf.resize(bytes);
+        if (summarized) {
+            summary.resize(Bits::summaryLen(bytes));
+            bits.emplace(mutSub(buf), mutSub(summary));
+        } else {
+            bits.emplace(mutSub(buf));
+        }
+    }
+};
+
+// The first run of `count` free bits at or after `start`, one bit at a time.
+static Opt<usize> _naiveFind(Bits const &bits, usize count, usize start) {
+    usize run = 0;
+    for (usize i = start; i < bits.len(); i++) {
+        run = bits.get(i) ? 0 : run + 1;
+        if (run == count)
+            return i + 1 - count;
+    }
+    return NONE;
+}
+
+// The last run of `count` free bits before `end`, one bit at a time.
+static Opt<usize> _naiveFindRev(Bits const &bits, usize count, usize end) {
+    usize run = 0;
+    for (usize i = end; i > 0; i--) {
+        run = bits.get(i - 1) ? 0 : run + 1;
+        if (run == count)
+            return i - 1;
+    }
+    return NONE;
+}
+
+test$("bits-set-get") {
+    for (bool summarized : {false, true}) {
+        _TestBits t{33, summarized};
+        auto &bits = *t.bits;
+        expectEq$(bits.len(), 264uz);
+
+        bits.set({3, 200}, true);
+        expect$(not bits.get(2));
+        expect$(bits.get(3));
+        expect$(bits.get(202));
+        expect$(not bits.get(203));
+        expectEq$(bits.used(), 200uz);
+
+        bits.set(100, false);
+        expectEq$(bits.used(), 199uz);
+        expectEq$(bits.nextFree(3), 100uz);
+        expectEq$(bits.nextFree(101), 203uz);
+        expectEq$(bits.nextUsed(0, 264), 3uz);
+        expectEq$(bits.prevFree(200), 101uz);
+        expectEq$(bits.prevUsed(264, 0), 203uz);
+
+        bits.fill(true);
+        expectEq$(bits.used(), 264uz);
+        expectEq$(bits.nextFree(0), 264uz);
+    }
+
+    return Ok();
+}
+
+test$("bits-alloc") {
+    for (bool summarized : {false, true}) {
+        _TestBits t{32, summarized};
+        auto &bits = *t.bits;
+
+        bits.set({0, 70}, true);
+        bits.set({75, 10}, true);
+
+        // The hole at 70 is too small
+        auto range = bits.alloc(8, 0, false);
+        expect$(range.has());
+        expectEq$(range->start, 85uz);
+        expectEq$(range->size, 8uz);
+
+        range = bits.alloc(5, 0, false);
+        expectEq$(range->start, 70uz);
+
+        // From the top
+        range = bits.alloc(10, -1, true);
+        expectEq$(range->start, 246uz);
+
+        expect$(not bits.alloc(0, 0, false));
+        expect$(not bits.alloc(1000, 0, false));
+    }
+
+    return Ok();
+}
+
+test$("bits-visit") {
+    for (bool summarized : {false, true}) {
+        _TestBits t{16, summarized};
+        auto &bits = *t.bits;
+        bits.set({10, 20}, true);
+        bits.set({100, 10}, true);
+
+        Vec<BitsRange> ranges;
+        bits.visit([&](BitsRange r) {
+            ranges.pushBack(r);
+        });
+
+        expectEq$(ranges.len(), 3uz);
+        expectEq$(ranges[0], (BitsRange{0, 10}));
+        expectEq$(ranges[1], (BitsRange{30, 70}));
+        expectEq$(ranges[2], (BitsRange{110, 18}));
+    }
+
+    return Ok();
+}
+
+test$("bits-random") {
+    u64 state = 0x2545f4914f6cdd1d;
+
+    // Large enough for the second level of the summary to matter
+    for (usize bytes : {7uz, 61uz, 4099uz, 40000uz}) {
+        for (bool summarized : {false, true}) {
+            _TestBits t{bytes, summarized};
+            auto &bits = *t.bits;
+            bits.fill(true);
+
+            // Long used runs with a few holes
+            for (usize i = 0; i < 64; i++) {
+                usize start = _next(state) % bits.len();
+                usize size = min(_next(state) % 300, bits.len() - start);
+                bits.set({start, size}, false);
+            }
+
+            for (usize i = 0; i < 200; i++) {
+                usize count = 1 + _next(state) % 40;
+                usize start = _next(state) % bits.len();
+                bool upper = _next(state) & 1;
+
+                auto expected = upper
+                                    ? _naiveFindRev(bits, count, start)
+                                    : _naiveFind(bits, count, start);
+                auto got = bits.alloc(count, start, upper);
+
+                expectEq$(got.has(), expected.has());
+                if (got)
+                    expectEq$(got->start, *expected);
+
+                // Give some back so the map doesn't fill up
+                if (got and _next(state) % 3 == 0)
+                    bits.set(*got, false);
+            }
+
+            usize used = 0;
+            for (usize i = 0; i < bits.len(); i++)
+                used += bits.get(i);
+            expectEq$(bits.used(), used);
+        }
+    }
+
+    return Ok();
+}
+
+} // namespace Karm::Base::Tests
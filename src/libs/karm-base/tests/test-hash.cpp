@@ -0,0 +1,73 @@
+#include <karm-base/hash.h>
+#include <karm-base/string.h>
+#include <karm-base/vec.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Base::Tests {
+
+test$("hash-strings") {
+    expectEq$(hash("hello"s), hash(String{"hello"s}));
+    expectNe$(hash("hello"s), hash("hellp"s));
+    expectNe$(hash(""s), hash("a"s));
+    expectNe$(hash("ab"s), hash("ba"s));
+
+    return Ok();
+}
+
+test$("hash-order") {
+    Vec<int> a = {1, 2, 3};
+    Vec<int> b = {3, 2, 1};
+    expectNe$(hash(a), hash(b));
+    expectNe$(hash(1, 2), hash(2, 1));
+    expectNe$(hashCombine(1, 2), hashCombine(2, 1));
+
+    return Ok();
+}
+
+test$("hash-every-byte") {
+    Array<Byte, 600> buf{};
+    for (usize i = 0; i < buf.len(); i++)
+        buf[i] = i * 7;
+
+    // Flipping any bit of the key must change its hash
+    for (usize len : {1, 3, 4, 8, 16, 17, 48, 49, 100, 256, 257, 300, 600}) {
+        Bytes key = sub(buf, 0, len);
+        Hash h = hash(key);
+        for (usize i = 0; i < len; i++) {
+            buf[i] ^= 1;
+            expectNe$(hash(key), h);
+            buf[i] ^= 1;
+        }
+        expectEq$(hash(key), h);
+    }
+
+    return Ok();
+}
+
+test$("hash-long-simd") {
+    Array<Byte, 3000> buf{};
+    for (usize i = 0; i < buf.len(); i++)
+        buf[i] = (i * 31) ^ (i >> 3);
+
+    for (usize len = _HASH_LONG + 1; len < buf.len(); len += 37)
+        expectEq$(_hashLongSimd(buf.buf(), len, 42), _hashLong(buf.buf(), len, 42));
+
+    return Ok();
+}
+
+test$("hash-constexpr") {
+    static constexpr Hash SHORT = hash("font-family"s);
+    expectEq$(SHORT, hash("font-family"s));
+
+    static constexpr Str LONG =
+        "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+        "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+        "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+        "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate."s;
+    static constexpr Hash LONG_HASH = hash(LONG);
+    expectEq$(LONG_HASH, hash(LONG));
+
+    return Ok();
+}
+
+} // namespace Karm::Base::Tests
@@ -0,0 +1,106 @@
+#include <karm-base/map.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Base::Tests {
+
+test$("map-put-get") {
+    Map<int, int> map;
+    expectEq$(map.len(), 0uz);
+    expect$(not map.has(1));
+
+    map.put(1, 10);
+    map.put(2, 20);
+    expectEq$(map.len(), 2uz);
+    expectEq$(map.get(1), 10);
+    expectEq$(map.get(2), 20);
+
+    map.put(1, 11);
+    expectEq$(map.len(), 2uz);
+    expectEq$(map.get(1), 11);
+    expectEq$(map.tryGet(3), NONE);
+
+    return Ok();
+}
+
+test$("map-del-take") {
+    Map<int, int> map;
+    map.put(1, 10);
+    map.put(2, 20);
+
+    expect$(map.del(1));
+    expect$(not map.del(1));
+    expect$(not map.has(1));
+    expectEq$(map.take(2), 20);
+    expectEq$(map.len(), 0uz);
+
+    return Ok();
+}
+
+test$("map-grow") {
+    Map<usize, usize> map;
+    for (usize i = 0; i < 10000; i++)
+        map.put(i, i * 2);
+
+    expectEq$(map.len(), 10000uz);
+    for (usize i = 0; i < 10000; i++)
+        expectEq$(map.get(i), i * 2);
+
+    usize sum = 0;
+    for (auto const &[k, v] : map.iter())
+        sum += v - k;
+    expectEq$(sum, 9999uz * 10000 / 2);
+
+    return Ok();
+}
+
+test$("map-reuse-deleted") {
+    Map<usize, usize> map;
+    for (usize round = 0; round < 100; round++) {
+        for (usize i = 0; i < 64; i++)
+            map.put(round * 64 + i, i);
+        for (usize i = 0; i < 64; i++)
+            expect$(map.del(round * 64 + i));
+    }
+
+    expectEq$(map.len(), 0uz);
+    expectLteq$(map._table._cap, 256uz);
+
+    return Ok();
+}
+
+test$("map-string-keys") {
+    Map<String, int> map;
+    map.put("foo"s, 1);
+    map.put("bar"s, 2);
+
+    expectEq$(map.get("foo"s), 1);
+    expectEq$(map.get("bar"s), 2);
+    expect$(not map.has("baz"s));
+
+    return Ok();
+}
+
+test$("ordered-map-order") {
+    OrderedMap<int, int> map;
+    map.put(3, 30);
+    map.put(1, 10);
+    map.put(2, 20);
+    map.put(1, 11);
+
+    Vec<int> keys;
+    for (auto const &[k, v] : map.iter())
+        keys.pushBack(k);
+    expectEq$(keys.len(), 3uz);
+    expectEq$(keys[0], 3);
+    expectEq$(keys[1], 1);
+    expectEq$(keys[2], 2);
+
+    expect$(map.del(3));
+    expectEq$(map.at(0), 11);
+    expectEq$(map.get(2), 20);
+    expect$(not map.has(3));
+
+    return Ok();
+}
+
+} // namespace Karm::Base::Tests
@@ -0,0 +1,45 @@
+#include <karm-base/phf.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Base::Tests {
+
+static constexpr PerfectMap COLORS = Array{
+    Cons<Str, int>{"red", 1},
+    Cons<Str, int>{"green", 2},
+    Cons<Str, int>{"blue", 3},
+    Cons<Str, int>{"cyan", 4},
+    Cons<Str, int>{"magenta", 5},
+    Cons<Str, int>{"yellow", 6},
+    Cons<Str, int>{"black", 7},
+    Cons<Str, int>{"white", 8},
+};
+
+static_assert(COLORS.get("magenta") == 5);
+static_assert(not COLORS.has("purple"));
+
+test$("phf-get") {
+    expectEq$(COLORS.len(), 8uz);
+    for (auto const &[name, value] : COLORS._entries)
+        expectEq$(COLORS.get(name), value);
+    return Ok();
+}
+
+test$("phf-miss") {
+    expect$(not COLORS.has(""));
+    expect$(not COLORS.has("re"));
+    expect$(not COLORS.has("reds"));
+    expect$(not COLORS.has("Red"));
+    expect$(not COLORS.has("purple"));
+    return Ok();
+}
+
+test$("phf-single") {
+    static constexpr PerfectMap ONE = Array{
+        Cons<Str, bool>{"one", true},
+    };
+    expect$(ONE.has("one"));
+    expect$(not ONE.has("two"));
+    return Ok();
+}
+
+} // namespace Karm::Base::Tests
@@ -9,6 +9,38 @@ test$("strong-rc") {
     };
 
     auto s = makeStrong<S>();
+    expectEq$(s.strong(), 1uz);
+
+    {
+        auto copy = s;
+        expectEq$(s.strong(), 2uz);
+    }
+
+    expectEq$(s.strong(), 1uz);
+
+    return Ok();
+}
+
+test$("weak-rc") {
+    struct S {
+        int x = 0;
+    };
+
+    auto s = makeStrong<S>();
+    Weak<S> w = s;
+    expectEq$(s.weak(), 1uz);
+
+    {
+        auto up = w.upgrade();
+        expect$(up.has());
+        expectEq$(s.strong(), 2uz);
+    }
+
+    expectEq$(s.strong(), 1uz);
+
+    Opt<Strong<S>> opt = std::move(s);
+    opt = NONE;
+    expect$(not w.upgrade().has());
 
     return Ok();
 }
@@ -0,0 +1,110 @@
+#include <karm-base/mpmc.h>
+#include <karm-base/ring.h>
+#include <karm-base/spsc.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Base::Tests {
+
+test$("ring-push-pop") {
+    Ring<int> ring{4};
+    ring.pushBack(1);
+    ring.pushBack(2);
+    ring.pushBack(3);
+
+    expectEq$(ring.popFront(), 1);
+    expectEq$(ring.popBack(), 3);
+    expectEq$(ring.len(), 1uz);
+
+    // Wrap around
+    ring.pushBack(4);
+    ring.pushBack(5);
+    ring.pushBack(6);
+    expectEq$(ring.rem(), 0uz);
+    expectEq$(ring.popBack(), 6);
+    expectEq$(ring.popFront(), 2);
+    expectEq$(ring.popFront(), 4);
+    expectEq$(ring.popFront(), 5);
+
+    return Ok();
+}
+
+test$("ring-ensure") {
+    Ring<int> ring{3};
+    ring.pushBack(1);
+    ring.pushBack(2);
+    ring.popFront();
+    ring.pushBack(3);
+    ring.pushBack(4);
+
+    ring.ensure(8);
+    expectEq$(ring.cap(), 8uz);
+    ring.pushBack(5);
+
+    for (int i = 2; i <= 5; i++)
+        expectEq$(ring.popFront(), i);
+
+    return Ok();
+}
+
+test$("spsc-push-pop") {
+    Spsc<int> q{3};
+    expectEq$(q.cap(), 4uz);
+    expect$(q.empty());
+
+    for (int i = 0; i < 4; i++)
+        expect$(q.tryPush(i));
+    expect$(not q.tryPush(4));
+    expectEq$(q.len(), 4uz);
+
+    for (int i = 0; i < 4; i++)
+        expectEq$(q.tryPop(), i);
+    expectEq$(q.tryPop(), NONE);
+
+    return Ok();
+}
+
+test$("spsc-dtor") {
+    Spsc<String> q{4};
+    q.tryPush("hello"s);
+    q.tryPush("world"s);
+    expectEq$(q.tryPop(), "hello"s);
+    return Ok();
+}
+
+test$("mpmc-push-pop") {
+    Mpmc<int> q{4};
+    for (int i = 0; i < 4; i++)
+        expect$(q.tryPush(i));
+    expect$(not q.tryPush(4));
+
+    for (int i = 0; i < 4; i++)
+        expectEq$(q.tryPop(), i);
+    expectEq$(q.tryPop(), NONE);
+
+    // Again, on the next lap
+    expect$(q.tryPush(42));
+    expectEq$(q.tryPop(), 42);
+
+    return Ok();
+}
+
+test$("mpmc-batch") {
+    Mpmc<int> q{8};
+
+    Array<int, 6> in = {1, 2, 3, 4, 5, 6};
+    expectEq$(q.tryPushMany(in), 6uz);
+    expectEq$(q.tryPushMany(in), 2uz);
+
+    Array<int, 5> out{};
+    expectEq$(q.tryPopMany(out), 5uz);
+    expectEq$(out, (Array<int, 5>{1, 2, 3, 4, 5}));
+    expectEq$(q.tryPopMany(out), 3uz);
+    expectEq$(out[0], 6);
+    expectEq$(out[1], 1);
+    expectEq$(out[2], 2);
+    expectEq$(q.tryPopMany(out), 0uz);
+
+    return Ok();
+}
+
+} // namespace Karm::Base::Tests
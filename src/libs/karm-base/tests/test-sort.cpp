@@ -1,4 +1,5 @@
 #include <karm-base/array.h>
+#include <karm-base/vec.h>
 #include <karm-test/macros.h>
 
 namespace Karm::Base {
@@ -66,4 +67,134 @@ test$("stable-sort-small") {
     return Ok();
 }
 
+static u64 _next(u64 &state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Inputs known to be hard on quicksorts.
+static Vec<Vec<isize>> _patterns(usize len) {
+    Vec<Vec<isize>> res;
+    u64 state = 0x2545f4914f6cdd1d;
+
+    Vec<isize> random, few, sorted, reversed, pipe, equal, sawtooth;
+    for (usize i = 0; i < len; i++) {
+        random.pushBack(_next(state) % 1000000);
+        few.pushBack(_next(state) % 4);
+        sorted.pushBack(i);
+        reversed.pushBack(len - i);
+        pipe.pushBack(i < len / 2 ? i : len - i);
+        equal.pushBack(42);
+        sawtooth.pushBack(i % 16);
+    }
+
+    res.pushBack(random);
+    res.pushBack(few);
+    res.pushBack(sorted);
+    res.pushBack(reversed);
+    res.pushBack(pipe);
+    res.pushBack(equal);
+    res.pushBack(sawtooth);
+    return res;
+}
+
+static bool _isSorted(Vec<isize> const &v) {
+    for (usize i = 1; i < v.len(); i++)
+        if (v[i - 1] > v[i])
+            return false;
+    return true;
+}
+
+static isize _sum(Vec<isize> const &v) {
+    isize sum = 0;
+    for (auto i : v)
+        sum += i;
+    return sum;
+}
+
+test$("sort-patterns") {
+    for (usize len : {0, 1, 2, 23, 24, 129, 1000, 10000}) {
+        for (auto &v : _patterns(len)) {
+            auto sum = _sum(v);
+            sort(v);
+            expect$(_isSorted(v));
+            expectEq$(_sum(v), sum);
+        }
+    }
+
+    return Ok();
+}
+
+test$("sort-cmp") {
+    Vec<isize> v;
+    for (isize i = 0; i < 1000; i++)
+        v.pushBack(i);
+
+    sort(v, [](auto const &a, auto const &b) {
+        return b <=> a;
+    });
+
+    for (isize i = 0; i < 1000; i++)
+        expectEq$(v[i], 999 - i);
+
+    return Ok();
+}
+
+test$("stable-sort-patterns") {
+    for (usize len : {0, 1, 2, 63, 64, 65, 1000, 10000}) {
+        for (auto &p : _patterns(len)) {
+            Vec<Foo> v;
+            for (usize i = 0; i < p.len(); i++)
+                v.pushBack({(isize)i, p[i]});
+
+            stableSort(v);
+
+            for (usize i = 1; i < v.len(); i++) {
+                expect$(v[i - 1].order <= v[i].order);
+                if (v[i - 1].order == v[i].order)
+                    expect$(v[i - 1].value < v[i].value);
+            }
+        }
+    }
+
+    return Ok();
+}
+
+test$("radix-sort") {
+    for (usize len : {0, 1, 63, 64, 1000, 10000}) {
+        for (auto &v : _patterns(len)) {
+            for (auto &i : v)
+                i -= 500000;
+
+            auto sum = _sum(v);
+            radixSort(v);
+            expect$(_isSorted(v));
+            expectEq$(_sum(v), sum);
+        }
+    }
+
+    return Ok();
+}
+
+test$("radix-sort-key") {
+    Vec<Foo> v;
+    u64 state = 0x2545f4914f6cdd1d;
+    for (isize i = 0; i < 1000; i++)
+        v.pushBack({i, (isize)(_next(state) % 16)});
+
+    radixSort(v, [](Foo const &f) {
+        return (u8)f.order;
+    });
+
+    for (usize i = 1; i < v.len(); i++) {
+        expect$(v[i - 1].order <= v[i].order);
+        if (v[i - 1].order == v[i].order)
+            expect$(v[i - 1].value < v[i].value);
+    }
+
+    return Ok();
+}
+
 } // namespace Karm::Base
@@ -26,10 +26,8 @@ test$("string-default-constructed") {
 
     expectEq$(str.len(), 0uz);
     expectEq$(str, ""s);
-    // We have to use _buf here because in the case of a default
-    // constructed String, buf() will lie to us and return ""
-    // but internally it is nullptr and no buffer has been allocated.
-    expectEq$(str._buf, nullptr);
+    // No buffer should have been allocated
+    expect$(not str._onHeap());
 
     return Ok();
 }
@@ -43,4 +41,48 @@ test$("string-value-constructed") {
     return Ok();
 }
 
+test$("string-short-inline") {
+    String str("Hello, World!");
+    expect$(not str._onHeap());
+    expectEq$(str.buf()[str.len()], '\0');
+
+    String max{sub("0123456789012345678901"s, 0, String::_INLINE)};
+    expectEq$(max.len(), String::_INLINE);
+    expect$(not max._onHeap());
+    expectEq$(max.buf()[max.len()], '\0');
+
+    return Ok();
+}
+
+test$("string-long-heap") {
+    String str("The quick brown fox jumps over the lazy dog");
+    expect$(str._onHeap());
+    expectEq$(str, "The quick brown fox jumps over the lazy dog");
+    expectEq$(str.buf()[str.len()], '\0');
+
+    return Ok();
+}
+
+test$("string-copy-move") {
+    for (Str s : {"short"s, "a string long enough to spill over to the heap"s}) {
+        String a{s};
+        String b{a};
+        expectEq$(a, s);
+        expectEq$(b, s);
+
+        String c{std::move(a)};
+        expectEq$(c, s);
+        expectEq$(a.len(), 0uz);
+
+        String d;
+        d = std::move(c);
+        expectEq$(d, s);
+
+        d = b;
+        expectEq$(d, s);
+    }
+
+    return Ok();
+}
+
 } // namespace Karm::Base::Tests
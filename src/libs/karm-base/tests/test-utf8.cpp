@@ -0,0 +1,86 @@
+#include <karm-base/rune.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Base::Tests {
+
+test$("utf8-ascii-len") {
+    expectEq$(Utf8::asciiLen(""s), 0uz);
+    expectEq$(Utf8::asciiLen("hello"s), 5uz);
+    expectEq$(Utf8::asciiLen("hello wörld"s), 7uz);
+
+    // Crosses the 32 and 8 units steps
+    Str long_ = "0123456789abcdef0123456789abcdef0123456789é"s;
+    expectEq$(Utf8::asciiLen(long_), 42uz);
+
+    return Ok();
+}
+
+test$("utf8-validate") {
+    expect$(Utf8::validate(""s));
+    expect$(Utf8::validate("hello"s));
+    expect$(Utf8::validate("héllo wörld ✓ 🦆"s));
+
+    // Lone continuation
+    expect$(not Utf8::validate("\x80"s));
+    // Truncated sequence
+    expect$(not Utf8::validate("ab\xe2\x9c"s));
+    // Overlong encoding of '/'
+    expect$(not Utf8::validate("\xc0\xaf"s));
+    expect$(not Utf8::validate("\xe0\x80\xaf"s));
+    // Surrogate
+    expect$(not Utf8::validate("\xed\xa0\x80"s));
+    // Above U+10FFFF
+    expect$(not Utf8::validate("\xf4\x90\x80\x80"s));
+
+    expectEq$(Utf8::validLen("abc\xffxyz"s), 3uz);
+
+    return Ok();
+}
+
+test$("utf8-decode") {
+    Str str = "aé✓🦆 and some more ascii"s;
+    Cursor<Utf8::Unit> in{str};
+    Array<Rune, 64> runes;
+
+    usize n = Utf8::decode(in, runes);
+    expect$(in.ended());
+    expectEq$(n, 24uz);
+    expectEq$(runes[0], U'a');
+    expectEq$(runes[1], U'é');
+    expectEq$(runes[2], U'✓');
+    expectEq$(runes[3], U'🦆');
+    expectEq$(runes[4], U' ');
+    expectEq$(runes[23], U'i');
+
+    return Ok();
+}
+
+test$("utf8-decode-partial") {
+    Str str = "hello world"s;
+    Cursor<Utf8::Unit> in{str};
+    Array<Rune, 4> runes;
+
+    expectEq$(Utf8::decode(in, runes), 4uz);
+    expectEq$(runes[3], U'l');
+    expectEq$(in.rem(), 7uz);
+
+    return Ok();
+}
+
+test$("utf8-decode-invalid") {
+    // The maximal subpart of an ill-formed sequence becomes a single U+FFFD
+    Str str = "a\xe2\x9c" "b\x80" "c"s;
+    Cursor<Utf8::Unit> in{str};
+    Array<Rune, 8> runes;
+
+    expectEq$(Utf8::decode(in, runes), 5uz);
+    expectEq$(runes[0], U'a');
+    expectEq$(runes[1], REPLACEMENT);
+    expectEq$(runes[2], U'b');
+    expectEq$(runes[3], REPLACEMENT);
+    expectEq$(runes[4], U'c');
+
+    return Ok();
+}
+
+} // namespace Karm::Base::Tests
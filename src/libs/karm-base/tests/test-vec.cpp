@@ -28,4 +28,47 @@ test$("vec-push-front-slice") {
     return Ok();
 }
 
+test$("inline-vec-spill") {
+    InlineVec<String, 2> vec;
+    vec.pushBack("a"s);
+    vec.pushBack("b"s);
+    expect$(not vec._buf.spilled());
+
+    vec.pushBack("c"s);
+    vec.pushFront("z"s);
+    expect$(vec._buf.spilled());
+    expectEq$(vec.len(), 4uz);
+    expectEq$(vec[0], "z"s);
+    expectEq$(vec[3], "c"s);
+
+    vec.removeAt(0);
+    vec.removeAt(0);
+    vec.fit();
+    expect$(not vec._buf.spilled());
+    expectEq$(vec[0], "b"s);
+    expectEq$(vec[1], "c"s);
+
+    return Ok();
+}
+
+test$("inline-vec-copy-move") {
+    for (usize n : {1uz, 8uz}) {
+        InlineVec<String, 4> a;
+        for (usize i = 0; i < n; i++)
+            a.pushBack("item"s);
+
+        InlineVec<String, 4> b = a;
+        InlineVec<String, 4> c = std::move(a);
+        expectEq$(b.len(), n);
+        expectEq$(c.len(), n);
+        expectEq$(a.len(), 0uz);
+
+        a = std::move(c);
+        expectEq$(a.len(), n);
+        expectEq$(a[n - 1], "item"s);
+    }
+
+    return Ok();
+}
+
 } // namespace Karm::Base::Tests
@@ -151,6 +151,10 @@ struct Union {
         return Meta::any<Ts...>(visitor);
     }
 
+    always_inline static auto any(usize index, auto visitor) {
+        return Meta::indexType<Ts...>(index, visitor);
+    }
+
     template <Meta::Contains<Ts...> T>
     always_inline MutCursor<T> is() lifetimebound {
         if (_index != Meta::indexOf<T, Ts...>())
@@ -147,7 +147,9 @@ struct _Vec {
 template <typename T>
 using Vec = _Vec<Buf<T>>;
 
+// A vector that keeps up to N elements inline, it only allocates
+// once it grows past that.
 template <typename T, usize N>
-using InlineVec = _Vec<InlineBuf<T, N>>;
+using InlineVec = _Vec<SmallBuf<T, N>>;
 
 } // namespace Karm
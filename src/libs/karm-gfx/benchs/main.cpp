@@ -1,45 +1,23 @@
 #include <karm-cli/cursor.h>
 #include <karm-gfx/cpu/canvas.h>
+#include <karm-gfx/cpu/tiled.h>
+#include <karm-gfx/shadow.h>
 #include <karm-sys/entry.h>
+#include <karm-sys/thread.h>
 #include <karm-sys/time.h>
 
-Async::Task<> entryPointAsync(Sys::Context &) {
+static constexpr isize SAMPLES = 100;
+
+static void bench(Str name, auto fn) {
     Vec<TimeSpan> samples;
-    auto surface = Gfx::Surface::alloc({1000, 1000});
 
-    for (isize i = 0; i < 100; i++) {
+    for (isize i = 0; i < SAMPLES; i++) {
         auto start = Sys::now();
-        for (isize size = 100; size < 1000; size += 10) {
-            f64 scale = size / 100.0;
-
-            Gfx::CpuCanvas g;
-            g.begin(surface->mutPixels());
-            g.scale(scale);
-
-            for (isize i = 0; i < 50; i++) {
-                Math::Rand rand{};
-
-                f64 s = rand.nextInt(4, 10);
-                s *= s;
-
-                g.beginPath();
-                g.ellipse({
-                    rand.nextVec2(Math::Recti{100, 100}).cast<f64>(),
-                    s,
-                });
-
-                g.strokeStyle(
-                    Gfx::stroke(Gfx::randomColor(rand))
-                        .withWidth(rand.nextInt(2, s))
-                );
-                g.stroke();
-            }
-        }
-
+        fn();
         auto elapsed = Sys::now() - start;
         samples.pushBack(elapsed);
 
-        Sys::print("sampling {}/100: {}\r", i + 1, elapsed);
+        Sys::print("{}: sampling {}/{}: {}\r", name, i + 1, SAMPLES, elapsed);
     }
 
     // median
@@ -53,10 +31,180 @@ Async::Task<> entryPointAsync(Sys::Context &) {
         sum += s.toUSecs();
 
     Sys::println("\n");
-    Sys::println("median: {}", samples[samples.len() / 2]);
-    Sys::println("average: {}", TimeSpan::fromUSecs(sum / samples.len()));
-    Sys::println("min: {}", first(samples));
-    Sys::println("max: {}", last(samples));
+    Sys::println("{}:", name);
+    Sys::println("  median: {}", samples[samples.len() / 2]);
+    Sys::println("  average: {}", TimeSpan::fromUSecs(sum / samples.len()));
+    Sys::println("  min: {}", first(samples));
+    Sys::println("  max: {}", last(samples));
+    Sys::println("");
+}
+
+static void benchStrokes(Gfx::MutPixels pixels) {
+    for (isize size = 100; size < 1000; size += 10) {
+        f64 scale = size / 100.0;
+
+        Gfx::CpuCanvas g;
+        g.begin(pixels);
+        g.scale(scale);
+
+        Math::Rand rand{};
+        for (isize i = 0; i < 50; i++) {
+            f64 s = rand.nextInt(4, 10);
+            s *= s;
+
+            g.beginPath();
+            g.ellipse({
+                rand.nextVec2(Math::Recti{100, 100}).cast<f64>(),
+                s,
+            });
+
+            g.strokeStyle(
+                Gfx::stroke(Gfx::randomColor(rand))
+                    .withWidth(rand.nextInt(2, s))
+            );
+            g.stroke();
+        }
+        g.end();
+    }
+}
+
+// Many small shapes, the cost is dominated by the per-fill setup.
+static void benchManyShapes(Gfx::CpuCanvas &g, Gfx::MutPixels pixels) {
+    g.begin(pixels);
+
+    Math::Rand rand{};
+    for (isize i = 0; i < 10000; i++) {
+        auto pos = rand.nextVec2(Math::Recti{1000, 1000}).cast<f64>();
+        f64 size = rand.nextInt(4, 32);
+
+        g.beginPath();
+        if (i % 2)
+            g.ellipse({pos, size});
+        else
+            g.rect({pos, {size, size}}, size / 4);
+        g.fillStyle(Gfx::randomColor(rand));
+        g.fill(Gfx::FillRule::NONZERO);
+    }
+    g.end();
+}
+
+// A few shapes with a lot of edges, the cost is dominated by the edge list.
+static void benchManyEdges(Gfx::MutPixels pixels) {
+    Gfx::CpuCanvas g;
+    g.begin(pixels);
+
+    Math::Rand rand{};
+    for (isize i = 0; i < 10; i++) {
+        auto center = rand.nextVec2(Math::Recti{250, 250, 500, 500}).cast<f64>();
+
+        g.beginPath();
+        isize n = 2000;
+        for (isize j = 0; j < n; j++) {
+            f64 angle = Math::TAU * j / n;
+            f64 r = j % 2 ? 400 : 150 + rand.nextInt(50);
+            Math::Vec2f p = center + Math::Vec2f{Math::cos(angle), Math::sin(angle)} * r;
+            if (j == 0)
+                g.moveTo(p, Math::Path::DEFAULT);
+            else
+                g.lineTo(p, Math::Path::DEFAULT);
+        }
+        g.closePath();
+        g.fillStyle(Gfx::randomColor(rand).withOpacity(0.5));
+        g.fill(i % 2 ? Gfx::FillRule::EVENODD : Gfx::FillRule::NONZERO);
+    }
+    g.end();
+}
+
+// An image drawn at its own size and scaled up and down.
+static void benchBlit(Gfx::MutPixels pixels, Gfx::Pixels image, Gfx::Sampling sampling) {
+    Gfx::CpuCanvas g;
+    g.begin(pixels);
+    g.blit({0, 0, 1000, 1000}, image, sampling);
+    g.blit({100, 100, 256, 256}, image, sampling);
+    g.blit({0, 0, 2000, 2000}, image, sampling);
+    g.blit({0, 0, 100, 100}, image, sampling);
+    g.end();
+}
+
+static void benchBlitMipmap(Gfx::MutPixels pixels, Gfx::Mipmap const &mipmap) {
+    Gfx::CpuCanvas g;
+    g.begin(pixels);
+    g.blit({0, 0, 1000, 1000}, mipmap);
+    g.blit({100, 100, 256, 256}, mipmap);
+    g.blit({0, 0, 2000, 2000}, mipmap);
+    g.blit({0, 0, 100, 100}, mipmap);
+    g.end();
+}
+
+// A screen full of elevated cards, as drawn by the ui every frame.
+static void benchShadows(Gfx::MutPixels pixels) {
+    Gfx::CpuCanvas g;
+    g.begin(pixels);
+    for (isize y = 0; y < 5; y++) {
+        for (isize x = 0; x < 5; x++) {
+            Gfx::BoxShadow::elevated(16)
+                .paint(g, {x * 200 + 20, y * 200 + 20, 160, 160}, 8);
+        }
+    }
+    g.end();
+}
+
+Async::Task<> entryPointAsync(Sys::Context &) {
+    auto surface = Gfx::Surface::alloc({1000, 1000});
+
+    bench("strokes", [&] {
+        benchStrokes(surface->mutPixels());
+    });
+
+    bench("many-shapes", [&] {
+        Gfx::CpuCanvas g;
+        benchManyShapes(g, surface->mutPixels());
+    });
+
+    // Scaling of the tiled canvas with the number of threads
+    for (usize threads = 1; threads <= Sys::concurrency(); threads *= 2) {
+        bench(Io::format("many-shapes-tiled-{}", threads).unwrap(), [&] {
+            Gfx::CpuTiledCanvas g{threads};
+            benchManyShapes(g, surface->mutPixels());
+        });
+    }
+
+    bench("many-edges", [&] {
+        benchManyEdges(surface->mutPixels());
+    });
+
+    auto image = Gfx::Surface::alloc({1000, 1000});
+    Gfx::CpuCanvas ig;
+    benchManyShapes(ig, image->mutPixels());
+
+    bench("blit-nearest", [&] {
+        benchBlit(surface->mutPixels(), *image, Gfx::Sampling::NEAREST);
+    });
+
+    bench("blit-bilinear", [&] {
+        benchBlit(surface->mutPixels(), *image, Gfx::Sampling::BILINEAR);
+    });
+
+    bench("blit-mipmap", [&] {
+        benchBlit(surface->mutPixels(), *image, Gfx::Sampling::MIPMAP);
+    });
+
+    // Same as above, with the levels built once up front
+    auto mipmap = Gfx::Mipmap::build(image);
+    bench("blit-mipmap-prebuilt", [&] {
+        benchBlitMipmap(surface->mutPixels(), mipmap);
+    });
+
+    bench("box-shadows", [&] {
+        benchShadows(surface->mutPixels());
+    });
+
+    // The cost of a blur shouldn't depend on its radius
+    for (f64 radius : {4, 32, 128}) {
+        bench(Io::format("blur-{}", radius).unwrap(), [&] {
+            Gfx::BlurFilter{radius}.apply(surface->mutPixels());
+        });
+    }
 
     co_return Ok();
 }
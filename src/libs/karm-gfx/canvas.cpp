@@ -2,6 +2,7 @@
 #include <karm-text/run.h>
 
 #include "canvas.h"
+#include "icon.h"
 
 namespace Karm::Gfx {
 
@@ -123,16 +124,35 @@ void Canvas::fill(Text::Font &font, Text::Run const &run, Math::Vec2f baseline)
     pop();
 }
 
+void Canvas::fill(Icon const &icon, Math::Vec2f pos) {
+    push();
+    beginPath();
+    origin(pos);
+    scale(icon._size / icon._icon.width);
+    path(*icon.path());
+    fill();
+    pop();
+}
+
 // MARK: Blit Operations ---------------------------------------------------
 
-void Canvas::blit(Math::Recti dest, Pixels pixels) {
-    blit(pixels.bound(), dest, pixels);
+void Canvas::blit(Math::Recti dest, Pixels pixels, Sampling sampling) {
+    blit(pixels.bound(), dest, pixels, sampling);
 }
 
 void Canvas::blit(Math::Vec2i dest, Pixels pixels) {
     blit(pixels.bound(), Math::Recti(dest, pixels.size()), pixels);
 }
 
+void Canvas::blit(Math::Recti dest, Mipmap const &mipmap) {
+    auto level = mipmap.level(dest.wh);
+    blit(level->bound(), dest, level->pixels(), Sampling::BILINEAR);
+}
+
+bool Canvas::canBlit() const {
+    return false;
+}
+
 // MARK: Filter Operations -------------------------------------------------
 
 void Canvas::apply(Filter filter, Math::Rectf region, Math::Radiif radii) {
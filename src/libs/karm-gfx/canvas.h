@@ -6,11 +6,14 @@
 
 #include "fill.h"
 #include "filters.h"
+#include "mipmap.h"
 #include "stroke.h"
 #include "types.h"
 
 namespace Karm::Gfx {
 
+struct Icon;
+
 struct Canvas : Meta::NoCopy {
     // NOTE: Canvas is marked as NoCopy because it doesn't make sense to copy
     // a canvas. And it's also a good way to prevent accidental copies.
@@ -165,6 +168,9 @@ struct Canvas : Meta::NoCopy {
     // Fill a run of text
     virtual void fill(Text::Font &font, Text::Run const &run, Math::Vec2f baseline);
 
+    // Fill an icon with its top left corner at the given position
+    virtual void fill(Icon const &icon, Math::Vec2f pos);
+
     // MARK: Clear Operations --------------------------------------------------
 
     // Clear all pixels with respect to the current origin and clip.
@@ -188,15 +194,23 @@ struct Canvas : Meta::NoCopy {
 
     // Blit the given pixels to the current pixels
     // using the given source and destination rectangles.
-    virtual void blit(Math::Recti src, Math::Recti dest, Pixels pixels) = 0;
+    virtual void blit(Math::Recti src, Math::Recti dest, Pixels pixels, Sampling sampling = Sampling::NEAREST) = 0;
 
     // Blit the given pixels to the current pixels.
     // The source rectangle is the entire piels.
-    virtual void blit(Math::Recti dest, Pixels pixels);
+    virtual void blit(Math::Recti dest, Pixels pixels, Sampling sampling = Sampling::NEAREST);
 
     // Blit the given pixels to the current pixels at the given position.
     virtual void blit(Math::Vec2i dest, Pixels pixels);
 
+    // Blit an image from the level of its mipmap that is
+    // closest to the destination size, interpolating it.
+    virtual void blit(Math::Recti dest, Mipmap const &mipmap);
+
+    // Whether blits land where the destination rectangle would be filled,
+    // false when the canvas can't blit or the transform rotates or skews.
+    virtual bool canBlit() const;
+
     // MARK: Filter Operations -------------------------------------------------
 
     // Apply a filter on the given region.
@@ -0,0 +1,289 @@
+#include <karm-math/funcs.h>
+
+#include "../mipmap.h"
+#include "blit.h"
+#include "comp.h"
+
+namespace Karm::Gfx {
+
+static bool _isOpaque(u8 const *row, usize len) {
+    u8 acc = 255;
+    for (usize i = 0; i < len; i++)
+        acc &= row[i * 4 + 3];
+    return acc == 255;
+}
+
+// Copy the row if it's opaque, otherwise blend it.
+static void _compositeRow(u8 *dst, u8 const *src, usize len) {
+    if (_isOpaque(src, len))
+        memcpy(dst, src, len * 4);
+    else
+        blendRow(dst, src, len);
+}
+
+// Composite a row of packed colors starting at x through the clip mask.
+static void _composite(u8 *dst, u8 const *src, isize x, isize y, isize len, ClipMask const *mask, Vec<u32> &scratch) {
+    clipSpan(
+        mask, y, x, x + len,
+        [&](isize start, isize end) {
+            isize i = (start - x) * 4;
+            _compositeRow(dst + i, src + i, end - start);
+        },
+        [&](isize start, isize end, u8 const *coverage) {
+            isize i = (start - x) * 4;
+            scratch.resize(end - start);
+            auto *tmp = reinterpret_cast<u8 *>(scratch.buf());
+            memcpy(tmp, src + i, (end - start) * 4);
+            maskRow(tmp, coverage, end - start);
+            blendRow(dst + i, tmp, end - start);
+        }
+    );
+}
+
+// MARK: Unscaled --------------------------------------------------------------
+
+void blitUnscaled(MutPixels dest, Math::Recti destRect, Math::Recti clip, ClipMask const *mask, Pixels src, Math::Vec2i srcOrigin) {
+    auto clipDest = clip.clipTo(destRect);
+    if (clipDest.width <= 0 or clipDest.height <= 0)
+        return;
+
+    auto srcXY = srcOrigin + (clipDest.xy - destRect.xy);
+    usize len = clipDest.width;
+
+    dest.fmt().visit([&](auto df) {
+        src.fmt().visit([&](auto sf) {
+            Vec<u32> span, scratch;
+            if constexpr (not Meta::Same<decltype(df), decltype(sf)>)
+                span.resize(len);
+
+            for (isize y = 0; y < clipDest.height; y++) {
+                auto *d = static_cast<u8 *>(dest.pixelUnsafe({clipDest.x, clipDest.y + y}));
+                auto const *s = static_cast<u8 const *>(src.pixelUnsafe({srcXY.x, srcXY.y + y}));
+
+                if constexpr (not Meta::Same<decltype(df), decltype(sf)>) {
+                    for (usize x = 0; x < len; x++)
+                        span[x] = pack(df, sf.load(s + x * 4));
+                    s = reinterpret_cast<u8 const *>(span.buf());
+                }
+
+                _composite(d, s, clipDest.x, clipDest.y + y, len, mask, scratch);
+            }
+        });
+    });
+}
+
+// MARK: Nearest ---------------------------------------------------------------
+
+void blitNearest(MutPixels dest, Math::Recti destRect, Math::Recti clip, ClipMask const *mask, Pixels src, Math::Rectf srcRect) {
+    auto clipDest = clip.clipTo(destRect);
+    if (clipDest.width <= 0 or clipDest.height <= 0)
+        return;
+
+    auto hratio = srcRect.height / destRect.height;
+    auto wratio = srcRect.width / destRect.width;
+
+    // The source column only depends on the destination column
+    Vec<isize> columns;
+    columns.resize(clipDest.width);
+    for (isize x = 0; x < clipDest.width; x++) {
+        isize xx = clipDest.x - destRect.x + x;
+        columns[x] = srcRect.x + xx * wratio;
+    }
+
+    dest.fmt().visit([&](auto df) {
+        src.fmt().visit([&](auto sf) {
+            Vec<u32> span, scratch;
+            span.resize(clipDest.width);
+
+            for (isize y = 0; y < clipDest.height; y++) {
+                isize yy = clipDest.y - destRect.y + y;
+                isize srcY = srcRect.y + yy * hratio;
+                auto const *s = static_cast<u8 const *>(src.scanline(srcY));
+
+                for (isize x = 0; x < clipDest.width; x++)
+                    span[x] = pack(df, sf.load(s + columns[x] * 4));
+
+                auto *d = static_cast<u8 *>(dest.pixelUnsafe({clipDest.x, clipDest.y + y}));
+                _composite(d, reinterpret_cast<u8 const *>(span.buf()), clipDest.x, clipDest.y + y, clipDest.width, mask, scratch);
+            }
+        });
+    });
+}
+
+// MARK: Bilinear --------------------------------------------------------------
+
+// Weights are in 1/128th so the weighted sum of premultiplied
+// components fits in 32 bits.
+static constexpr u32 ONE = 128;
+
+struct _Tap {
+    isize i0, i1;
+    u32 w1;
+};
+
+// Positions are relative to `lo`, so blitting from a copy of the source
+// rectangle gives the exact same weights as blitting from the original.
+static void _taps(Vec<_Tap> &taps, f64 start, f64 ratio, isize offset, isize len, isize lo, isize hi) {
+    taps.resize(len);
+    for (isize i = 0; i < len; i++) {
+        f64 u = (start - lo) + (offset + i + 0.5) * ratio - 0.5;
+        f64 f = Math::floor(u);
+        isize i0 = lo + (isize)f;
+        taps[i] = {
+            clamp(i0, lo, hi),
+            clamp(i0 + 1, lo, hi),
+            static_cast<u32>(Math::roundi((u - f) * ONE)),
+        };
+    }
+}
+
+// The pixels the rectangle overlaps.
+// NOTE: Not Rect::ceil(), Math::ceil() rounds whole numbers up too.
+static Math::Recti _overlapped(Math::Rectf r) {
+    auto down = [](f64 v) {
+        isize i = v;
+        return i > v ? i - 1 : i;
+    };
+
+    auto up = [](f64 v) {
+        isize i = v;
+        return i < v ? i + 1 : i;
+    };
+
+    return Math::Recti::fromTwoPoint(
+        {down(r.start()), down(r.top())},
+        {up(r.end()), up(r.bottom())}
+    );
+}
+
+// Interpolate between four colors in premultiplied space.
+always_inline static Color _interpolate(Color c00, Color c01, Color c10, Color c11, u32 wx, u32 wy) {
+    u32 w00 = (ONE - wx) * (ONE - wy) * c00.alpha;
+    u32 w01 = wx * (ONE - wy) * c01.alpha;
+    u32 w10 = (ONE - wx) * wy * c10.alpha;
+    u32 w11 = wx * wy * c11.alpha;
+
+    u32 a = w00 + w01 + w10 + w11;
+    if (a == 0)
+        return {};
+
+    auto channel = [&](u8 v00, u8 v01, u8 v10, u8 v11) {
+        return static_cast<u8>((w00 * v00 + w01 * v01 + w10 * v10 + w11 * v11 + a / 2) / a);
+    };
+
+    return {
+        channel(c00.red, c01.red, c10.red, c11.red),
+        channel(c00.green, c01.green, c10.green, c11.green),
+        channel(c00.blue, c01.blue, c10.blue, c11.blue),
+        static_cast<u8>((a + ONE * ONE / 2) / (ONE * ONE)),
+    };
+}
+
+void blitBilinear(MutPixels dest, Math::Recti destRect, Math::Recti clip, ClipMask const *mask, Pixels src, Math::Rectf srcRect) {
+    auto clipDest = clip.clipTo(destRect);
+    if (clipDest.width <= 0 or clipDest.height <= 0)
+        return;
+
+    // Don't bleed pixels from outside of the source rectangle
+    auto bound = _overlapped(srcRect).clipTo(src.bound());
+    if (bound.width <= 0 or bound.height <= 0)
+        return;
+
+    Vec<_Tap> columns, rows;
+    _taps(columns, srcRect.x, srcRect.width / destRect.width, clipDest.x - destRect.x, clipDest.width, bound.start(), bound.end() - 1);
+    _taps(rows, srcRect.y, srcRect.height / destRect.height, clipDest.y - destRect.y, clipDest.height, bound.top(), bound.bottom() - 1);
+
+    dest.fmt().visit([&](auto df) {
+        src.fmt().visit([&](auto sf) {
+            Vec<u32> span, scratch;
+            span.resize(clipDest.width);
+
+            for (isize y = 0; y < clipDest.height; y++) {
+                auto row = rows[y];
+                auto const *s0 = static_cast<u8 const *>(src.scanline(row.i0));
+                auto const *s1 = static_cast<u8 const *>(src.scanline(row.i1));
+
+                for (isize x = 0; x < clipDest.width; x++) {
+                    auto col = columns[x];
+                    auto c = _interpolate(
+                        sf.load(s0 + col.i0 * 4), sf.load(s0 + col.i1 * 4),
+                        sf.load(s1 + col.i0 * 4), sf.load(s1 + col.i1 * 4),
+                        col.w1, row.w1
+                    );
+                    span[x] = pack(df, c);
+                }
+
+                auto *d = static_cast<u8 *>(dest.pixelUnsafe({clipDest.x, clipDest.y + y}));
+                _composite(d, reinterpret_cast<u8 const *>(span.buf()), clipDest.x, clipDest.y + y, clipDest.width, mask, scratch);
+            }
+        });
+    });
+}
+
+// MARK: Mipmap ----------------------------------------------------------------
+
+Opt<MipLevel> mipmap(Pixels src, Math::Recti srcRect, Math::Vec2i destSize) {
+    srcRect = srcRect.clipTo(src.bound());
+    if (srcRect.width <= 0 or srcRect.height <= 0 or destSize.x <= 0 or destSize.y <= 0)
+        return NONE;
+
+    f64 scale = min(
+        srcRect.width / (f64)destSize.x,
+        srcRect.height / (f64)destSize.y
+    );
+
+    usize levels = 0;
+    while ((f64)(2 << levels) <= scale)
+        levels++;
+
+    if (levels == 0)
+        return NONE;
+
+    Opt<Strong<Surface>> level = NONE;
+    Pixels from = src.clip(srcRect);
+    for (usize i = 0; i < levels; i++) {
+        auto to = Surface::alloc({
+            (from.width() + 1) / 2,
+            (from.height() + 1) / 2,
+        });
+        downsample(from, *to);
+        from = to->pixels();
+        level = std::move(to);
+    }
+
+    f64 factor = 1 << levels;
+    return MipLevel{
+        level.take(),
+        {0, 0, srcRect.width / factor, srcRect.height / factor},
+    };
+}
+
+// MARK: Dispatch --------------------------------------------------------------
+
+void blitImage(MutPixels dest, Math::Recti destRect, Math::Recti clip, ClipMask const *mask, Pixels src, Math::Rectf srcRect, Sampling sampling) {
+    bool unscaled =
+        srcRect.width == destRect.width and
+        srcRect.height == destRect.height and
+        srcRect.x == Math::floor(srcRect.x) and
+        srcRect.y == Math::floor(srcRect.y);
+
+    if (unscaled)
+        blitUnscaled(dest, destRect, clip, mask, src, srcRect.xy.cast<isize>());
+    else if (sampling == Sampling::NEAREST)
+        blitNearest(dest, destRect, clip, mask, src, srcRect);
+    else
+        blitBilinear(dest, destRect, clip, mask, src, srcRect);
+}
+
+void blitImage(MutPixels dest, Math::Recti destRect, Math::Recti clip, ClipMask const *mask, Pixels src, Math::Recti srcRect, Sampling sampling) {
+    if (sampling == Sampling::MIPMAP) {
+        if (auto level = mipmap(src, srcRect, destRect.wh)) {
+            blitImage(dest, destRect, clip, mask, level->surface->pixels(), level->rect, Sampling::BILINEAR);
+            return;
+        }
+    }
+
+    blitImage(dest, destRect, clip, mask, src, srcRect.cast<f64>(), sampling);
+}
+
+} // namespace Karm::Gfx
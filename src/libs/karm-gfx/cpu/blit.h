@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../buffer.h"
+#include "../types.h"
+#include "clip.h"
+
+// Image blitting kernels.
+//
+// They composite the pixels of `srcRect` over `destRect`, scaling them as
+// needed, and only touch the pixels of `destRect` that are inside `clip`
+// and the clip mask, if any.
+// Which pixels get touched and how they are sampled only depends on the two
+// rectangles, never on the clip.
+
+namespace Karm::Gfx {
+
+// Copy or blend pixels one to one, `srcRect` and `destRect` must have the
+// same size.
+void blitUnscaled(MutPixels dest, Math::Recti destRect, Math::Recti clip, ClipMask const *mask, Pixels src, Math::Vec2i srcOrigin);
+
+// Sample the nearest source pixel.
+void blitNearest(MutPixels dest, Math::Recti destRect, Math::Recti clip, ClipMask const *mask, Pixels src, Math::Rectf srcRect);
+
+// Interpolate between the four nearest source pixels.
+void blitBilinear(MutPixels dest, Math::Recti destRect, Math::Recti clip, ClipMask const *mask, Pixels src, Math::Rectf srcRect);
+
+struct MipLevel {
+    Strong<Surface> surface;
+    Math::Rectf rect; // The source rectangle, in the level coordinates
+};
+
+// Box-filter the source rectangle down by powers of two, as long as it stays
+// at least as big as the destination, NONE if it isn't downscaled.
+Opt<MipLevel> mipmap(Pixels src, Math::Recti srcRect, Math::Vec2i destSize);
+
+// Blit with the fastest kernel for the given sampling.
+// NOTE: Mipmaps must be built beforehand, MIPMAP is the same as BILINEAR here.
+void blitImage(MutPixels dest, Math::Recti destRect, Math::Recti clip, ClipMask const *mask, Pixels src, Math::Rectf srcRect, Sampling sampling);
+
+// Blit with the fastest kernel for the given sampling.
+void blitImage(MutPixels dest, Math::Recti destRect, Math::Recti clip, ClipMask const *mask, Pixels src, Math::Recti srcRect, Sampling sampling);
+
+} // namespace Karm::Gfx
@@ -40,6 +40,11 @@ CpuCanvas::Scope const &CpuCanvas::current() const {
     return last(_stack);
 }
 
+ClipMask const *CpuCanvas::_mask() const {
+    auto const &mask = current().mask;
+    return mask ? &mask->unwrap() : nullptr;
+}
+
 // MARK: Context Operations ----------------------------------------------------
 
 void CpuCanvas::push() {
@@ -72,14 +77,52 @@ void CpuCanvas::transform(Math::Trans2f trans) {
 // MARK: Path Operations -------------------------------------------------------
 
 void CpuCanvas::_fillImpl(auto fill, auto format, FillRule fillRule) {
-    _rast.fill(_poly, current().clip, fillRule, [&](CpuRast::Frag frag) {
-        auto pixels = mutPixels();
-        auto *pixel = pixels.pixelUnsafe(frag.xy);
-        auto color = fill.sample(frag.uv);
-        auto c = format.load(pixel);
-        c = color.withOpacity(frag.a).blendOver(c);
-        format.store(pixel, c);
-    });
+    auto pixels = mutPixels();
+    auto const *mask = _mask();
+
+    if constexpr (Meta::Same<decltype(fill), Color>) {
+        auto px = pack(format, fill);
+        _rast.rasterize(_poly, current().clip, fillRule, [&](CpuRast::Span span) {
+            u8 alpha = fill.withOpacity(span.a).alpha;
+            clipSpan(
+                mask, span.y, span.start, span.end,
+                [&](isize start, isize end) {
+                    auto *dst = static_cast<u8 *>(pixels.pixelUnsafe({start, span.y}));
+                    blendRowSolid(dst, px, alpha, end - start);
+                },
+                [&](isize start, isize end, u8 const *coverage) {
+                    auto *dst = static_cast<u8 *>(pixels.pixelUnsafe({start, span.y}));
+                    blendRowSolidMasked(dst, px, alpha, coverage, end - start);
+                }
+            );
+        });
+    } else {
+        auto bound = _poly.bound();
+        auto sample = [&](isize start, isize end, isize y, f64 a) {
+            _span.resize(end - start);
+            for (isize x = start; x < end; x++) {
+                auto color = fill.sample(CpuRast::uv(bound, {x, y}));
+                _span[x - start] = pack(format, color.withOpacity(a));
+            }
+            return reinterpret_cast<u8 *>(_span.buf());
+        };
+
+        _rast.rasterize(_poly, current().clip, fillRule, [&](CpuRast::Span span) {
+            clipSpan(
+                mask, span.y, span.start, span.end,
+                [&](isize start, isize end) {
+                    auto *dst = static_cast<u8 *>(pixels.pixelUnsafe({start, span.y}));
+                    blendRow(dst, sample(start, end, span.y, span.a), end - start);
+                },
+                [&](isize start, isize end, u8 const *coverage) {
+                    auto *dst = static_cast<u8 *>(pixels.pixelUnsafe({start, span.y}));
+                    auto *src = sample(start, end, span.y, span.a);
+                    maskRow(src, coverage, end - start);
+                    blendRow(dst, src, end - start);
+                }
+            );
+        });
+    }
 }
 
 void CpuCanvas::_FillSmoothImpl(auto fill, auto format, FillRule fillRule) {
@@ -89,6 +132,9 @@ void CpuCanvas::_FillSmoothImpl(auto fill, auto format, FillRule fillRule) {
         last = pos;
 
         _rast.fill(_poly, current().clip, fillRule, [&](CpuRast::Frag frag) {
+            if (auto const *mask = _mask())
+                frag.a *= mask->sample(frag.xy) / 255.0;
+
             u8 *pixel = static_cast<u8 *>(mutPixels().pixelUnsafe(frag.xy));
             auto color = fill.sample(frag.uv);
             auto c = format.load(pixel);
@@ -102,17 +148,6 @@ void CpuCanvas::_FillSmoothImpl(auto fill, auto format, FillRule fillRule) {
     fillComponent(Color::BLUE_COMPONENT, _lcdLayout.blue);
 }
 
-void CpuCanvas::_fill(Fill fill, FillRule fillRule) {
-    fill.visit([&](auto fill) {
-        pixels().fmt().visit([&](auto format) {
-            if (_useSpaa)
-                _FillSmoothImpl(fill, format, fillRule);
-            else
-                _fillImpl(fill, format, fillRule);
-        });
-    });
-}
-
 void CpuCanvas::beginPath() {
     _path.clear();
 }
@@ -183,34 +218,48 @@ void CpuCanvas::stroke() {
     _fill(current().stroke.fill);
 }
 
-void CpuCanvas::clip(FillRule) {
-    notImplemented();
-}
+void CpuCanvas::_clipMask(FillRule rule) {
+    auto &scope = current();
+    auto const *parent = _mask();
 
-// MARK: Shape Operations ------------------------------------------------------
+    auto bound = _poly.bound().ceil().cast<isize>().clipTo(scope.clip);
+    if (bound.width <= 0 or bound.height <= 0) {
+        scope.clip = {};
+        scope.mask = NONE;
+        return;
+    }
 
-[[gnu::flatten]] void CpuCanvas::_fillRect(Math::Recti r, Gfx::Color color) {
-    // FIXME: Properly handle offaxis rectangles
-    r = current().trans.apply(r.cast<f64>()).bound().cast<isize>();
+    auto mask = makeStrong<ClipMask>(bound);
+    _rast.rasterize(_poly, bound, rule, [&](CpuRast::Span span) {
+        u8 a = Math::roundi(span.a * 255);
+        auto *dst = mask->at({span.start, span.y});
+
+        // The parent mask covers at least the parent clip,
+        // which contains the new one.
+        if (parent) {
+            auto const *src = parent->at({span.start, span.y});
+            for (isize i = 0; i < span.len(); i++)
+                dst[i] = mul255(a, src[i]);
+        } else {
+            for (isize i = 0; i < span.len(); i++)
+                dst[i] = a;
+        }
+    });
+    mask->computeRows();
 
-    r = current().clip.clipTo(r);
+    scope.clip = bound;
+    scope.mask = mask;
+}
 
-    if (color.alpha == 255) {
-        mutPixels()
-            .clip(r)
-            .clear(color);
-    } else {
-        pixels().fmt().visit([&](auto f) {
-            for (isize y = r.y; y < r.y + r.height; ++y) {
-                for (isize x = r.x; x < r.x + r.width; ++x) {
-                    auto blended = color.blendOver(f.load(mutPixels().pixelUnsafe({x, y})));
-                    f.store(mutPixels().pixelUnsafe({x, y}), blended);
-                }
-            }
-        });
-    }
+void CpuCanvas::clip(FillRule rule) {
+    _poly.clear();
+    createSolid(_poly, _path);
+    _poly.transform(current().trans);
+    _clipMask(rule);
 }
 
+// MARK: Shape Operations ------------------------------------------------------
+
 void CpuCanvas::fill(Math::Recti r, Math::Radiif radii) {
     beginPath();
     rect(r.cast<f64>(), radii);
@@ -228,8 +277,16 @@ void CpuCanvas::fill(Math::Recti r, Math::Radiif radii) {
 }
 
 void CpuCanvas::clip(Math::Rectf rect) {
-    // FIXME: Properly handle offaxis rectangles
-    rect = current().trans.apply(rect.cast<f64>()).bound();
+    auto const &trans = current().trans;
+
+    // Rotated and skewed rectangles need a mask,
+    // everything else only narrows the clip rect.
+    if (trans.xy != 0 or trans.yx != 0) {
+        Canvas::clip(rect);
+        return;
+    }
+
+    rect = trans.apply(rect.cast<f64>()).bound();
 
     current().clip = rect.cast<isize>().clipTo(current().clip);
 }
@@ -248,10 +305,184 @@ void CpuCanvas::fill(Math::Path const &path, FillRule rule) {
     _fill(current().fill, rule);
 }
 
+GlyphMask CpuCanvas::_renderMask(Opt<LcdLayout> lcd) {
+    if (_poly.len() == 0)
+        return {NONE, {}, {}, 0, {}};
+
+    // Leave room for the sub-pixel offsets
+    auto bound = _poly.bound().grow(1).ceil().cast<isize>();
+    usize channels = lcd ? 3 : 1;
+    auto coverage = Buf<u8>::init(bound.width * bound.height * channels);
+
+    _poly.offset(-bound.xy.cast<f64>());
+
+    auto rasterize = [&](usize channel, Math::Vec2f offset) {
+        _poly.offset(offset);
+        _rast.rasterize(_poly, {bound.wh}, FillRule::NONZERO, [&](CpuRast::Span span) {
+            u8 a = Math::roundi(span.a * 255);
+            for (isize x = span.start; x < span.end; x++)
+                coverage[(span.y * bound.width + x) * channels + channel] = a;
+        });
+        _poly.offset(-offset);
+    };
+
+    if (lcd) {
+        rasterize(0, lcd->red);
+        rasterize(1, lcd->green);
+        rasterize(2, lcd->blue);
+    } else {
+        rasterize(0, {});
+    }
+
+    return {NONE, bound.xy, bound.wh, channels, std::move(coverage)};
+}
+
+GlyphMask CpuCanvas::_renderGlyph(Text::Font &font, Text::Glyph glyph, GlyphKey const &key) {
+    push();
+    current().trans = Math::Trans2f::IDENTITY;
+    translate({key.subpixel / (f64)GlyphCache::SUBPIXELS, 0});
+    scale(key.size);
+    beginPath();
+    font.fontface->contour(*this, glyph);
+    _poly.clear();
+    createSolid(_poly, _path);
+    _poly.transform(current().trans);
+    pop();
+
+    auto mask = _renderMask(key.spaa ? Opt<LcdLayout>{key.lcd} : NONE);
+    mask.face = font.fontface;
+    return mask;
+}
+
+[[gnu::flatten]] void CpuCanvas::_blitGlyph(GlyphMask const &mask, Math::Vec2i pen, Color color, auto format) {
+    auto dest = mask.bound().offset(pen);
+    auto clipDest = current().clip.clipTo(dest);
+    auto pixels = mutPixels();
+    auto const *clipMask = _mask();
+
+    for (isize y = clipDest.y; y < clipDest.bottom(); y++) {
+        auto const *src = mask.row(y - dest.y) + (clipDest.x - dest.x) * mask.channels;
+        auto *dst = static_cast<u8 *>(pixels.pixelUnsafe({clipDest.x, y}));
+
+        if (mask.channels == 3) {
+            for (isize x = 0; x < clipDest.width; x++, src += 3, dst += format.bpp()) {
+                if (not(src[0] | src[1] | src[2]))
+                    continue;
+
+                f64 clip = clipMask ? clipMask->sample({clipDest.x + x, y}) / 255.0 : 1.0;
+                if (clip == 0)
+                    continue;
+
+                auto c = format.load(dst);
+                c = color.withOpacity(src[0] / 255.0 * clip).blendOverComponent(c, Color::RED_COMPONENT);
+                c = color.withOpacity(src[1] / 255.0 * clip).blendOverComponent(c, Color::GREEN_COMPONENT);
+                c = color.withOpacity(src[2] / 255.0 * clip).blendOverComponent(c, Color::BLUE_COMPONENT);
+                format.store(dst, c);
+            }
+        } else {
+            _span.resize(clipDest.width);
+            for (isize x = 0; x < clipDest.width; x++)
+                _span[x] = pack(format, color.withOpacity(src[x] / 255.0));
+
+            auto *span = reinterpret_cast<u8 *>(_span.buf());
+            clipSpan(
+                clipMask, y, clipDest.x, clipDest.end(),
+                [&](isize start, isize end) {
+                    isize i = (start - clipDest.x) * 4;
+                    blendRow(dst + i, span + i, end - start);
+                },
+                [&](isize start, isize end, u8 const *coverage) {
+                    isize i = (start - clipDest.x) * 4;
+                    maskRow(span + i, coverage, end - start);
+                    blendRow(dst + i, span + i, end - start);
+                }
+            );
+        }
+    }
+}
+
 void CpuCanvas::fill(Text::Font &font, Text::Glyph glyph, Math::Vec2f baseline) {
-    _useSpaa = true;
-    Canvas::fill(font, glyph, baseline);
-    _useSpaa = false;
+    auto const &trans = current().trans;
+
+    // Glyphs are cached as coverage masks, this only works
+    // for transforms that don't rotate or skew them.
+    bool isSuitableForCache =
+        current().fill.is<Color>() and
+        trans.xy == 0 and trans.yx == 0 and
+        trans.xx == trans.yy and trans.xx > 0;
+
+    if (not isSuitableForCache) {
+        _useSpaa = true;
+        Canvas::fill(font, glyph, baseline);
+        _useSpaa = false;
+        return;
+    }
+
+    auto pen = trans.apply(baseline);
+    auto penX = Math::floor(pen.x);
+
+    GlyphKey key = {
+        .face = &font.fontface.unwrap(),
+        .glyph = glyph,
+        .size = font.fontsize * trans.xx,
+        .subpixel = static_cast<u8>((pen.x - penX) * GlyphCache::SUBPIXELS),
+        .spaa = true,
+        .lcd = _lcdLayout,
+    };
+
+    auto mask = glyphCache().access(key, [&] {
+        return _renderGlyph(font, glyph, key);
+    });
+
+    _fillGlyph(mask, {(isize)penX, Math::roundi(pen.y)}, current().fill.unwrap<Color>());
+}
+
+GlyphMask CpuCanvas::_renderIcon(Icon const &icon, IconKey const &key) {
+    push();
+    current().trans = Math::Trans2f::IDENTITY;
+    translate({
+        key.subpixelX / (f64)IconCache::SUBPIXELS,
+        key.subpixelY / (f64)IconCache::SUBPIXELS,
+    });
+    scale(key.size / icon._icon.width);
+    _poly.clear();
+    createSolid(_poly, *icon.path());
+    _poly.transform(current().trans);
+    pop();
+
+    return _renderMask(NONE);
+}
+
+void CpuCanvas::fill(Icon const &icon, Math::Vec2f pos) {
+    auto const &trans = current().trans;
+
+    // Same as glyphs, icons are cached as coverage masks
+    bool isSuitableForCache =
+        current().fill.is<Color>() and
+        trans.xy == 0 and trans.yx == 0 and
+        trans.xx == trans.yy and trans.xx > 0;
+
+    if (not isSuitableForCache) {
+        Canvas::fill(icon, pos);
+        return;
+    }
+
+    auto origin = trans.apply(pos);
+    auto originX = Math::floor(origin.x);
+    auto originY = Math::floor(origin.y);
+
+    IconKey key = {
+        .path = icon._icon.path,
+        .size = icon._size * trans.xx,
+        .subpixelX = static_cast<u8>((origin.x - originX) * IconCache::SUBPIXELS),
+        .subpixelY = static_cast<u8>((origin.y - originY) * IconCache::SUBPIXELS),
+    };
+
+    auto mask = iconCache().access(key, [&] {
+        return _renderIcon(icon, key);
+    });
+
+    _fillGlyph(mask, {(isize)originX, (isize)originY}, current().fill.unwrap<Color>());
 }
 
 // MARK: Clear Operations ------------------------------------------------------
@@ -263,20 +494,14 @@ void CpuCanvas::clear(Color color) {
 void CpuCanvas::clear(Math::Recti rect, Color color) {
     // FIXME: Properly handle offaxis rectangles
     rect = current().trans.apply(rect.cast<f64>()).bound().cast<isize>();
-
-    rect = current().clip.clipTo(rect);
-    mutPixels()
-        .clip(rect)
-        .clear(color);
+    _clear(rect, color);
 }
 
 // MARK: Plot Operations ---------------------------------------------------
 
 void CpuCanvas::plot(Math::Vec2i point, Color color) {
     point = current().trans.apply(point.cast<f64>()).cast<isize>();
-    if (current().clip.contains(point)) {
-        mutPixels().blend(point, color);
-    }
+    _plot(point, color);
 }
 
 void CpuCanvas::plot(Math::Edgei edge, Color color) {
@@ -314,61 +539,166 @@ void CpuCanvas::plot(Math::Recti rect, Color color) {
 
 // MARK: Blit Operations -------------------------------------------------------
 
-[[gnu::flatten]] void CpuCanvas::_blit(
-    Pixels src, Math::Recti srcRect, auto srcFmt,
-    MutPixels dest, Math::Recti destRect, auto destFmt
-) {
+void CpuCanvas::blit(Math::Recti src, Math::Recti dest, Pixels p, Sampling sampling) {
     // FIXME: Properly handle offaxis rectangles
-    destRect = current().trans.apply(destRect.cast<f64>()).bound().cast<isize>();
+    dest = current().trans.apply(dest.cast<f64>()).bound().cast<isize>();
+    _blit(src, dest, p, sampling);
+}
 
-    auto clipDest = current().clip.clipTo(destRect);
+void CpuCanvas::blit(Math::Recti dest, Mipmap const &mipmap) {
+    // FIXME: Properly handle offaxis rectangles
+    dest = current().trans.apply(dest.cast<f64>()).bound().cast<isize>();
+    _blit(dest, mipmap.level(dest.wh), Sampling::BILINEAR);
+}
 
-    auto hratio = srcRect.height / (f64)destRect.height;
-    auto wratio = srcRect.width / (f64)destRect.width;
+bool CpuCanvas::canBlit() const {
+    // Blits only move and stretch the bound of the destination,
+    // they can't be flipped, rotated or skewed.
+    auto const &trans = current().trans;
+    return trans.xy == 0 and trans.yx == 0 and
+           trans.xx > 0 and trans.yy > 0;
+}
 
-    for (isize y = 0; y < clipDest.height; ++y) {
-        isize yy = clipDest.y - destRect.y + y;
+// MARK: Filter Operations -----------------------------------------------------
 
-        auto srcY = srcRect.y + yy * hratio;
-        auto destY = clipDest.y + y;
+void CpuCanvas::apply(Filter filter) {
+    apply(filter, pixels().bound());
+}
 
-        for (isize x = 0; x < clipDest.width; ++x) {
-            isize xx = clipDest.x - destRect.x + x;
+void CpuCanvas::apply(Filter filter, Math::Recti r) {
+    // FIXME: Properly handle offaxis rectangles
+    r = current().trans.apply(r.cast<f64>()).bound().cast<isize>();
+    _apply(filter, r);
+}
 
-            auto srcX = srcRect.x + xx * wratio;
-            auto destX = clipDest.x + x;
+// MARK: Device Operations -----------------------------------------------------
 
-            u8 const *srcPx = static_cast<u8 const *>(src.pixelUnsafe({(isize)srcX, (isize)srcY}));
-            u8 *destPx = static_cast<u8 *>(dest.pixelUnsafe({destX, destY}));
-            auto srcC = srcFmt.load(srcPx);
-            auto destC = destFmt.load(destPx);
-            destFmt.store(destPx, srcC.blendOver(destC));
-        }
-    }
+void CpuCanvas::_fill(Fill fill, FillRule fillRule) {
+    fill.visit([&](auto fill) {
+        pixels().fmt().visit([&](auto format) {
+            if (_useSpaa)
+                _FillSmoothImpl(fill, format, fillRule);
+            else
+                _fillImpl(fill, format, fillRule);
+        });
+    });
 }
 
-void CpuCanvas::blit(Math::Recti src, Math::Recti dest, Pixels p) {
-    auto d = mutPixels();
-    d.fmt().visit([&](auto dfmt) {
-        p.fmt().visit([&](auto pfmt) {
-            _blit(p, src, pfmt, d, dest, dfmt);
+[[gnu::flatten]] void CpuCanvas::_fillRect(Math::Recti r, Color color) {
+    r = current().clip.clipTo(r);
+
+    if (auto const *mask = _mask()) {
+        pixels().fmt().visit([&](auto f) {
+            auto px = pack(f, color);
+            for (isize y = r.y; y < r.y + r.height; ++y) {
+                clipSpan(
+                    mask, y, r.x, r.end(),
+                    [&](isize start, isize end) {
+                        auto *dst = static_cast<u8 *>(mutPixels().pixelUnsafe({start, y}));
+                        blendRowSolid(dst, px, color.alpha, end - start);
+                    },
+                    [&](isize start, isize end, u8 const *coverage) {
+                        auto *dst = static_cast<u8 *>(mutPixels().pixelUnsafe({start, y}));
+                        blendRowSolidMasked(dst, px, color.alpha, coverage, end - start);
+                    }
+                );
+            }
+        });
+    } else if (color.alpha == 255) {
+        mutPixels()
+            .clip(r)
+            .clear(color);
+    } else {
+        pixels().fmt().visit([&](auto f) {
+            auto px = pack(f, color);
+            for (isize y = r.y; y < r.y + r.height; ++y) {
+                auto *dst = static_cast<u8 *>(mutPixels().pixelUnsafe({r.x, y}));
+                blendRowSolid(dst, px, color.alpha, r.width);
+            }
         });
+    }
+}
+
+void CpuCanvas::_fillGlyph(Strong<GlyphMask> mask, Math::Vec2i pen, Color color) {
+    pixels().fmt().visit([&](auto format) {
+        _blitGlyph(*mask, pen, color, format);
     });
 }
 
-// MARK: Filter Operations -----------------------------------------------------
+void CpuCanvas::_clear(Math::Recti rect, Color color) {
+    rect = current().clip.clipTo(rect);
 
-void CpuCanvas::apply(Filter filter) {
-    apply(filter, pixels().bound());
+    auto const *mask = _mask();
+    if (not mask) {
+        mutPixels()
+            .clip(rect)
+            .clear(color);
+        return;
+    }
+
+    pixels().fmt().visit([&](auto f) {
+        auto px = pack(f, color);
+        for (isize y = rect.y; y < rect.bottom(); y++) {
+            clipSpan(
+                mask, y, rect.x, rect.end(),
+                [&](isize start, isize end) {
+                    fillRow(static_cast<u8 *>(mutPixels().pixelUnsafe({start, y})), px, end - start);
+                },
+                [&](isize start, isize end, u8 const *coverage) {
+                    for (isize x = start; x < end; x++) {
+                        auto *dst = mutPixels().pixelUnsafe({x, y});
+                        f.store(dst, f.load(dst).lerpWith(color, coverage[x - start] / 255.0));
+                    }
+                }
+            );
+        }
+    });
 }
 
-void CpuCanvas::apply(Filter filter, Math::Recti r) {
-    // FIXME: Properly handle offaxis rectangles
-    r = current().trans.apply(r.cast<f64>()).bound().cast<isize>();
+void CpuCanvas::_plot(Math::Vec2i point, Color color) {
+    if (not current().clip.contains(point))
+        return;
+
+    if (auto const *mask = _mask())
+        color.alpha = mul255(color.alpha, mask->sample(point));
+
+    mutPixels().blend(point, color);
+}
 
+void CpuCanvas::_blit(Math::Recti src, Math::Recti dest, Pixels p, Sampling sampling) {
+    blitImage(mutPixels(), dest, current().clip, _mask(), p, src, sampling);
+}
+
+void CpuCanvas::_blit(Math::Recti dest, Strong<Surface const> surface, Sampling sampling) {
+    _blit(surface->bound(), dest, surface->pixels(), sampling);
+}
+
+void CpuCanvas::_apply(Filter filter, Math::Recti r) {
     r = current().clip.clipTo(r);
 
+    auto const *mask = _mask();
+    if (not mask) {
+        filter.apply(mutPixels().clip(r));
+        return;
+    }
+
+    // Filter the whole region, then bring back the
+    // original pixels where the mask isn't fully covering.
+    auto original = Surface::alloc(r.wh, pixels().fmt());
+    blitUnsafe(*original, pixels().clip(r));
     filter.apply(mutPixels().clip(r));
+
+    for (isize y = 0; y < r.height; y++) {
+        for (isize x = 0; x < r.width; x++) {
+            u8 coverage = mask->sample(r.xy + Math::Vec2i{x, y});
+            if (coverage == 255)
+                continue;
+
+            auto filtered = pixels().loadUnsafe(r.xy + Math::Vec2i{x, y});
+            auto c = original->pixels().loadUnsafe({x, y}).lerpWith(filtered, coverage / 255.0);
+            mutPixels().storeUnsafe(r.xy + Math::Vec2i{x, y}, c);
+        }
+    }
 }
 
 } // namespace Karm::Gfx
@@ -4,26 +4,22 @@
 #include "../canvas.h"
 #include "../fill.h"
 #include "../filters.h"
+#include "../icon.h"
 #include "../stroke.h"
+#include "blit.h"
+#include "clip.h"
+#include "comp.h"
+#include "glyphs.h"
 #include "rast.h"
 
 namespace Karm::Gfx {
 
-struct LcdLayout {
-    Math::Vec2f red;
-    Math::Vec2f green;
-    Math::Vec2f blue;
-};
-
-static LcdLayout RGB = {{+0.33, 0.0}, {0.0, 0.0}, {-0.33, 0.0}};
-static LcdLayout BGR = {{-0.33, 0.0}, {0.0, 0.0}, {+0.33, 0.0}};
-static LcdLayout VRGB = {{0.0, +0.33}, {0.0, 0.0}, {0.0, -0.33}};
-
 struct CpuCanvas : public Canvas {
     struct Scope {
         Fill fill = Gfx::WHITE;
         Stroke stroke{};
         Math::Recti clip{};
+        Opt<Strong<ClipMask>> mask = NONE; // Shared with the parent scope until clipped
         Math::Trans2f trans = Math::Trans2f::IDENTITY;
     };
 
@@ -32,16 +28,17 @@ struct CpuCanvas : public Canvas {
     Math::Path _path{};
     Math::Polyf _poly;
     CpuRast _rast{};
+    Vec<u32> _span{};
     LcdLayout _lcdLayout = RGB;
     bool _useSpaa = false;
 
     // MARK: Buffers -----------------------------------------------------------
 
     // Begin drawing operations on the given pixels.
-    void begin(MutPixels p);
+    virtual void begin(MutPixels p);
 
     // End drawing operations.
-    void end();
+    virtual void end();
 
     // Get the pixels being drawn on.
     MutPixels mutPixels();
@@ -55,6 +52,9 @@ struct CpuCanvas : public Canvas {
     // Get the current scope.
     Scope const &current() const;
 
+    // Get the current clip mask, if any.
+    ClipMask const *_mask() const;
+
     // MARK: Context Operations ------------------------------------------------
 
     void push() override;
@@ -71,9 +71,10 @@ struct CpuCanvas : public Canvas {
 
     // (internal) Fill the current shape with the given fill.
     // NOTE: The shape must be flattened before calling this function.
+    // NOTE: The shape is rasterized into spans which are then composited
+    //       one span at a time.
     void _fillImpl(auto fill, auto format, FillRule fillRule);
     void _FillSmoothImpl(auto fill, auto format, FillRule fillRule);
-    void _fill(Fill fill, FillRule rule = FillRule::NONZERO);
 
     void beginPath() override;
 
@@ -107,12 +108,14 @@ struct CpuCanvas : public Canvas {
 
     void stroke() override;
 
+    // (internal) Intersect the current clip with the current shape.
+    // NOTE: The shape must be flattened before calling this function.
+    void _clipMask(FillRule rule);
+
     void clip(FillRule rule) override;
 
     // MARK: Shape Operations --------------------------------------------------
 
-    void _fillRect(Math::Recti r, Gfx::Color color);
-
     void fill(Math::Recti rect, Math::Radiif radii) override;
 
     void clip(Math::Rectf rect) override;
@@ -121,8 +124,23 @@ struct CpuCanvas : public Canvas {
 
     void fill(Math::Path const &path, FillRule rule = FillRule::NONZERO) override;
 
+    // (internal) Rasterize the current polygon into a coverage mask,
+    // with one channel per sub-pixel when given a LCD layout.
+    GlyphMask _renderMask(Opt<LcdLayout> lcd);
+
+    // (internal) Rasterize a glyph into a coverage mask.
+    GlyphMask _renderGlyph(Text::Font &font, Text::Glyph glyph, GlyphKey const &key);
+
+    // (internal) Composite a glyph coverage mask at the given pen position.
+    void _blitGlyph(GlyphMask const &mask, Math::Vec2i pen, Color color, auto format);
+
     void fill(Text::Font &font, Text::Glyph glyph, Math::Vec2f baseline) override;
 
+    // (internal) Rasterize an icon into a coverage mask.
+    GlyphMask _renderIcon(Icon const &icon, IconKey const &key);
+
+    void fill(Icon const &icon, Math::Vec2f pos) override;
+
     // MARK: Clear Operations --------------------------------------------------
 
     void clear(Color color = BLACK) override;
@@ -139,23 +157,41 @@ struct CpuCanvas : public Canvas {
 
     // MARK: Blit Operations ---------------------------------------------------
 
-    void _blit(
-        Pixels src,
-        Math::Recti srcRect,
-        auto srcFmt,
+    void blit(Math::Recti src, Math::Recti dest, Pixels pixels, Sampling sampling = Sampling::NEAREST) override;
 
-        MutPixels dest,
-        Math::Recti destRect,
-        auto destFmt
-    );
+    void blit(Math::Recti dest, Mipmap const &mipmap) override;
 
-    void blit(Math::Recti src, Math::Recti dest, Pixels pixels) override;
+    bool canBlit() const override;
 
     // MARK: Filter Operations -------------------------------------------------
 
     void apply(Filter filter) override;
 
     void apply(Filter filter, Math::Recti region);
+
+    // MARK: Device Operations -------------------------------------------------
+
+    // Everything above ends up in one of these, they work in device space,
+    // are clipped to the current clip rect and are the only place where
+    // pixels get touched.
+
+    // Fill the current polygon.
+    virtual void _fill(Fill fill, FillRule rule = FillRule::NONZERO);
+
+    virtual void _fillRect(Math::Recti rect, Color color);
+
+    virtual void _fillGlyph(Strong<GlyphMask> mask, Math::Vec2i pen, Color color);
+
+    virtual void _clear(Math::Recti rect, Color color);
+
+    virtual void _plot(Math::Vec2i point, Color color);
+
+    virtual void _blit(Math::Recti src, Math::Recti dest, Pixels pixels, Sampling sampling);
+
+    // Blit all of a surface that is kept alive by the caller.
+    virtual void _blit(Math::Recti dest, Strong<Surface const> surface, Sampling sampling);
+
+    virtual void _apply(Filter filter, Math::Recti region);
 };
 
 } // namespace Karm::Gfx
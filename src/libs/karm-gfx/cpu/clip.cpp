@@ -0,0 +1,40 @@
+#include "clip.h"
+
+namespace Karm::Gfx {
+
+void ClipMask::computeRows() {
+    rows.clear();
+    rows.ensure(bound.height);
+
+    for (isize y = bound.top(); y < bound.bottom(); y++) {
+        auto const *c = at({bound.x, y});
+        Row row = {bound.x, bound.x, bound.x, bound.x};
+
+        isize first = -1, last = -1, run = 0;
+        for (isize x = 0; x < bound.width; x++) {
+            if (c[x] == 0) {
+                run = 0;
+                continue;
+            }
+
+            if (first < 0)
+                first = x;
+            last = x;
+
+            run = c[x] == 255 ? run + 1 : 0;
+            if (run > row.solidEnd - row.solidStart) {
+                row.solidStart = bound.x + x + 1 - run;
+                row.solidEnd = bound.x + x + 1;
+            }
+        }
+
+        if (first >= 0) {
+            row.start = bound.x + first;
+            row.end = bound.x + last + 1;
+        }
+
+        rows.pushBack(row);
+    }
+}
+
+} // namespace Karm::Gfx
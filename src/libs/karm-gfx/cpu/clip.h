@@ -0,0 +1,78 @@
+#pragma once
+
+#include <karm-base/buf.h>
+#include <karm-base/clamp.h>
+#include <karm-base/vec.h>
+#include <karm-math/rect.h>
+
+namespace Karm::Gfx {
+
+// An 8-bit coverage mask for clipping to arbitrary shapes,
+// pixels outside of its bound are clipped out.
+struct ClipMask {
+    struct Row {
+        isize start, end;           // Pixels with some coverage
+        isize solidStart, solidEnd; // Longest run of fully covered pixels
+    };
+
+    Math::Recti bound;
+    Buf<u8> coverage;
+    Vec<Row> rows{};
+
+    ClipMask(Math::Recti bound)
+        : bound(bound),
+          coverage(Buf<u8>::init(bound.width * bound.height)) {}
+
+    always_inline u8 *at(Math::Vec2i p) {
+        return coverage.buf() + (p.y - bound.y) * bound.width + (p.x - bound.x);
+    }
+
+    always_inline u8 const *at(Math::Vec2i p) const {
+        return coverage.buf() + (p.y - bound.y) * bound.width + (p.x - bound.x);
+    }
+
+    always_inline u8 sample(Math::Vec2i p) const {
+        if (not bound.contains(p))
+            return 0;
+        return *at(p);
+    }
+
+    always_inline Row const &row(isize y) const {
+        return rows[y - bound.y];
+    }
+
+    // Must be called once the coverage is written.
+    void computeRows();
+};
+
+// Split the span [start, end) of row y into runs fully inside of the mask,
+// handed to `solid(start, end)`, and runs partially covered, handed to
+// `masked(start, end, coverage)`. Runs outside of the mask are skipped.
+always_inline void clipSpan(ClipMask const *mask, isize y, isize start, isize end, auto solid, auto masked) {
+    if (not mask) {
+        if (start < end)
+            solid(start, end);
+        return;
+    }
+
+    if (y < mask->bound.top() or y >= mask->bound.bottom())
+        return;
+
+    auto const &row = mask->row(y);
+    start = max(start, row.start);
+    end = min(end, row.end);
+    if (start >= end)
+        return;
+
+    isize solidStart = clamp(row.solidStart, start, end);
+    isize solidEnd = clamp(row.solidEnd, solidStart, end);
+
+    if (start < solidStart)
+        masked(start, solidStart, mask->at({start, y}));
+    if (solidStart < solidEnd)
+        solid(solidStart, solidEnd);
+    if (solidEnd < end)
+        masked(solidEnd, end, mask->at({solidEnd, y}));
+}
+
+} // namespace Karm::Gfx
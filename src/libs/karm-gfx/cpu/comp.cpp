@@ -0,0 +1,153 @@
+#include <karm-base/simd.h>
+
+#include "comp.h"
+
+namespace Karm::Gfx {
+
+static constexpr u8x16 ALPHA_MASK = {
+    0, 0, 0, 255,
+    0, 0, 0, 255,
+    0, 0, 0, 255,
+    0, 0, 0, 255,
+};
+
+always_inline static u8x16 _load(u8 const *p) {
+    u8x16 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+always_inline static void _store(u8 *p, u8x16 v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+always_inline static u16x8 _lo(u8x16 v) {
+    return __builtin_convertvector(
+        __builtin_shufflevector(v, v, 0, 1, 2, 3, 4, 5, 6, 7),
+        u16x8
+    );
+}
+
+always_inline static u16x8 _hi(u8x16 v) {
+    return __builtin_convertvector(
+        __builtin_shufflevector(v, v, 8, 9, 10, 11, 12, 13, 14, 15),
+        u16x8
+    );
+}
+
+always_inline static u8x16 _narrow(u16x8 lo, u16x8 hi) {
+    auto l = __builtin_convertvector(lo, u8x8);
+    auto h = __builtin_convertvector(hi, u8x8);
+    return __builtin_shufflevector(l, h, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+}
+
+// Exact x / 255 for x in [0, 255 * 255].
+always_inline static u16x8 _div255(u16x8 x) {
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+always_inline static bool _isOpaque(u8x16 v) {
+    return (v[3] & v[7] & v[11] & v[15]) == 255;
+}
+
+// Blend 4 pixels over 4 opaque pixels, this matches Color::blendOver()
+// bit for bit when the background is opaque.
+always_inline static u8x16 _blendOverOpaque(u8x16 src, u8x16 dst, u8x16 alpha) {
+    u16x8 aLo = _lo(alpha), aHi = _hi(alpha);
+    u16x8 lo = _div255(_lo(src) * aLo + _lo(dst) * (255 - aLo));
+    u16x8 hi = _div255(_hi(src) * aHi + _hi(dst) * (255 - aHi));
+    return _narrow(lo, hi) | ALPHA_MASK;
+}
+
+// Both formats have the same layout as far as blending is concerned,
+// so we can go through Rgba8888 regardless of the actual format.
+always_inline static void _blendOver(u8 *dst, Color src) {
+    Rgba8888::store(dst, src.blendOver(Rgba8888::load(dst)));
+}
+
+void fillRow(u8 *dst, u32 px, usize len) {
+    u32x4 v = {px, px, px, px};
+
+    usize i = 0;
+    for (; i + 4 <= len; i += 4)
+        memcpy(dst + i * 4, &v, sizeof(v));
+
+    for (; i < len; i++)
+        memcpy(dst + i * 4, &px, sizeof(px));
+}
+
+void blendRowSolid(u8 *dst, u32 px, u8 alpha, usize len) {
+    auto color = Rgba8888::load(&px);
+    color.alpha = alpha;
+
+    if (alpha == 0)
+        return;
+
+    if (alpha == 255) {
+        fillRow(dst, pack(RGBA8888, color), len);
+        return;
+    }
+
+    u32x4 s32 = {px, px, px, px};
+    u8x16 src = __builtin_bit_cast(u8x16, s32);
+    u8x16 a = u8x16{} + alpha;
+
+    usize i = 0;
+    for (; i + 4 <= len; i += 4) {
+        u8 *p = dst + i * 4;
+        auto d = _load(p);
+        if (_isOpaque(d)) [[likely]] {
+            _store(p, _blendOverOpaque(src, d, a));
+        } else {
+            for (usize j = 0; j < 4; j++)
+                _blendOver(p + j * 4, color);
+        }
+    }
+
+    for (; i < len; i++)
+        _blendOver(dst + i * 4, color);
+}
+
+void blendRowSolidMasked(u8 *dst, u32 px, u8 alpha, u8 const *mask, usize len) {
+    // Expand the color in small batches and let blendRow() do the work
+    static constexpr usize BATCH = 64;
+    u32 batch[BATCH];
+
+    for (usize i = 0; i < len; i += BATCH) {
+        usize n = min(BATCH, len - i);
+        for (usize j = 0; j < n; j++)
+            batch[j] = px;
+
+        auto *b = reinterpret_cast<u8 *>(batch);
+        for (usize j = 0; j < n; j++)
+            b[j * 4 + 3] = mul255(alpha, mask[i + j]);
+
+        blendRow(dst + i * 4, b, n);
+    }
+}
+
+void blendRow(u8 *dst, u8 const *src, usize len) {
+    usize i = 0;
+    for (; i + 4 <= len; i += 4) {
+        u8 *p = dst + i * 4;
+        auto s = _load(src + i * 4);
+        auto d = _load(p);
+        if (_isOpaque(d)) [[likely]] {
+            auto a = __builtin_shufflevector(s, s, 3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15);
+            _store(p, _blendOverOpaque(s, d, a));
+        } else {
+            for (usize j = 0; j < 4; j++)
+                _blendOver(p + j * 4, Rgba8888::load(src + (i + j) * 4));
+        }
+    }
+
+    for (; i < len; i++)
+        _blendOver(dst + i * 4, Rgba8888::load(src + i * 4));
+}
+
+void maskRow(u8 *px, u8 const *mask, usize len) {
+    for (usize i = 0; i < len; i++)
+        px[i * 4 + 3] = mul255(px[i * 4 + 3], mask[i]);
+}
+
+} // namespace Karm::Gfx
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../buffer.h"
+
+// Span compositing kernels.
+//
+// The kernels work on raw 32-bit pixels and only assume the alpha channel is
+// the last byte, which is the case for both Rgba8888 and Bgra8888. Colors
+// must be stored in the destination format before being handed to them.
+
+namespace Karm::Gfx {
+
+// Pack a color in the given format.
+always_inline u32 pack(auto fmt, Color color) {
+    static_assert(fmt.bpp() == 4, "only 32-bit formats are supported");
+    u32 px;
+    fmt.store(&px, color);
+    return px;
+}
+
+// Multiply two coverage values, rounded to the nearest.
+always_inline inline u8 mul255(u8 a, u8 b) {
+    u32 x = a * b + 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// Overwrite a run of pixels with the same packed color.
+void fillRow(u8 *dst, u32 px, usize len);
+
+// Blend a packed color with an uniform alpha over a run of pixels.
+void blendRowSolid(u8 *dst, u32 px, u8 alpha, usize len);
+
+// Blend a packed color with an uniform alpha modulated by a
+// coverage mask over a run of pixels.
+void blendRowSolidMasked(u8 *dst, u32 px, u8 alpha, u8 const *mask, usize len);
+
+// Blend a run of packed colors over a run of pixels, the alpha
+// of each pixel is taken from the source.
+void blendRow(u8 *dst, u8 const *src, usize len);
+
+// Modulate the alpha of a run of packed colors by a coverage mask.
+void maskRow(u8 *px, u8 const *mask, usize len);
+
+} // namespace Karm::Gfx
@@ -0,0 +1,15 @@
+#include "glyphs.h"
+
+namespace Karm::Gfx {
+
+GlyphCache &glyphCache() {
+    static GlyphCache cache;
+    return cache;
+}
+
+IconCache &iconCache() {
+    static IconCache cache;
+    return cache;
+}
+
+} // namespace Karm::Gfx
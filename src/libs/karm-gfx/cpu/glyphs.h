@@ -0,0 +1,145 @@
+#pragma once
+
+#include <karm-base/lock.h>
+#include <karm-base/lru.h>
+#include <karm-text/font.h>
+
+#include "../buffer.h"
+
+namespace Karm::Gfx {
+
+struct LcdLayout {
+    Math::Vec2f red;
+    Math::Vec2f green;
+    Math::Vec2f blue;
+
+    bool operator==(LcdLayout const &) const = default;
+};
+
+static LcdLayout RGB = {{+0.33, 0.0}, {0.0, 0.0}, {-0.33, 0.0}};
+static LcdLayout BGR = {{-0.33, 0.0}, {0.0, 0.0}, {+0.33, 0.0}};
+static LcdLayout VRGB = {{0.0, +0.33}, {0.0, 0.0}, {0.0, -0.33}};
+
+struct GlyphKey {
+    // NOTE: The fontface is kept alive by the mask, so its address can't be
+    //       reused while the entry is in the cache.
+    Text::Fontface const *face;
+    Text::Glyph glyph;
+    f64 size;
+    u8 subpixel;
+    bool spaa;
+    LcdLayout lcd;
+
+    bool operator==(GlyphKey const &) const = default;
+
+    Hash hash() const {
+        return Karm::hash(face, glyph, size, subpixel, spaa);
+    }
+};
+
+// Coverage of a rasterized glyph, one channel per pixel or three when
+// rendered with sub-pixel anti-aliasing.
+struct GlyphMask {
+    Opt<Strong<Text::Fontface>> face; // Keeps the face of the key alive
+    Math::Vec2i origin; // Relative to the pen position
+    Math::Vec2i size;
+    usize channels;
+    Buf<u8> coverage;
+
+    always_inline Math::Recti bound() const {
+        return {origin, size};
+    }
+
+    always_inline u8 const *row(isize y) const {
+        return coverage.buf() + y * size.x * channels;
+    }
+};
+
+struct IconKey {
+    char const *path; // The svg data of the icon, which is static
+    f64 size;
+    u8 subpixelX;
+    u8 subpixelY;
+
+    bool operator==(IconKey const &) const = default;
+
+    Hash hash() const {
+        return Karm::hash(path, size, subpixelX, subpixelY);
+    }
+};
+
+template <typename K>
+struct MaskCache {
+    struct Stats {
+        usize hits;
+        usize misses;
+        usize len;
+    };
+
+    // NOTE: Masks are handed out as strong references so they can outlive
+    //       their entry, eg. while a tiled canvas is still compositing them.
+    //       The cache is shared by every canvas, whatever thread they run on.
+    Lock _lock;
+    Lru<K, Strong<GlyphMask>> _lru;
+    usize _hits = 0;
+    usize _misses = 0;
+
+    MaskCache(usize capacity)
+        : _lru(capacity) {}
+
+    Strong<GlyphMask> access(K const &key, auto const &render) {
+        LockScope scope{_lock};
+        bool miss = false;
+        auto mask = _lru.access(key, [&] {
+            miss = true;
+            return makeStrong<GlyphMask>(render());
+        });
+
+        if (miss)
+            _misses++;
+        else
+            _hits++;
+
+        return mask;
+    }
+
+    Stats stats() {
+        LockScope scope{_lock};
+        return {_hits, _misses, _lru.len()};
+    }
+
+    void clear() {
+        LockScope scope{_lock};
+        _lru.clear();
+        _hits = 0;
+        _misses = 0;
+    }
+};
+
+struct GlyphCache : public MaskCache<GlyphKey> {
+    // Number of horizontal sub-pixel positions a glyph is rendered at.
+    static constexpr usize SUBPIXELS = 4;
+
+    // Maximum number of glyphs kept in the cache.
+    static constexpr usize CAPACITY = 4096;
+
+    GlyphCache()
+        : MaskCache(CAPACITY) {}
+};
+
+struct IconCache : public MaskCache<IconKey> {
+    // Number of sub-pixel positions an icon is rendered at, on both axes.
+    static constexpr usize SUBPIXELS = 4;
+
+    // Maximum number of icons kept in the cache.
+    static constexpr usize CAPACITY = 512;
+
+    IconCache()
+        : MaskCache(CAPACITY) {}
+};
+
+GlyphCache &glyphCache();
+
+IconCache &iconCache();
+
+} // namespace Karm::Gfx
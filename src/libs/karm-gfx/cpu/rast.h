@@ -1,20 +1,37 @@
 #pragma once
 
 #include <karm-base/range.h>
+#include <karm-math/funcs.h>
 #include <karm-math/poly.h>
 
 #include "../types.h"
 
 namespace Karm::Gfx {
 
+// Scanline rasterizer with an active edge table and exact area coverage.
+//
+// Edges are bucketed by the row they start on and moved into the active edge
+// table when the scanline reaches them. Each row, active edges are stepped
+// incrementally and accumulate their signed area into a cell buffer
+// (like FreeType's "gray" rasterizer), the fill rule is then applied to the
+// running sum of the cells to get the coverage of each pixel.
 struct CpuRast {
-    static constexpr auto AA = 3;
-    static constexpr auto UNIT = 1.0f / AA;
-    static constexpr auto HALF_UNIT = 1.0f / AA / 2.0;
+    static constexpr usize NIL = Limits<usize>::MAX;
 
-    struct Active {
-        f64 x;
-        isize sign;
+    // Coverage bellow this threshold is invisible once quantized to 8 bits.
+    static constexpr f64 EPSILON = 1.0 / 512.0;
+
+    struct Edge {
+        f64 x;    // x at the top of the edge
+        f64 dxdy; // x increment per unit of y
+        f64 top, bottom;
+        f64 dir;
+
+        // Cells touched by this edge on the current row.
+        isize lo, hi;
+
+        // Next edge starting on the same row.
+        usize next;
     };
 
     struct Frag {
@@ -23,127 +40,280 @@ struct CpuRast {
         f64 a;
     };
 
-    Vec<Active> _active{};
-    Vec<irange> _ranges;
-    Vec<f64> _scanline{};
-
-    void _appendRange(irange range) {
-        usize i = 0;
-        for (auto &r : _ranges) {
-            if (r.overlaps(range)) {
-                auto merged = r.merge(range);
-                _ranges.removeAt(i);
-                _appendRange(merged);
-                return;
+    struct Span {
+        isize y;
+        isize start, end;
+        f64 a;
+
+        always_inline isize len() const {
+            return end - start;
+        }
+    };
+
+    Vec<Edge> _edges{};
+    Vec<usize> _buckets{};
+    Vec<usize> _active{};
+    Vec<f64> _cells{};
+
+    static f64 _coverage(f64 acc, FillRule fillRule) {
+        acc = Math::abs(acc);
+
+        if (fillRule == FillRule::EVENODD) {
+            acc = acc - 2.0 * Math::floor(acc / 2.0);
+            if (acc > 1.0)
+                acc = 2.0 - acc;
+        }
+
+        return min(acc, 1.0);
+    }
+
+    // Accumulate the area of a segment lying within a single row,
+    // x is relative to the start of the cell buffer.
+    void _accumulateSegment(f64 x0, f64 x1, f64 d, isize &lo, isize &hi) {
+        auto a = _cells.buf();
+
+        auto [xa, xb] = x0 < x1 ? Pair<f64>{x0, x1} : Pair<f64>{x1, x0};
+        f64 xaFloor = Math::floor(xa);
+        isize xai = xaFloor;
+        f64 xbCeil = Math::ceil(xb);
+        isize xbi = xbCeil;
+
+        lo = min(lo, xai);
+
+        if (xbi <= xai + 1) {
+            // The segment is contained in a single cell
+            f64 xmf = 0.5 * (x0 + x1) - xaFloor;
+            a[xai] += d - d * xmf;
+            a[xai + 1] += d * xmf;
+            hi = max(hi, xai + 1);
+            return;
+        }
+
+        f64 s = 1.0 / (xb - xa);
+        f64 xaf = xa - xaFloor;
+        f64 a0 = 0.5 * s * (1.0 - xaf) * (1.0 - xaf);
+        f64 xbf = xb - xbCeil + 1.0;
+        f64 am = 0.5 * s * xbf * xbf;
+
+        a[xai] += d * a0;
+        if (xbi == xai + 2) {
+            a[xai + 1] += d * (1.0 - a0 - am);
+        } else {
+            f64 a1 = s * (1.5 - xaf);
+            a[xai + 1] += d * (a1 - a0);
+            for (isize x = xai + 2; x < xbi - 1; x++)
+                a[x] += d * s;
+            f64 a2 = a1 + (xbi - xai - 3) * s;
+            a[xbi - 1] += d * (1.0 - a2 - am);
+        }
+        a[xbi] += d * am;
+        hi = max(hi, xbi);
+    }
+
+    // Accumulate a segment going from (x0, y0) to (x1, y1) within the current
+    // row, clipping it horizontally to [0, width].
+    void _accumulate(f64 x0, f64 y0, f64 x1, f64 y1, f64 dir, f64 width, isize &lo, isize &hi) {
+        // Everything right of the buffer doesn't contribute to visible cells.
+        if (x0 >= width and x1 >= width)
+            return;
+
+        if (x0 > width or x1 > width) {
+            f64 yc = y0 + (width - x0) / (x1 - x0) * (y1 - y0);
+            if (x0 > width) {
+                x0 = width;
+                y0 = yc;
+            } else {
+                x1 = width;
+                y1 = yc;
             }
+        }
 
-            if (range.end() > r.start) {
-                _ranges.insert(i, range);
+        // Everything left of the buffer is projected onto its left border.
+        if (x0 < 0 or x1 < 0) {
+            if (x0 < 0 and x1 < 0) {
+                _accumulateSegment(0, 0, (y1 - y0) * dir, lo, hi);
                 return;
             }
 
-            i++;
+            f64 yc = y0 + (0 - x0) / (x1 - x0) * (y1 - y0);
+            if (x0 < 0) {
+                _accumulateSegment(0, 0, (yc - y0) * dir, lo, hi);
+                x0 = 0;
+                y0 = yc;
+            } else {
+                _accumulateSegment(0, 0, (y1 - yc) * dir, lo, hi);
+                x1 = 0;
+                y1 = yc;
+            }
         }
 
-        _ranges.pushBack(range);
+        _accumulateSegment(x0, x1, (y1 - y0) * dir, lo, hi);
     }
 
-    void fill(Math::Polyf &poly, Math::Recti clip, FillRule fillRule, auto cb) {
-        auto polyBound = poly.bound().grow(UNIT);
-        auto clipBound = polyBound
+    void _buildEdges(Math::Polyf &poly, Math::Recti clipBound) {
+        _edges.clear();
+        _buckets.resize(clipBound.height);
+        Karm::fill<usize>(_buckets, NIL);
+
+        for (auto &e : poly) {
+            if (e.sy == e.ey)
+                continue;
+
+            auto [top, bottom] = e.sy < e.ey ? Pair<f64>{e.sy, e.ey} : Pair<f64>{e.ey, e.sy};
+            if (bottom <= clipBound.top() or top >= clipBound.bottom())
+                continue;
+
+            if (min(e.sx, e.ex) >= clipBound.end())
+                continue;
+
+            f64 dxdy = (e.ex - e.sx) / (e.ey - e.sy);
+            f64 start = max(top, (f64)clipBound.top());
+            usize row = Math::floori(start) - clipBound.top();
+
+            _edges.pushBack({
+                .x = e.sx + (top - e.sy) * dxdy - clipBound.x,
+                .dxdy = dxdy,
+                .top = top,
+                .bottom = bottom,
+                .dir = e.sy > e.ey ? 1.0 : -1.0,
+                .lo = 0,
+                .hi = 0,
+                .next = _buckets[row],
+            });
+            _buckets[row] = _edges.len() - 1;
+        }
+    }
+
+    void _sortActive() {
+        // The active edge table is almost sorted from one row to the
+        // next, an insertion sort is linear in this case.
+        for (usize i = 1; i < _active.len(); i++) {
+            usize curr = _active[i];
+            usize j = i;
+            while (j > 0 and _edges[_active[j - 1]].lo > _edges[curr].lo) {
+                _active[j] = _active[j - 1];
+                j--;
+            }
+            _active[j] = curr;
+        }
+    }
+
+    // Rasterize the polygon into horizontal spans of constant coverage,
+    // spans are emitted from top to bottom and from left to right.
+    void rasterize(Math::Polyf &poly, Math::Recti clip, FillRule fillRule, auto cb) {
+        if (poly.len() == 0)
+            return;
+
+        auto clipBound = poly.bound()
                              .ceil()
                              .cast<isize>()
                              .clipTo(clip);
 
-        _scanline.resize(clipBound.width + 1);
+        if (clipBound.width <= 0 or clipBound.height <= 0)
+            return;
 
-        for (isize y = clipBound.top(); y < clipBound.bottom(); y++) {
-            zeroFill<f64>(mutSub(_scanline, 0, clipBound.width + 1));
-            _ranges.clear();
+        _buildEdges(poly, clipBound);
+        _active.clear();
+        _cells.resize(clipBound.width + 2);
+        zeroFill<f64>(_cells);
 
-            for (f64 yy = y; yy < y + 1.0; yy += UNIT) {
-                _active.clear();
+        f64 width = clipBound.width;
 
-                for (auto &edge : poly) {
-                    auto sample = yy + HALF_UNIT;
+        auto emit = [&](isize y, isize start, isize end, f64 a) {
+            cb(Span{y, clipBound.x + start, clipBound.x + end, a});
+        };
 
-                    if (edge.bound().top() <= sample and sample < edge.bound().bottom()) {
-                        _active.pushBack({
-                            .x = edge.sx + (sample - edge.sy) / (edge.ey - edge.sy) * (edge.ex - edge.sx),
-                            .sign = edge.sy > edge.ey ? 1 : -1,
-                        });
-                    }
-                }
+        for (isize row = 0; row < clipBound.height; row++) {
+            isize y = clipBound.y + row;
+
+            for (usize i = _buckets[row]; i != NIL; i = _edges[i].next)
+                _active.pushBack(i);
+
+            if (_active.len() == 0)
+                continue;
+
+            // Step the active edges and accumulate their area
+            // NOTE: x is evaluated from the top of the edge rather than
+            //       accumulated from one row to the next, so the coverage
+            //       of a row doesn't depend on where the clip starts.
+            for (auto i : _active) {
+                auto &e = _edges[i];
+                f64 y0 = max(e.top, (f64)y);
+                f64 y1 = min(e.bottom, y + 1.0);
+                f64 x0 = e.x + (y0 - e.top) * e.dxdy;
+                f64 x1 = e.x + (y1 - e.top) * e.dxdy;
+
+                e.lo = Limits<isize>::MAX;
+                e.hi = Limits<isize>::MIN;
+                _accumulate(x0, y0 - y, x1, y1 - y, e.dir, width, e.lo, e.hi);
+            }
+
+            _sortActive();
+
+            // Walk the cells touched by the edges from left to right,
+            // between them the coverage is constant.
+            f64 acc = 0;
+            isize cursor = 0;
+            for (auto i : _active) {
+                auto &e = _edges[i];
+                if (e.lo >= clipBound.width)
+                    break;
 
-                if (_active.len() == 0)
+                if (e.hi < cursor)
                     continue;
 
-                sort(_active, [](auto const &a, auto const &b) {
-                    return a.x <=> b.x;
-                });
-
-                isize rule = 0;
-                for (usize i = 0; i + 1 < _active.len(); i++) {
-                    if (fillRule == FillRule::NONZERO) {
-                        rule += _active[i].sign;
-                        if (rule == 0)
-                            continue;
-                    }
-
-                    if (fillRule == FillRule::EVENODD) {
-                        rule++;
-                        if (rule % 2 == 0)
-                            continue;
-                    }
-
-                    // Clip the range to the clip rect
-                    // NOTE: The following looks a bit verbose but it's necessary to avoid
-                    //       floating point errors when converting to integer coordinates.
-                    f64 x1 = max(_active[i].x, clipBound.start());
-
-                    isize cx1 = max(Math::ceili(_active[i].x), clipBound.start());
-                    isize fx1 = max(Math::floori(_active[i].x), clipBound.start());
-
-                    f64 x2 = min(_active[i + 1].x, clipBound.end());
-                    isize cx2 = min(Math::ceili(_active[i + 1].x), clipBound.end());
-                    isize fx2 = min(Math::floori(_active[i + 1].x), clipBound.end());
-
-                    // Skip if the range is empty
-                    if (x1 >= x2)
-                        continue;
-
-                    _appendRange(irange::fromStartEnd(fx1, cx2));
-
-                    // Are x1 and x2 on the same pixel?
-                    if (fx1 == fx2) {
-                        _scanline[fx1 - clipBound.x] += (x2 - x1) * UNIT;
-                        continue;
-                    }
-
-                    // Compute the coverage for the first and last pixel
-                    _scanline[x1 - clipBound.x] += (cx1 - x1) * UNIT;
-                    _scanline[x2 - clipBound.x] += (x2 - fx2) * UNIT;
-
-                    // Fill the pixels in between
-                    for (isize x = cx1; x < fx2; x++)
-                        _scanline[x - clipBound.x] += UNIT;
+                if (e.lo > cursor) {
+                    f64 a = _coverage(acc, fillRule);
+                    if (a > EPSILON)
+                        emit(y, cursor, e.lo, a);
+                    cursor = e.lo;
+                }
+
+                isize end = min(e.hi + 1, clipBound.width);
+                for (; cursor < end; cursor++) {
+                    acc += _cells[cursor];
+                    _cells[cursor] = 0;
+                    f64 a = _coverage(acc, fillRule);
+                    if (a > EPSILON)
+                        emit(y, cursor, cursor + 1, a);
                 }
             }
 
-            for (auto r : _ranges) {
-                for (isize x = r.start; x < r.end(); x++) {
-                    auto xy = Math::Vec2i{x, y};
+            // The shape might extend past the right of the clip
+            f64 a = _coverage(acc, fillRule);
+            if (cursor < clipBound.width and a > EPSILON)
+                emit(y, cursor, clipBound.width, a);
 
-                    auto uv = Math::Vec2f{
-                        (x - polyBound.start()) / polyBound.width,
-                        (y - polyBound.top()) / polyBound.height,
-                    };
+            _cells[clipBound.width] = 0;
+            _cells[clipBound.width + 1] = 0;
 
-                    cb(Frag{xy, uv, clamp01(_scanline[x - clipBound.x])});
-                }
+            // Retire the edges ending on this row
+            usize j = 0;
+            for (auto i : _active) {
+                if (_edges[i].bottom > y + 1)
+                    _active[j++] = i;
             }
+            _active.trunc(j);
         }
     }
+
+    always_inline static Math::Vec2f uv(Math::Rectf bound, Math::Vec2i xy) {
+        return {
+            (xy.x + 0.5 - bound.start()) / bound.width,
+            (xy.y + 0.5 - bound.top()) / bound.height,
+        };
+    }
+
+    // Rasterize the polygon one fragment at the time.
+    void fill(Math::Polyf &poly, Math::Recti clip, FillRule fillRule, auto cb) {
+        auto polyBound = poly.bound();
+        rasterize(poly, clip, fillRule, [&](Span span) {
+            for (isize x = span.start; x < span.end; x++) {
+                Math::Vec2i xy = {x, span.y};
+                cb(Frag{xy, uv(polyBound, xy), span.a});
+            }
+        });
+    }
 };
 
 } // namespace Karm::Gfx
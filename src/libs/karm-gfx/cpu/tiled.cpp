@@ -0,0 +1,183 @@
+#include <karm-base/atomic.h>
+
+#include "tiled.h"
+
+namespace Karm::Gfx {
+
+static Strong<Surface> _copy(Pixels pixels) {
+    auto surface = Surface::alloc(pixels.size(), pixels.fmt());
+    blitUnsafe(surface->mutPixels(), pixels);
+    return surface;
+}
+
+static void _replay(CpuCanvas &c, CpuTiledCanvas::Cmd const &cmd, Math::Recti band) {
+    c.current().clip = cmd.clip.clipTo(band);
+    c.current().mask = cmd.mask;
+
+    cmd.op.visit(Visitor{
+        [&](CpuTiledCanvas::FillCmd const &f) {
+            c._poly = f.poly;
+            c._useSpaa = f.spaa;
+            c._lcdLayout = f.lcd;
+            c._fill(f.fill, f.rule);
+        },
+        [&](CpuTiledCanvas::RectCmd const &r) {
+            c._fillRect(r.rect, r.color);
+        },
+        [&](CpuTiledCanvas::GlyphCmd const &g) {
+            c._fillGlyph(g.mask, g.pen, g.color);
+        },
+        [&](CpuTiledCanvas::ClearCmd const &r) {
+            c._clear(r.rect, r.color);
+        },
+        [&](CpuTiledCanvas::PlotCmd const &p) {
+            c._plot(p.point, p.color);
+        },
+        [&](CpuTiledCanvas::BlitCmd const &b) {
+            blitImage(c.mutPixels(), b.dest, c.current().clip, c._mask(), b.pixels->pixels(), b.src, b.sampling);
+        },
+    });
+}
+
+// MARK: Buffers ---------------------------------------------------------------
+
+void CpuTiledCanvas::begin(MutPixels p) {
+    _cmds.clear();
+    CpuCanvas::begin(p);
+}
+
+void CpuTiledCanvas::end() {
+    flush();
+    CpuCanvas::end();
+}
+
+void CpuTiledCanvas::flush() {
+    if (_cmds.len() == 0)
+        return;
+
+    auto pixels = mutPixels();
+    usize bands = (pixels.height() + BAND_HEIGHT - 1) / BAND_HEIGHT;
+
+    // Bin each command into the bands it touches
+    Vec<Vec<usize>> bins;
+    bins.resize(bands);
+    for (usize i = 0; i < _cmds.len(); i++) {
+        auto bound = _cmds[i].bound;
+        usize first = bound.top() / BAND_HEIGHT;
+        usize last = (bound.bottom() - 1) / BAND_HEIGHT;
+        for (usize b = first; b <= last and b < bands; b++)
+            bins[b].pushBack(i);
+    }
+
+    // Every lane pulls bands until there are none left, each one with
+    // its own rasterizer and scratch buffers.
+    Atomic<usize> next{};
+    Sys::parallelFor(min(_threads, bands), 1, [&](usize) {
+        CpuCanvas c;
+        c.begin(pixels);
+        for (usize b = next.fetchInc(); b < bands; b = next.fetchInc()) {
+            Math::Recti band = {
+                0,
+                (isize)b * BAND_HEIGHT,
+                pixels.width(),
+                BAND_HEIGHT,
+            };
+            band = band.clipTo(pixels.bound());
+            for (auto i : bins[b])
+                _replay(c, _cmds[i], band);
+        }
+        c.end();
+    });
+
+    _cmds.clear();
+}
+
+// MARK: Device Operations -----------------------------------------------------
+
+void CpuTiledCanvas::_record(_Cmd op, Math::Recti bound) {
+    auto clip = current().clip;
+    bound = clip.clipTo(bound);
+    if (bound.width <= 0 or bound.height <= 0)
+        return;
+    _cmds.pushBack({std::move(op), clip, current().mask, bound});
+}
+
+void CpuTiledCanvas::_fill(Fill fill, FillRule rule) {
+    if (_poly.len() == 0)
+        return;
+
+    // Leave room for anti-aliasing and sub-pixel offsets
+    auto bound = _poly.bound().grow(1).ceil().cast<isize>();
+
+    Opt<Strong<Surface>> texture = NONE;
+    if (fill.is<Pixels>()) {
+        texture = _copy(fill.unwrap<Pixels>());
+        fill = (*texture)->pixels();
+    }
+
+    _record(
+        FillCmd{
+            _poly,
+            fill,
+            rule,
+            _useSpaa,
+            _lcdLayout,
+            std::move(texture),
+        },
+        bound
+    );
+}
+
+void CpuTiledCanvas::_fillRect(Math::Recti rect, Color color) {
+    _record(RectCmd{rect, color}, rect);
+}
+
+void CpuTiledCanvas::_fillGlyph(Strong<GlyphMask> mask, Math::Vec2i pen, Color color) {
+    auto bound = mask->bound().offset(pen);
+    _record(GlyphCmd{std::move(mask), pen, color}, bound);
+}
+
+void CpuTiledCanvas::_clear(Math::Recti rect, Color color) {
+    _record(ClearCmd{rect, color}, rect);
+}
+
+void CpuTiledCanvas::_plot(Math::Vec2i point, Color color) {
+    _record(PlotCmd{point, color}, {point, {1, 1}});
+}
+
+void CpuTiledCanvas::_blit(Math::Recti src, Math::Recti dest, Pixels pixels, Sampling sampling) {
+    if (not current().clip.colide(dest))
+        return;
+
+    // Build the mipmap once rather than once per band
+    if (sampling == Sampling::MIPMAP) {
+        if (auto level = mipmap(pixels, src, dest.wh)) {
+            _record(BlitCmd{level->rect, dest, level->surface, Sampling::BILINEAR}, dest);
+            return;
+        }
+    }
+
+    // Only the part being blitted is copied, an atlas or a nine-patch
+    // can be much bigger than the piece that is drawn out of it.
+    auto copied = src.clipTo(pixels.bound());
+    if (copied.width <= 0 or copied.height <= 0)
+        return;
+
+    auto rebased = src.offset(-copied.xy);
+    _record(BlitCmd{rebased.cast<f64>(), dest, _copy(pixels.clip(copied)), sampling}, dest);
+}
+
+void CpuTiledCanvas::_blit(Math::Recti dest, Strong<Surface const> surface, Sampling sampling) {
+    if (not current().clip.colide(dest))
+        return;
+
+    auto src = surface->bound().cast<f64>();
+    _record(BlitCmd{src, dest, std::move(surface), sampling}, dest);
+}
+
+void CpuTiledCanvas::_apply(Filter filter, Math::Recti region) {
+    flush();
+    CpuCanvas::_apply(filter, region);
+}
+
+} // namespace Karm::Gfx
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <karm-base/union.h>
+#include <karm-sys/pool.h>
+
+#include "canvas.h"
+
+namespace Karm::Gfx {
+
+// A canvas that records drawing operations and renders them when ended.
+//
+// Operations are recorded in device space along with the clip they were
+// issued with, binned into horizontal bands of the surface and the bands are
+// rendered in parallel. Bands span the full width of the surface so the result
+// is pixel-identical to CpuCanvas.
+//
+// NOTE: Pixels handed to blit() or used as a fill are copied, but the pixels
+//       being drawn on must stay alive until end(). Blits only copy their
+//       source rectangle, fills copy the whole texture since it's stretched
+//       over the shape, and surfaces that are kept alive, like the levels
+//       of a mipmap, aren't copied at all.
+struct CpuTiledCanvas : public CpuCanvas {
+    static constexpr isize BAND_HEIGHT = 32;
+
+    struct FillCmd {
+        Math::Polyf poly;
+        Fill fill;
+        FillRule rule;
+        bool spaa;
+        LcdLayout lcd;
+        Opt<Strong<Surface>> texture;
+    };
+
+    struct RectCmd {
+        Math::Recti rect;
+        Color color;
+    };
+
+    struct GlyphCmd {
+        Strong<GlyphMask> mask;
+        Math::Vec2i pen;
+        Color color;
+    };
+
+    struct ClearCmd {
+        Math::Recti rect;
+        Color color;
+    };
+
+    struct PlotCmd {
+        Math::Vec2i point;
+        Color color;
+    };
+
+    struct BlitCmd {
+        Math::Rectf src;
+        Math::Recti dest;
+        Strong<Surface const> pixels;
+        Sampling sampling;
+    };
+
+    using _Cmd = Union<
+        FillCmd,
+        RectCmd,
+        GlyphCmd,
+        ClearCmd,
+        PlotCmd,
+        BlitCmd>;
+
+    struct Cmd {
+        _Cmd op;
+        Math::Recti clip;
+        Opt<Strong<ClipMask>> mask;
+        Math::Recti bound; // Pixels touched by the command, clip included
+    };
+
+    usize _threads;
+    Vec<Cmd> _cmds{};
+
+    CpuTiledCanvas(usize threads = Sys::concurrency())
+        : _threads(max(threads, (usize)1)) {}
+
+    // MARK: Buffers -----------------------------------------------------------
+
+    void begin(MutPixels p) override;
+
+    void end() override;
+
+    // Render all the pending operations.
+    void flush();
+
+    // MARK: Device Operations -------------------------------------------------
+
+    void _record(_Cmd op, Math::Recti bound);
+
+    void _fill(Fill fill, FillRule rule = FillRule::NONZERO) override;
+
+    void _fillRect(Math::Recti rect, Color color) override;
+
+    void _fillGlyph(Strong<GlyphMask> mask, Math::Vec2i pen, Color color) override;
+
+    void _clear(Math::Recti rect, Color color) override;
+
+    void _plot(Math::Vec2i point, Color color) override;
+
+    void _blit(Math::Recti src, Math::Recti dest, Pixels pixels, Sampling sampling) override;
+
+    void _blit(Math::Recti dest, Strong<Surface const> surface, Sampling sampling) override;
+
+    // NOTE: Filters read back neighboring pixels, so they act as a barrier,
+    //       everything recorded before them gets rendered first.
+    void _apply(Filter filter, Math::Recti region) override;
+};
+
+} // namespace Karm::Gfx
@@ -1,100 +1,113 @@
-#include <karm-base/ring.h>
+#include <karm-base/atomic.h>
+#include <karm-base/simd.h>
 #include <karm-math/rand.h>
+#include <karm-sys/pool.h>
 
 #include "filters.h"
 
 namespace Karm::Gfx {
 
-struct StackBlur {
-    isize _radius;
-    Ring<Math::Vec4u> _queue;
-    Math::Vec4u _sum;
-
-    StackBlur(isize radius)
-        : _radius(radius), _queue(width()) {
-        clear();
+// Stack blur: a triangle kernel of weights 1, 2, .., r + 1, .., 2, 1 that
+// is updated in constant time per pixel by keeping the sum of the pixels
+// entering and leaving the window along the weighted sum.
+//
+// `line` is padded with `radius` copies of its first and last pixels on
+// both sides, `out` receives `len` blurred pixels.
+[[gnu::flatten]] static void _stackBlur(u32x4 const *line, u32x4 *out, isize len, isize radius) {
+    u32x4 sum = {}, sumIn = {}, sumOut = {};
+    for (isize k = 0; k <= radius * 2; k++) {
+        u32 weight = radius + 1 - Math::abs(k - radius);
+        sum += line[k] * weight;
+        if (k <= radius)
+            sumOut += line[k];
+        else
+            sumIn += line[k];
     }
 
-    Math::Vec4u outgoingSum() const {
-        Math::Vec4u sum = {};
-        for (isize i = 0; i < _radius; i++) {
-            sum = sum + _queue.peek(i);
-        }
-        return sum;
+    f32 scale = 1.0f / ((radius + 1) * (radius + 1));
+    for (isize i = 0; i < len; i++) {
+        auto res = __builtin_convertvector(sum, f32x4) * scale + 0.5f;
+        out[i] = __builtin_convertvector(res, u32x4);
+
+        // Slide the window one pixel forward
+        u32x4 incoming = line[i + radius * 2 + 1];
+        u32x4 center = line[i + radius + 1];
+        sum += sumIn + incoming - sumOut;
+        sumOut += center - line[i];
+        sumIn += incoming - center;
     }
+}
 
-    Math::Vec4u incomingSum() const {
-        Math::Vec4u sum = {};
-        for (isize i = 0; i < _radius; i++) {
-            sum = sum + _queue.peek(width() - i - 1);
-        }
-        return sum;
-    }
+static void _blurRows(MutPixels p, isize radius, isize start, isize end) {
+    Vec<u32x4> line, out;
+    line.resize(p.width() + radius * 2 + 1, u32x4{});
+    out.resize(p.width(), u32x4{});
 
-    isize width() const {
-        return _radius * 2 + 1;
-    }
+    p.fmt().visit([&](auto f) {
+        for (isize y = start; y < end; y++) {
+            auto *row = static_cast<u8 *>(p.scanline(y));
+            for (isize i = 0; i < (isize)line.len(); i++) {
+                auto c = f.load(row + clamp(i - radius, 0, p.width() - 1) * 4);
+                line[i] = u32x4{c.red, c.green, c.blue, c.alpha};
+            }
 
-    isize denominator() const {
-        return _radius * (_radius + 2) - 1;
-    }
+            _stackBlur(line.buf(), out.buf(), p.width(), radius);
 
-    void enqueue(Math::Vec4u color) {
-        _queue.pushBack(color);
-        _sum = _sum + incomingSum() - outgoingSum();
-    }
-
-    Math::Vec4u dequeue() {
-        auto res = _sum / denominator();
-        _queue.popFront();
-        return res;
-    }
-
-    void clear() {
-        _sum = {};
-        _queue.clear();
-        for (isize i = 0; i < width(); i++) {
-            _queue.pushBack({});
+            for (isize x = 0; x < p.width(); x++)
+                f.store(row + x * 4, Color::fromRgba(out[x][0], out[x][1], out[x][2], out[x][3]));
         }
-    }
-};
+    });
+}
 
-[[gnu::flatten]] void BlurFilter::apply(MutPixels p) const {
-    if (amount == 0)
-        return;
+static void _blurColumns(MutPixels p, isize radius, isize start, isize end) {
+    Vec<u32x4> line, out;
+    line.resize(p.height() + radius * 2 + 1, u32x4{});
+    out.resize(p.height(), u32x4{});
 
-    StackBlur stack{(isize)amount};
-    auto b = p.bound();
+    p.fmt().visit([&](auto f) {
+        for (isize x = start; x < end; x++) {
+            for (isize i = 0; i < (isize)line.len(); i++) {
+                auto c = f.load(p.pixelUnsafe({x, clamp(i - radius, 0, p.height() - 1)}));
+                line[i] = u32x4{c.red, c.green, c.blue, c.alpha};
+            }
 
-    for (isize y = b.top(); y < b.bottom(); y++) {
-        for (isize i = 0; i < stack.width(); i++) {
-            auto x = b.start() + i - (isize)amount;
-            stack.dequeue();
-            stack.enqueue(p.load({x, y}));
-        }
+            _stackBlur(line.buf(), out.buf(), p.height(), radius);
 
-        for (isize x = b.start(); x < b.end(); x++) {
-            p.store({x, y}, stack.dequeue());
-            stack.enqueue(p.load({x + (isize)amount + 1, y}));
+            for (isize y = 0; y < p.height(); y++)
+                f.store(p.pixelUnsafe({x, y}), Color::fromRgba(out[y][0], out[y][1], out[y][2], out[y][3]));
         }
+    });
+}
 
-        stack.clear();
-    }
+// Split the lines [0, len) in chunks processed by as many threads of the
+// pool as is worth it given the number of pixels per line.
+static void _parallel(isize len, isize pixels, auto fn) {
+    // Below that many pixels going wide costs more than it saves
+    static constexpr isize MIN_WORK = 128 * 128;
+    static constexpr isize CHUNK = 16;
 
-    for (isize x = b.start(); x < b.end(); x++) {
-        for (isize i = 0; i < stack.width(); i++) {
-            isize const y = b.top() + i - (isize)amount;
-            stack.dequeue();
-            stack.enqueue(p.load({x, y}));
-        }
+    usize chunks = (len + CHUNK - 1) / CHUNK;
+    usize threads = min(Sys::concurrency(), chunks, (usize)max(len * pixels / MIN_WORK, 1));
 
-        for (isize y = b.top(); y < b.bottom(); y++) {
-            p.store({x, y}, stack.dequeue());
-            stack.enqueue(p.load({x, y + (isize)amount + 1}));
-        }
+    Atomic<usize> next{};
+    Sys::parallelFor(threads, 1, [&](usize) {
+        for (usize c = next.fetchInc(); c < chunks; c = next.fetchInc())
+            fn(c * CHUNK, min((isize)((c + 1) * CHUNK), len));
+    });
+}
 
-        stack.clear();
-    }
+void BlurFilter::apply(MutPixels p) const {
+    isize radius = amount;
+    if (radius <= 0 or p.width() <= 0 or p.height() <= 0)
+        return;
+
+    _parallel(p.height(), p.width(), [&](isize start, isize end) {
+        _blurRows(p, radius, start, end);
+    });
+
+    _parallel(p.width(), p.height(), [&](isize start, isize end) {
+        _blurColumns(p, radius, start, end);
+    });
 }
 
 void SaturationFilter::apply(MutPixels p) const {
@@ -1,26 +1,35 @@
+#include <karm-base/lock.h>
+#include <karm-base/lru.h>
+
 #include "icon.h"
 
 namespace Karm::Gfx {
 
+// Maximum number of parsed paths kept in the cache.
+static constexpr usize CAPACITY = 512;
+
+// NOTE: Paths are keyed by the address of their svg data,
+//       which lives as long as the program.
+static Lock _lock;
+static Lru<char const *, Strong<Math::Path>> _paths{CAPACITY};
+
+Strong<Math::Path> Icon::path() const {
+    LockScope scope{_lock};
+    return _paths.access(_icon.path, [&] {
+        return makeStrong<Math::Path>(Math::Path::fromSvg(svg()));
+    });
+}
+
 void Icon::fill(Gfx::Canvas &g, Math::Vec2i pos) const {
-    g.push();
-    g.beginPath();
-    g.origin(pos.cast<f64>());
-    g.scale(_size / _icon.width);
-    auto path = Math::Path::fromSvg(svg());
-    g.path(path);
-    g.fill();
-    g.pop();
+    g.fill(*this, pos.cast<f64>());
 }
 
 void Icon::stroke(Gfx::Canvas &g, Math::Vec2i pos) const {
-
     g.push();
     g.beginPath();
     g.origin(pos.cast<f64>());
     g.scale(_size / _icon.width);
-    auto path = Math::Path::fromSvg(svg());
-    g.path(path);
+    g.path(*path());
     g.stroke();
     g.pop();
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/rc.h>
 #include <karm-math/rect.h>
 #include <mdi/_prelude.h>
 
@@ -26,6 +27,9 @@ struct Icon {
         return Str::fromNullterminated(_icon.path);
     }
 
+    // The parsed path of the icon, shared by every icon of the same kind.
+    Strong<Math::Path> path() const;
+
     void fill(Gfx::Canvas &g, Math::Vec2i pos) const;
 
     void stroke(Gfx::Canvas &g, Math::Vec2i pos) const;
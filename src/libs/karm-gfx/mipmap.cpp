@@ -0,0 +1,81 @@
+#include "mipmap.h"
+
+namespace Karm::Gfx {
+
+void downsample(Pixels from, MutPixels to) {
+    from.fmt().visit([&](auto sf) {
+        for (isize y = 0; y < to.height(); y++) {
+            auto const *s0 = static_cast<u8 const *>(from.scanline(y * 2));
+            auto const *s1 = static_cast<u8 const *>(from.scanline(min(y * 2 + 1, from.height() - 1)));
+            auto *d = static_cast<u8 *>(to.scanline(y));
+
+            for (isize x = 0; x < to.width(); x++) {
+                isize x0 = x * 2;
+                isize x1 = min(x * 2 + 1, from.width() - 1);
+                Color c[4] = {
+                    sf.load(s0 + x0 * 4),
+                    sf.load(s0 + x1 * 4),
+                    sf.load(s1 + x0 * 4),
+                    sf.load(s1 + x1 * 4),
+                };
+
+                u32 a = c[0].alpha + c[1].alpha + c[2].alpha + c[3].alpha;
+                Color res = {};
+                if (a) {
+                    auto channel = [&](auto get) {
+                        u32 sum = 0;
+                        for (auto &v : c)
+                            sum += get(v) * v.alpha;
+                        return static_cast<u8>((sum + a / 2) / a);
+                    };
+
+                    res = {
+                        channel([](Color v) { return v.red; }),
+                        channel([](Color v) { return v.green; }),
+                        channel([](Color v) { return v.blue; }),
+                        static_cast<u8>((a + 2) / 4),
+                    };
+                }
+
+                RGBA8888.store(d + x * 4, res);
+            }
+        }
+    });
+}
+
+Mipmap Mipmap::build(Strong<Surface const> image) {
+    Mipmap mipmap{image, {}};
+
+    Pixels from = image->pixels();
+    while (from.width() > 1 or from.height() > 1) {
+        auto to = Surface::alloc({
+            (from.width() + 1) / 2,
+            (from.height() + 1) / 2,
+        });
+        downsample(from, *to);
+        from = to->pixels();
+        mipmap.levels.pushBack(std::move(to));
+    }
+
+    return mipmap;
+}
+
+Strong<Surface const> Mipmap::level(Math::Vec2i size) const {
+    if (size.x <= 0 or size.y <= 0)
+        return image;
+
+    f64 scale = min(
+        image->width() / (f64)size.x,
+        image->height() / (f64)size.y
+    );
+
+    usize count = 0;
+    while (count < levels.len() and (f64)(2 << count) <= scale)
+        count++;
+
+    if (count == 0)
+        return image;
+    return levels[count - 1];
+}
+
+} // namespace Karm::Gfx
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "buffer.h"
+
+namespace Karm::Gfx {
+
+// Average 2x2 blocks of pixels in premultiplied space, the last row and
+// column are repeated when the size is odd.
+void downsample(Pixels from, MutPixels to);
+
+// An image along with its levels, each one box-filtered down to half the
+// size of the previous one.
+//
+// Build it once for an image that gets drawn smaller than it is, unlike
+// Sampling::MIPMAP which builds the levels it needs again on every blit.
+struct Mipmap {
+    Strong<Surface const> image;
+    Vec<Strong<Surface>> levels;
+
+    static Mipmap build(Strong<Surface const> image);
+
+    // The smallest level that is still at least as big as `size`,
+    // the image itself when it isn't drawn smaller than it is.
+    Strong<Surface const> level(Math::Vec2i size) const;
+};
+
+} // namespace Karm::Gfx
@@ -0,0 +1,245 @@
+#include <karm-base/lock.h>
+#include <karm-base/lru.h>
+
+#include "cpu/canvas.h"
+#include "shadow.h"
+
+namespace Karm::Gfx {
+
+// MARK: Nine-Patch ------------------------------------------------------------
+
+struct ShadowKey {
+    f64 blur;
+    Math::Radiif radii; // Spread included
+    Color fill;
+
+    // Zero for a nine-patch, otherwise the size of the whole
+    // shadow of a box too small for its corners to fit.
+    Math::Vec2i size = {};
+
+    bool operator==(ShadowKey const &other) const {
+        for (usize i = 0; i < radii.radii.len(); i++)
+            if (radii.radii[i] != other.radii.radii[i])
+                return false;
+        return blur == other.blur and fill == other.fill and
+               size.x == other.size.x and size.y == other.size.y;
+    }
+
+    Hash hash() const {
+        return Karm::hash(blur, radii.radii, fill.red, fill.green, fill.blue, fill.alpha, size.x, size.y);
+    }
+};
+
+// The shadow of a box just big enough for its corners not to overlap.
+// The middle row and column are stretched to fit the actual box.
+struct ShadowPatch {
+    Strong<Surface> surface;
+    isize corner; // Size of the corners, blur on both sides included
+};
+
+// Maximum number of shadows kept in the cache.
+static constexpr usize CAPACITY = 64;
+
+static Lock _lock;
+static Lru<ShadowKey, Strong<ShadowPatch>> _patches{CAPACITY};
+
+// NOTE: Math::ceil() rounds integers up too, which would make the
+//       patches one pixel bigger than they need to be.
+static isize _ceil(f64 v) {
+    isize i = v;
+    return i < v ? i + 1 : i;
+}
+
+static Strong<Surface> _render(Math::Vec2i size, isize blur, Math::Radiif radii, Color fill) {
+    auto surface = Surface::alloc(size);
+
+    // Transparent pixels take the color of the shadow so it
+    // doesn't get darker when blurred.
+    CpuCanvas g;
+    g.begin(*surface);
+    g.clear(fill.withOpacity(0));
+    g.beginPath();
+    g.rect(Math::Recti{blur, blur, size.x - blur * 2, size.y - blur * 2}.cast<f64>(), radii);
+    g.fillStyle(fill);
+    g.fill(FillRule::NONZERO);
+    g.apply(BlurFilter{(f64)blur});
+    g.end();
+
+    return surface;
+}
+
+static isize _corner(f64 blur, Math::Radiif radii) {
+    f64 radius = 0;
+    for (auto r : radii.radii)
+        radius = max(radius, r);
+    return _ceil(radius) + _ceil(blur) * 2;
+}
+
+static Strong<ShadowPatch> _patch(ShadowKey const &key) {
+    {
+        LockScope scope{_lock};
+        if (auto patch = _patches.tryGet(key))
+            return patch.take();
+    }
+
+    // Rendered without holding the lock so threads painting
+    // shadows that are already cached don't wait on the blur.
+    isize corner = _corner(key.blur, key.radii);
+    Math::Vec2i size = key.size;
+    if (size.x == 0 and size.y == 0)
+        size = {corner * 2 + 1, corner * 2 + 1};
+    auto patch = makeStrong<ShadowPatch>(
+        _render(size, _ceil(key.blur), key.radii, key.fill),
+        corner
+    );
+
+    // Another thread might have rendered the same shadow meanwhile
+    LockScope scope{_lock};
+    return _patches.access(key, [&] {
+        return patch;
+    });
+}
+
+// MARK: Gradients -------------------------------------------------------------
+
+// Approximate the shadow with gradients for canvases that can't blit
+// it, like PDFs, or that would blit it at the wrong place because they
+// are rotated or skewed.
+static void _fillGradients(Gfx::Canvas &g, Math::Recti bound, isize blur, Math::Radiif radii, Color fill) {
+    // 1 / sqrt(2)
+    static constexpr f64 IS2 = 0.7071067811865475;
+
+    // 1 - (1 / sqrt(2))
+    static constexpr f64 IS2M = 1 - IS2;
+
+    auto grad = Gradient::linear().withColors(fill, fill.withOpacity(0)).bake();
+
+    auto topStart = Math::Recti::fromTwoPoint(
+        bound.topStart(),
+        bound.topStart() - Math::Vec2i{blur, blur}
+    );
+
+    auto topEnd = Math::Recti::fromTwoPoint(
+        bound.topEnd(),
+        bound.topEnd() + Math::Vec2i{blur, -blur}
+    );
+
+    auto bottomStart = Math::Recti::fromTwoPoint(
+        bound.bottomStart(),
+        bound.bottomStart() + Math::Vec2i{-blur, blur}
+    );
+
+    auto bottomEnd = Math::Recti::fromTwoPoint(
+        bound.bottomEnd(),
+        bound.bottomEnd() + Math::Vec2i{blur, blur}
+    );
+
+    auto top = Math::Recti::fromTwoPoint(
+        bound.topStart() - Math::Vec2i{0, blur},
+        bound.topEnd()
+    );
+
+    auto bottom = Math::Recti::fromTwoPoint(
+        bound.bottomStart(),
+        bound.bottomEnd() + Math::Vec2i{0, blur}
+    );
+
+    auto start = Math::Recti::fromTwoPoint(
+        bound.topStart() - Math::Vec2i{blur, 0},
+        bound.bottomStart()
+    );
+
+    auto end = Math::Recti::fromTwoPoint(
+        bound.topEnd(),
+        bound.bottomEnd() + Math::Vec2i{blur, 0}
+    );
+
+    if (blur > 0) {
+        grad.withType(Gradient::RADIAL);
+        g.fillStyle(grad.withPoints({1, 1}, {IS2M, IS2M}));
+        g.fill(topStart);
+
+        g.fillStyle(grad.withPoints({0, 1}, {IS2, IS2M}));
+        g.fill(topEnd);
+
+        g.fillStyle(grad.withPoints({1, 0}, {IS2M, IS2}));
+        g.fill(bottomStart);
+
+        g.fillStyle(grad.withPoints({0, 0}, {IS2, IS2}));
+        g.fill(bottomEnd);
+
+        grad.withType(Gradient::LINEAR);
+        g.fillStyle(grad.withPoints({0, 1}, {0, 0}));
+        g.fill(top);
+
+        g.fillStyle(grad.withPoints({0, 0}, {0, 1}));
+        g.fill(bottom);
+
+        g.fillStyle(grad.withPoints({1, 0}, {0, 0}));
+        g.fill(start);
+
+        g.fillStyle(grad.withPoints({0, 0}, {1, 0}));
+        g.fill(end);
+    }
+
+    g.fillStyle(fill);
+    g.fill(bound, radii);
+}
+
+// MARK: Painting --------------------------------------------------------------
+
+void BoxShadow::paint(Gfx::Canvas &g, Math::Recti bound, Math::Radiif radii) const {
+    isize b = _ceil(blur);
+
+    // Like in CSS, the spread grows the radii of rounded corners only
+    for (auto &r : radii.radii)
+        if (r > 0)
+            r = max(r + spread, 0.0);
+
+    bound = bound.grow((isize)spread);
+    bound = bound.offset(offset);
+    if (bound.width <= 0 or bound.height <= 0)
+        return;
+
+    if (not g.canBlit()) {
+        _fillGradients(g, bound, b, radii, fill);
+        return;
+    }
+
+    auto dest = bound.grow(b);
+
+    isize c = _corner(blur, radii);
+
+    // Too small for the corners to fit, render it as is
+    if (dest.width < c * 2 + 1 or dest.height < c * 2 + 1) {
+        auto patch = _patch({blur, radii, fill, dest.wh});
+        g.blit(dest, *patch->surface, Sampling::BILINEAR);
+        return;
+    }
+
+    auto patch = _patch({blur, radii, fill});
+
+    isize const srcCuts[] = {0, c, c + 1, c * 2 + 1};
+    isize const xCuts[] = {dest.start(), dest.start() + c, dest.end() - c, dest.end()};
+    isize const yCuts[] = {dest.top(), dest.top() + c, dest.bottom() - c, dest.bottom()};
+
+    auto pixels = patch->surface->pixels();
+    for (usize y = 0; y < 3; y++) {
+        for (usize x = 0; x < 3; x++) {
+            auto src = Math::Recti::fromTwoPoint(
+                {srcCuts[x], srcCuts[y]},
+                {srcCuts[x + 1], srcCuts[y + 1]}
+            );
+
+            auto to = Math::Recti::fromTwoPoint(
+                {xCuts[x], yCuts[y]},
+                {xCuts[x + 1], yCuts[y + 1]}
+            );
+
+            if (to.width > 0 and to.height > 0)
+                g.blit(src, to, pixels, Sampling::BILINEAR);
+        }
+    }
+}
+
+} // namespace Karm::Gfx
@@ -39,87 +39,14 @@ struct BoxShadow {
         return *this;
     }
 
-    void paint(Gfx::Canvas &g, Math::Recti bound) const {
-        /// 1 / sqrt(2)
-        static constexpr f64 IS2 = 0.7071067811865475;
-
-        // 1 - (1 / sqrt(2))
-        static constexpr f64 IS2M = 1 - IS2;
-
-        bound = bound.grow(spread);
-        bound = bound.offset(offset);
-
-        auto grad = Gfx::Gradient::linear().withColors(fill, fill.withOpacity(0)).bake();
-
-        auto topStart = Math::Recti::fromTwoPoint(
-            bound.topStart(),
-            bound.topStart() - Math::Vec2i{(int)blur, (int)blur}
-        );
-
-        auto topEnd = Math::Recti::fromTwoPoint(
-            bound.topEnd(),
-            bound.topEnd() + Math::Vec2i{(int)blur, -(int)blur}
-        );
-
-        auto bottomStart = Math::Recti::fromTwoPoint(
-            bound.bottomStart(),
-            bound.bottomStart() + Math::Vec2i{-(int)blur, (int)blur}
-        );
-
-        auto bottomEnd = Math::Recti::fromTwoPoint(
-            bound.bottomEnd(),
-            bound.bottomEnd() + Math::Vec2i{(int)blur, (int)blur}
-        );
-
-        auto top = Math::Recti::fromTwoPoint(
-            bound.topStart() - Math::Vec2i{0, (int)blur},
-            bound.topEnd()
-        );
-
-        auto bottom = Math::Recti::fromTwoPoint(
-            bound.bottomStart(),
-            bound.bottomEnd() + Math::Vec2i{0, (int)blur}
-        );
-
-        auto start = Math::Recti::fromTwoPoint(
-            bound.topStart() - Math::Vec2i{(int)blur, 0},
-            bound.bottomStart()
-        );
-
-        auto end = Math::Recti::fromTwoPoint(
-            bound.topEnd(),
-            bound.bottomEnd() + Math::Vec2i{(int)blur, 0}
-        );
-
-        grad.withType(Gradient::RADIAL);
-        g.fillStyle(grad.withPoints({1, 1}, {IS2M, IS2M}));
-        g.fill(topStart);
-
-        g.fillStyle(grad.withPoints({0, 1}, {IS2, IS2M}));
-        g.fill(topEnd);
-
-        g.fillStyle(grad.withPoints({1, 0}, {IS2M, IS2}));
-        g.fill(bottomStart);
-
-        g.fillStyle(grad.withPoints({0, 0}, {IS2, IS2}));
-        g.fill(bottomEnd);
-
-        grad.withType(Gradient::LINEAR);
-        g.fillStyle(grad.withPoints({0, 1}, {0, 0}));
-        g.fill(top);
-
-        g.fillStyle(grad.withPoints({0, 0}, {0, 1}));
-        g.fill(bottom);
-
-        g.fillStyle(grad.withPoints({1, 0}, {0, 0}));
-        g.fill(start);
-
-        g.fillStyle(grad.withPoints({0, 0}, {1, 0}));
-        g.fill(end);
-
-        g.fillStyle(fill);
-        g.fill(bound);
-    }
+    // Paint the shadow of a box with the given corner radii.
+    //
+    // NOTE: The shadow is blitted from a blurred nine-patch, cached by
+    //       everything but the size of the box. Boxes too small for
+    //       the patch are rendered whole and cached by size too.
+    //       Canvases that can't blit get an approximation made of
+    //       gradients instead.
+    void paint(Gfx::Canvas &g, Math::Recti bound, Math::Radiif radii = 0) const;
 };
 
 Gfx::BoxShadow boxShadow(auto... args) {
@@ -7,4 +7,13 @@ enum struct FillRule {
     EVENODD,
 };
 
+// How an image is sampled when it's scaled.
+enum struct Sampling {
+    NEAREST,  // Pick the closest pixel
+    BILINEAR, // Interpolate between the four closest pixels
+    MIPMAP,   // Box-filter down to the closest size, then interpolate
+              // NOTE: The levels are rebuilt on every blit, see Mipmap
+              //       for images that get drawn more than once
+};
+
 } // namespace Karm::Gfx
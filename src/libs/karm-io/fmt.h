@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/atom.h>
 #include <karm-base/backtrace.h>
 #include <karm-base/box.h>
 #include <karm-base/cow.h>
@@ -832,7 +833,7 @@ struct Formatter<Map<K, V>> {
         }
     }
 
-    Res<usize> format(Io::TextWriter &writer, Map<K, V> const &val) {
+    Res<usize> format(Io::TextWriter &writer, auto const &val) {
         usize written = 0;
         written += try$(writer.writeStr("{"s));
         bool first = true;
@@ -849,6 +850,9 @@ struct Formatter<Map<K, V>> {
     }
 };
 
+template <typename K, typename V>
+struct Formatter<OrderedMap<K, V>> : public Formatter<Map<K, V>> {};
+
 // MARK: Format Range ----------------------------------------------------------
 
 template <typename T, typename Tag>
@@ -934,6 +938,13 @@ struct Formatter<_String<E>> : public StringFormatter<E> {
 template <usize N>
 struct Formatter<StrLit<N>> : public StringFormatter<Utf8> {};
 
+template <>
+struct Formatter<Atom> : public StringFormatter<Utf8> {
+    Res<usize> format(Io::TextWriter &writer, Atom atom) {
+        return StringFormatter::format(writer, atom.str());
+    }
+};
+
 template <>
 struct Formatter<char const *> : public StringFormatter<Utf8> {
     Res<usize> format(Io::TextWriter &writer, char const *text) {
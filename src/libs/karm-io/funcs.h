@@ -2,6 +2,7 @@
 
 #include <karm-base/clamp.h>
 #include <karm-base/cons.h>
+#include <karm-base/limits.h>
 #include <karm-base/rune.h>
 #include <karm-base/string.h>
 
@@ -22,19 +23,6 @@ inline Res<Byte> getByte(Readable auto &reader) {
     return Ok(byte);
 }
 
-inline Res<String> readAllUtf8(Readable auto &reader) {
-    StringWriter writer;
-    Array<Utf8::Unit, 512> buf;
-    while (true) {
-        usize read = try$(reader.read(buf.mutBytes()));
-        if (read == 0) {
-            break;
-        }
-        try$(writer.writeUnit({buf.buf(), read}));
-    }
-    return Ok(writer.take());
-}
-
 // MARK: Write -----------------------------------------------------------------
 
 inline Res<usize> pwrite(Writable auto &writer, Bytes bytes, Seek seek) {
@@ -68,6 +56,57 @@ inline Res<usize> skip(Readable auto &reader, usize n) {
     return copy(reader, sink, n);
 }
 
+// MARK: Utf8 ------------------------------------------------------------------
+
+// Re-encode `str`, replacing its ill-formed sequences by U+FFFD.
+inline String _fixupUtf8(Str str) {
+    StringBuilder builder{str.len()};
+    Cursor<Utf8::Unit> in{str};
+    Array<Rune, 256> runes;
+    while (not in.ended()) {
+        usize n = Utf8::decode(in, runes);
+        builder.append(sub(runes, 0, n));
+    }
+    return builder.take();
+}
+
+/// Read the remaining of `reader` as an UTF-8 string, ill-formed
+/// sequences are replaced by U+FFFD so the result is always valid.
+inline Res<String> readAllUtf8(Readable auto &reader) {
+    // When the size is known up front, everything is read
+    // in one go straight into the string.
+    // NOTE: The extra unit is for the final read that returns 0
+    //       and the null-terminator, so the buffer never has to grow.
+    usize cap = 4096;
+    if constexpr (Seekable<decltype(reader)>) {
+        auto curr = tell(reader);
+        auto end = size(reader);
+        if (curr and end and end.unwrap() > curr.unwrap())
+            cap = end.unwrap() - curr.unwrap() + 1;
+    }
+
+    StringBuilder builder{cap};
+    auto &buf = builder._buf;
+    while (true) {
+        if (buf.len() == buf.cap())
+            buf.ensure(buf.cap() * 2);
+
+        usize read = try$(reader.read({
+            reinterpret_cast<Byte *>(buf.buf() + buf.len()),
+            buf.cap() - buf.len(),
+        }));
+
+        if (read == 0)
+            break;
+        buf._len += read;
+    }
+
+    if (not Utf8::validate(builder.str())) [[unlikely]]
+        return Ok(_fixupUtf8(builder.str()));
+
+    return Ok(builder.take());
+}
+
 // MARK: Copy ------------------------------------------------------------------
 
 inline Res<usize> copy(Readable auto &reader, MutBytes bytes) {
@@ -78,7 +117,21 @@ inline Res<usize> copy(Readable auto &reader, MutBytes bytes) {
     return Ok(readed);
 }
 
+// Readers and writers can provide a `copyDirect(reader, writer, size)`,
+// found by ADL, to move bytes without going through a buffer, like the
+// kernel sending a file straight to a socket. It returns NONE when it
+// can't do it for these two and the copy goes through a buffer.
+template <typename R, typename W>
+concept _CopyDirect = requires(R &reader, W &writer, usize size) {
+    { copyDirect(reader, writer, size) } -> Meta::Same<Opt<Res<usize>>>;
+};
+
 inline Res<usize> copy(Readable auto &reader, Writable auto &writer) {
+    if constexpr (_CopyDirect<decltype(reader), decltype(writer)>) {
+        if (auto res = copyDirect(reader, writer, Limits<usize>::MAX))
+            return res.take();
+    }
+
     Array<Byte, 4096> buffer;
     usize result = 0;
     while (true) {
@@ -96,6 +149,11 @@ inline Res<usize> copy(Readable auto &reader, Writable auto &writer) {
 }
 
 inline Res<usize> copy(Readable auto &reader, Writable auto &writer, usize size) {
+    if constexpr (_CopyDirect<decltype(reader), decltype(writer)>) {
+        if (auto res = copyDirect(reader, writer, size))
+            return res.take();
+    }
+
     Array<Byte, 4096> buf;
     usize result = 0;
     while (size > 0) {
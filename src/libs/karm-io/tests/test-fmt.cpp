@@ -178,7 +178,7 @@ test$("fmt-sliceable") {
 // MARK: Format Map ------------------------------------------------------------
 
 test$("fmt-map") {
-    Map<int, int> map;
+    OrderedMap<int, int> map;
     map.put(1, 2);
     map.put(3, 4);
 
@@ -0,0 +1,31 @@
+#include <karm-io/funcs.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Io::Tests {
+
+test$("read-all-utf8") {
+    Str str = "héllo wörld"s;
+    BufReader reader{bytes(str)};
+    expectEq$(try$(readAllUtf8(reader)), "héllo wörld"s);
+
+    return Ok();
+}
+
+test$("read-all-utf8-remaining") {
+    Str str = "hello world"s;
+    BufReader reader{bytes(str)};
+    try$(reader.seek(Seek::fromBegin(6)));
+    expectEq$(try$(readAllUtf8(reader)), "world"s);
+
+    return Ok();
+}
+
+test$("read-all-utf8-ill-formed") {
+    Str str = "a\xff" "b"s;
+    BufReader reader{bytes(str)};
+    expectEq$(try$(readAllUtf8(reader)), "a�b"s);
+
+    return Ok();
+}
+
+} // namespace Karm::Io::Tests
@@ -21,7 +21,7 @@ Res<> stringify(Io::Emit &emit, Value const &v) {
 
                 return Ok();
             },
-            [&](Map<String, Value> const &m) -> Res<> {
+            [&](Object const &m) -> Res<> {
                 emit('{');
                 bool first = true;
                 for (auto const &kv : m.iter()) {
@@ -13,7 +13,7 @@ struct Value;
 
 using Array = Vec<Value>;
 
-using Object = Map<String, Value>;
+using Object = OrderedMap<String, Value>;
 
 using Integer = isize;
 
@@ -153,7 +153,7 @@ struct Value {
                 [](Vec<Value>) -> String {
                     return "<array>"s;
                 },
-                [](Map<String, Value>) -> String {
+                [](Object) -> String {
                     return "<object>"s;
                 },
                 [](String s) -> String {
@@ -227,7 +227,7 @@ struct Value {
                 [](Vec<Value> v) {
                     return v.len() > 0;
                 },
-                [](Map<String, Value> m) {
+                [](Object m) {
                     return m.len() > 0;
                 },
                 [](String s) {
@@ -273,7 +273,7 @@ struct Value {
                 [](Vec<Value> v) {
                     return v.len();
                 },
-                [](Map<String, Value> m) {
+                [](Object m) {
                     return m.len();
                 },
                 [](String s) {
@@ -52,6 +52,30 @@ always_inline static auto indexCast(usize index, auto *ptr, auto func) {
     return _IndexCast<RemoveRef<decltype(*ptr)>, Ts...>::eval(index, ptr, func);
 }
 
+template <typename...>
+struct _IndexType;
+
+template <typename T>
+struct _IndexType<T> {
+    always_inline static auto eval(usize, auto func) {
+        return func(Type<T>{});
+    }
+};
+
+template <typename T, typename... Ts>
+struct _IndexType<T, Ts...> {
+    always_inline static auto eval(usize index, auto func) {
+        return index == 0 ? func(Type<T>{})
+                          : _IndexType<Ts...>::eval(index - 1, func);
+    }
+};
+
+// Call `func` with the type at `index` in the pack.
+template <typename... Ts>
+always_inline static auto indexType(usize index, auto func) {
+    return _IndexType<Ts...>::eval(index, func);
+}
+
 template <typename...>
 struct _Any;
 
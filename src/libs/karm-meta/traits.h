@@ -66,6 +66,9 @@ concept Pod = Trivial<T> and StandardLayout<T>;
 template <typename T>
 concept TrivialyCopyable = __is_trivially_copyable(T);
 
+template <typename T>
+concept TrivialyDestructible = __is_trivially_destructible(T);
+
 template <typename T>
 concept Agregate = __is_aggregate(T);
 
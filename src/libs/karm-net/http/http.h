@@ -4,6 +4,7 @@
 #include <karm-base/map.h>
 #include <karm-io/fmt.h>
 #include <karm-mime/url.h>
+#include <karm-sys/socket.h>
 
 namespace Karm::Net::Http {
 
@@ -92,7 +93,7 @@ static inline CodeClass codeClass(Code code) {
     u16 value = static_cast<u16>(code);
     if (value < 100 or value > 599)
         return CodeClass::UNKNOWN;
-    return static_cast<CodeClass>(value);
+    return static_cast<CodeClass>(value / 100);
 }
 
 static inline Res<Code> parseCode(Io::SScan &s) {
@@ -172,9 +173,110 @@ struct Version {
 };
 
 struct Header {
-    Map<Str, Str> headers;
+    OrderedMap<Str, Str> headers;
+
+    // Field names are case-insensitive, see RFC 9110 section 5.1
+    Opt<Str> tryGet(Str name) const {
+        for (auto const &[key, value] : headers.iter())
+            if (eqCi(key, name))
+                return value;
+        return NONE;
+    }
+
+    // Whether `Connection` lists `option`, it holds a comma separated
+    // list of case-insensitive tokens, see RFC 9110 section 7.6.1
+    bool _hasConnectionOption(Str option) const {
+        auto connection = tryGet("Connection");
+        if (not connection)
+            return false;
+
+        Io::SScan s{connection.unwrap()};
+        while (not s.ended()) {
+            Str token;
+            s.eat(Re::space());
+            s.skip(Re::token(token, Re::until(Re::single(',') | Re::space())));
+            s.eat(Re::space());
+            s.skip(',');
+
+            if (eqCi(token, option))
+                return true;
+        }
+
+        return false;
+    }
+
+    // Whether the connection stays open after this message,
+    // which is the default since HTTP/1.1, see RFC 9112 section 9.3
+    bool _keepAlive(Version version) const {
+        if (version.major == 1 and version.minor == 0)
+            return _hasConnectionOption("keep-alive"s);
+        return not _hasConnectionOption("close"s);
+    }
+
+    // Whether `Accept-Encoding` takes `coding`, an entry naming it wins
+    // over `*` and a zero quality is a refusal, see RFC 9110 section 12.5.3
+    bool acceptsEncoding(Str coding) const {
+        auto accept = tryGet("Accept-Encoding");
+        if (not accept)
+            return false;
+
+        auto RE_REFUSED =
+            Re::zeroOrMore(Re::space()) &
+            ";"_re &
+            Re::zeroOrMore(Re::space()) &
+            Re::single('q', 'Q') &
+            "=0"_re &
+            Re::zeroOrOne("."_re & Re::zeroOrMore("0"_re)) &
+            Re::zeroOrMore(Re::space()) &
+            Re::eof();
+
+        bool wildcard = false;
+        Io::SScan s{accept.unwrap()};
+        while (not s.ended()) {
+            Str name, params;
+            s.eat(Re::space());
+            s.skip(Re::token(name, Re::until(Re::single(',', ';') | Re::space())));
+            s.skip(Re::token(params, Re::until(","_re)));
+            s.skip(',');
+
+            Io::SScan p{params};
+            if (eqCi(name, coding))
+                return not p.skip(RE_REFUSED);
+            if (name == "*")
+                wildcard = not p.skip(RE_REFUSED);
+        }
+
+        return wildcard;
+    }
+
+    // Whether `If-None-Match` lists `etag` or is `*`, with the
+    // weak comparison, see RFC 9110 section 13.1.2
+    bool matchesEtag(Str etag) const {
+        auto match = tryGet("If-None-Match");
+        if (not match)
+            return false;
+
+        Io::SScan s{match.unwrap()};
+        while (not s.ended()) {
+            Str tag;
+            s.eat(Re::space());
+            s.skip("W/");
+            s.skip(Re::token(tag, Re::until(Re::single(',') | Re::space())));
+            s.eat(Re::space());
+            s.skip(',');
+
+            if (tag == "*" or tag == etag)
+                return true;
+        }
+
+        return false;
+    }
 
     Res<> _parse(Io::SScan &s) {
+        // No header fields at all
+        if (s.skip("\r\n"))
+            return Ok();
+
         while (not s.ended()) {
             Str key, value;
 
@@ -239,6 +341,10 @@ struct Request : public Header {
 
         return Ok(req);
     }
+
+    bool keepAlive() const {
+        return _keepAlive(version);
+    }
 };
 
 struct Response : public Header {
@@ -264,8 +370,32 @@ struct Response : public Header {
 
         return Ok(res);
     }
+
+    bool keepAlive() const {
+        return _keepAlive(version);
+    }
 };
 
+// Where the header at the start of `buf` ends, just past
+// the blank line, or NONE when it isn't all there yet.
+static inline Opt<usize> endOfHeader(Bytes buf) {
+    for (usize i = 0; i + 4 <= buf.len(); i++)
+        if (buf[i] == '\r' and buf[i + 1] == '\n' and buf[i + 2] == '\r' and buf[i + 3] == '\n')
+            return i + 4;
+    return NONE;
+}
+
+// Write all of `bytes`, the connection might take them in several writes.
+static inline Async::Task<> writeAllAsync(Sys::_Connection &conn, Bytes bytes) {
+    while (bytes.len()) {
+        auto written = co_trya$(conn.writeAsync(bytes));
+        if (written == 0)
+            co_return Error::writeZero();
+        bytes = next(bytes, written);
+    }
+    co_return Ok();
+}
+
 } // namespace Karm::Net::Http
 
 template <>
@@ -0,0 +1,178 @@
+#include <karm-net/http/http.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Net::Http::Tests {
+
+static Res<Request> _parseRequest(Str str) {
+    Io::SScan s{str};
+    return Request::parse(s);
+}
+
+test$("karm-net-http-request-parse") {
+    auto req = try$(_parseRequest(
+        "GET /index.html HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "Accept: */*\r\n"
+        "\r\n"
+    ));
+
+    expect$(req.method == Method::GET);
+    expectEq$(req.path.str(), "index.html"s);
+    expectEq$(req.version.major, 1);
+    expectEq$(req.version.minor, 1);
+    expectEq$(req.tryGet("Host"), "example.com"s);
+    expectEq$(req.tryGet("Accept"), "*/*"s);
+
+    return Ok();
+}
+
+test$("karm-net-http-request-no-header-fields") {
+    auto req = try$(_parseRequest("GET / HTTP/1.0\r\n\r\n"));
+
+    expectEq$(req.headers.len(), 0uz);
+    expect$(not req.tryGet("Host"));
+    expect$(not req.keepAlive());
+
+    return Ok();
+}
+
+test$("karm-net-http-header-case-insensitive") {
+    auto req = try$(_parseRequest(
+        "GET / HTTP/1.1\r\n"
+        "content-LENGTH: 42\r\n"
+        "\r\n"
+    ));
+
+    expectEq$(req.tryGet("Content-Length"), "42"s);
+    expectEq$(req.tryGet("content-length"), "42"s);
+    expectEq$(req.tryGet("CONTENT-LENGTH"), "42"s);
+    expect$(not req.tryGet("Content-Type"));
+
+    return Ok();
+}
+
+test$("karm-net-http-keep-alive-http-1-1") {
+    auto req = try$(_parseRequest("GET / HTTP/1.1\r\n\r\n"));
+    expect$(req.keepAlive());
+
+    req = try$(_parseRequest("GET / HTTP/1.1\r\nConnection: close\r\n\r\n"));
+    expect$(not req.keepAlive());
+
+    req = try$(_parseRequest("GET / HTTP/1.1\r\nConnection: TE, close\r\n\r\n"));
+    expect$(not req.keepAlive());
+
+    req = try$(_parseRequest("GET / HTTP/1.1\r\nconnection: TE,Close\r\n\r\n"));
+    expect$(not req.keepAlive());
+
+    req = try$(_parseRequest("GET / HTTP/1.1\r\nConnection: Keep-Alive, TE\r\n\r\n"));
+    expect$(req.keepAlive());
+
+    req = try$(_parseRequest("GET / HTTP/1.1\r\nConnection: closed\r\n\r\n"));
+    expect$(req.keepAlive());
+
+    return Ok();
+}
+
+test$("karm-net-http-keep-alive-http-1-0") {
+    auto req = try$(_parseRequest("GET / HTTP/1.0\r\n\r\n"));
+    expect$(not req.keepAlive());
+
+    req = try$(_parseRequest("GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n"));
+    expect$(req.keepAlive());
+
+    req = try$(_parseRequest("GET / HTTP/1.0\r\nConnection: Keep-Alive, TE\r\n\r\n"));
+    expect$(req.keepAlive());
+
+    req = try$(_parseRequest("GET / HTTP/1.0\r\nConnection: TE, close\r\n\r\n"));
+    expect$(not req.keepAlive());
+
+    return Ok();
+}
+
+test$("karm-net-http-accepts-encoding") {
+    auto accepts = [](Str field) -> Res<bool> {
+        Io::StringWriter req;
+        try$(Io::format(req, "GET / HTTP/1.1\r\nAccept-Encoding: {}\r\n\r\n", field));
+        auto str = req.take();
+        return Ok(try$(_parseRequest(str)).acceptsEncoding("gzip"s));
+    };
+
+    expect$(try$(accepts("gzip")));
+    expect$(try$(accepts("deflate, GZIP")));
+    expect$(try$(accepts("gzip;q=0.5")));
+    expect$(try$(accepts("*")));
+    expect$(try$(accepts("*;q=0, gzip")));
+    expect$(try$(accepts("gzip, *;q=0")));
+    expectNot$(try$(accepts("deflate")));
+    expectNot$(try$(accepts("gzip;q=0")));
+    expectNot$(try$(accepts("gzip ; Q=0.000")));
+    expectNot$(try$(accepts("*;q=0")));
+    expectNot$(try$(accepts("*, gzip;q=0")));
+    expectNot$(try$(accepts("x-gzip")));
+
+    auto req = try$(_parseRequest("GET / HTTP/1.1\r\n\r\n"));
+    expectNot$(req.acceptsEncoding("gzip"s));
+
+    return Ok();
+}
+
+test$("karm-net-http-matches-etag") {
+    auto matches = [](Str field) -> Res<bool> {
+        Io::StringWriter req;
+        try$(Io::format(req, "GET / HTTP/1.1\r\nIf-None-Match: {}\r\n\r\n", field));
+        auto str = req.take();
+        return Ok(try$(_parseRequest(str)).matchesEtag("\"abc\""s));
+    };
+
+    expect$(try$(matches("\"abc\"")));
+    expect$(try$(matches("W/\"abc\"")));
+    expect$(try$(matches("\"xyz\", \"abc\"")));
+    expect$(try$(matches("\"xyz\",W/\"abc\"")));
+    expect$(try$(matches("*")));
+    expectNot$(try$(matches("\"xyz\"")));
+    expectNot$(try$(matches("abc")));
+    expectNot$(try$(matches("\"abcd\"")));
+
+    auto req = try$(_parseRequest("GET / HTTP/1.1\r\n\r\n"));
+    expectNot$(req.matchesEtag("\"abc\""s));
+
+    return Ok();
+}
+
+test$("karm-net-http-response-parse") {
+    Io::SScan s{
+        "HTTP/1.1 404 Not Found\r\n"
+        "Content-Length: 0\r\n"
+        "Connection: TE, close\r\n"
+        "\r\n"
+    };
+    auto res = try$(Response::parse(s));
+
+    expect$(res.code == Code::NOT_FOUND);
+    expectEq$(res.tryGet("content-length"), "0"s);
+    expect$(not res.keepAlive());
+
+    return Ok();
+}
+
+test$("karm-net-http-code-class") {
+    expect$(codeClass(Code::UNKNOWN) == CodeClass::UNKNOWN);
+    expect$(codeClass(Code::CONTINUE) == CodeClass::INFORMATIONAL);
+    expect$(codeClass(Code::OK) == CodeClass::SUCCESS);
+    expect$(codeClass(Code::NOT_MODIFIED) == CodeClass::REDIRECTION);
+    expect$(codeClass(Code::NOT_FOUND) == CodeClass::CLIENT_ERROR);
+    expect$(codeClass(Code::NETWORK_AUTHENTICATION_REQUIRED) == CodeClass::SERVER_ERROR);
+    expect$(codeClass(static_cast<Code>(99)) == CodeClass::UNKNOWN);
+    expect$(codeClass(static_cast<Code>(600)) == CodeClass::UNKNOWN);
+
+    return Ok();
+}
+
+test$("karm-net-http-end-of-header") {
+    expectEq$(endOfHeader(bytes("GET / HTTP/1.1\r\n\r\nbody"s)), 18uz);
+    expect$(not endOfHeader(bytes("GET / HTTP/1.1\r\nHost: a\r\n"s)));
+
+    return Ok();
+}
+
+} // namespace Karm::Net::Http::Tests
@@ -178,7 +178,7 @@ void Canvas::plot(Math::Recti, Gfx::Color) {
 
 // MARK: Blit Operations ---------------------------------------------------
 
-void Canvas::blit(Math::Recti, Math::Recti, Gfx::Pixels) {
+void Canvas::blit(Math::Recti, Math::Recti, Gfx::Pixels, Gfx::Sampling) {
     logDebug("pdf: blit() operation not implemented");
 }
 
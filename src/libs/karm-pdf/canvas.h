@@ -106,7 +106,7 @@ struct Canvas : public Gfx::Canvas {
 
     // MARK: Blit Operations ---------------------------------------------------
 
-    void blit(Math::Recti src, Math::Recti dest, Gfx::Pixels pixels) override;
+    void blit(Math::Recti src, Math::Recti dest, Gfx::Pixels pixels, Gfx::Sampling sampling = Gfx::Sampling::NEAREST) override;
 
     // MARK: Filter Operations -------------------------------------------------
 };
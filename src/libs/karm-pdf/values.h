@@ -17,6 +17,10 @@ struct Ref {
 
     bool operator==(Ref const &other) const = default;
     auto operator<=>(Ref const &other) const = default;
+
+    Hash hash() const {
+        return Karm::hash(num, gen);
+    }
 };
 
 struct Name : public String {
@@ -25,7 +29,7 @@ struct Name : public String {
 
 using Array = Vec<Value>;
 
-using Dict = Map<Name, Value>;
+using Dict = OrderedMap<Name, Value>;
 
 struct Stream {
     Dict dict;
@@ -53,7 +57,7 @@ struct Value : public _Value {
 
 struct File {
     String header;
-    Map<Ref, Value> body;
+    OrderedMap<Ref, Value> body;
     Dict trailer;
 
     Ref add(Ref ref, Value Value) {
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <karm-gfx/cpu/canvas.h>
+#include <karm-gfx/cpu/tiled.h>
 #include <karm-image/saver.h>
 #include <karm-print/file-printer.h>
 
@@ -10,7 +10,7 @@ struct ImagePrinter : public FilePrinter {
     static constexpr isize GAPS = 16;
 
     Vec<Strong<Gfx::Surface>> _pages;
-    Opt<Gfx::CpuCanvas> _canvas;
+    Opt<Gfx::CpuTiledCanvas> _canvas;
     f64 _density;
     Image::Saver _saver;
 
@@ -23,7 +23,7 @@ struct ImagePrinter : public FilePrinter {
 
         if (_canvas)
             _canvas->end();
-        _canvas = Gfx::CpuCanvas{};
+        _canvas = Gfx::CpuTiledCanvas{};
         _canvas->begin(*last(_pages));
         _canvas->scale(_density);
         _canvas->clear(Gfx::WHITE);
@@ -78,6 +78,11 @@ struct ImagePrinter : public FilePrinter {
     }
 
     Res<> write(Io::Writer &w) override {
+        if (_canvas) {
+            _canvas->end();
+            _canvas = NONE;
+        }
+
         return Image::save(
             _mergedImages()->pixels(),
             w,
@@ -9,6 +9,7 @@ namespace Karm::Scene {
 struct Image : public Node {
     Math::Rectf _bound;
     ::Image::Picture _picture;
+    Opt<Gfx::Mipmap> _mipmap = NONE; // Built on the first paint
 
     Image(Math::Rectf bound, ::Image::Picture picture)
         : _bound(bound), _picture(std::move(picture)) {
@@ -22,7 +23,9 @@ struct Image : public Node {
         if (not r.colide(bound()))
             return;
 
-        ctx.blit(_bound.cast<isize>(), _picture.pixels());
+        if (not _mipmap)
+            _mipmap = Gfx::Mipmap::build(_picture._surface);
+        ctx.blit(_bound.cast<isize>(), *_mipmap);
     }
 
     void repr(Io::Emit &e) const override {
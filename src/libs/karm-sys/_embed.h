@@ -1,6 +1,7 @@
 #pragma once
 
 #include <karm-base/cons.h>
+#include <karm-base/func.h>
 #include <karm-base/range.h>
 #include <karm-base/time.h>
 #include <karm-mime/uti.h>
@@ -15,6 +16,10 @@ namespace Karm::Sys {
 
 struct Intent;
 
+struct Thread;
+
+struct Sema;
+
 } // namespace Karm::Sys
 
 namespace Karm::Sys::_Embed {
@@ -33,6 +38,8 @@ Res<Strong<Sys::Fd>> openOrCreateFile(Mime::Url const &url);
 
 Res<Cons<Strong<Sys::Fd>, Strong<Sys::Fd>>> createPipe();
 
+Res<usize> transfer(Strong<Sys::Fd> from, Strong<Sys::Fd> to, usize size);
+
 Res<Strong<Sys::Fd>> createIn();
 
 Res<Strong<Sys::Fd>> createOut();
@@ -59,6 +66,8 @@ Res<Strong<Sys::Fd>> listenTcp(SocketAddr addr);
 
 Res<Strong<Sys::Fd>> listenIpc(Mime::Url url);
 
+Res<> shutdown(Strong<Sys::Fd> fd);
+
 // MARK: Time ------------------------------------------------------------------
 
 TimeStamp now();
@@ -95,6 +104,20 @@ Res<> sleepUntil(TimeStamp);
 
 Res<> exit(i32);
 
+// MARK: Threads ---------------------------------------------------------------
+
+Res<Strong<Sys::Thread>> spawnThread(Func<void()> fn);
+
+usize concurrency();
+
+Res<Strong<Sys::Sema>> createSema(usize count);
+
+// The thread pool worker running on the calling thread, targets
+// without threads can keep it in a plain global.
+void *currentWorker();
+
+void setCurrentWorker(void *worker);
+
 // MARK: Sandboxing ------------------------------------------------------------
 
 void hardenSandbox();
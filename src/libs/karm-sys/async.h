@@ -26,6 +26,21 @@ struct Sched :
 
     virtual Async::Task<usize> flushAsync(Strong<Fd>) = 0;
 
+    // Positional and vectored I/O, these don't
+    // move the file position, so they can overlap.
+
+    virtual Async::Task<usize> preadAsync(Strong<Fd>, MutBytes, usize offset) = 0;
+
+    virtual Async::Task<usize> pwriteAsync(Strong<Fd>, Bytes, usize offset) = 0;
+
+    virtual Async::Task<usize> readvAsync(Strong<Fd>, Slice<MutBytes>, usize offset) = 0;
+
+    virtual Async::Task<usize> writevAsync(Strong<Fd>, Slice<Bytes>, usize offset) = 0;
+
+    // Move bytes from a file starting at `offset` to another
+    // descriptor, without copying them through user space.
+    virtual Async::Task<usize> transferAsync(Strong<Fd> from, Strong<Fd> to, usize offset, usize size) = 0;
+
     virtual Async::Task<_Accepted> acceptAsync(Strong<Fd>) = 0;
 
     virtual Async::Task<_Sent> sendAsync(Strong<Fd>, Bytes, Slice<Handle>, SocketAddr) = 0;
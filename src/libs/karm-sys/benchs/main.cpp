@@ -0,0 +1,94 @@
+#include <karm-async/promise.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/socket.h>
+#include <karm-sys/time.h>
+
+// Loopback echo: every client sends a small message and waits for it to
+// come back, over and over, so the time is spent in the scheduler rather
+// than in the network.
+
+static constexpr usize CLIENTS = 64;
+static constexpr usize ROUNDS = 2000;
+static constexpr usize MSG_LEN = 64;
+
+static Async::Task<> echoAsync(Sys::TcpConnection conn) {
+    Array<u8, 4096> buf;
+    while (true) {
+        auto len = co_trya$(conn.readAsync(mutBytes(buf)));
+        if (len == 0)
+            co_return Ok();
+
+        usize off = 0;
+        while (off < len)
+            off += co_trya$(conn.writeAsync(sub(bytes(buf), off, len)));
+    }
+}
+
+static Async::Task<> serveAsync(Sys::TcpListener &listener) {
+    for (usize i = 0; i < CLIENTS; i++)
+        Async::detach(echoAsync(co_trya$(listener.acceptAsync())));
+    co_return Ok();
+}
+
+static Async::Task<> pingAsync(Sys::TcpConnection conn) {
+    Array<u8, MSG_LEN> msg;
+    Array<u8, MSG_LEN> buf;
+    for (usize i = 0; i < MSG_LEN; i++)
+        msg[i] = i;
+
+    for (usize i = 0; i < ROUNDS; i++) {
+        co_trya$(conn.writeAsync(bytes(msg)));
+
+        usize got = 0;
+        while (got < MSG_LEN) {
+            auto len = co_trya$(conn.readAsync(mutNext(buf, got)));
+            if (len == 0)
+                co_return Error::unexpectedEof("server hung up");
+            got += len;
+        }
+    }
+    co_return Ok();
+}
+
+// Run all the clients at once and wait for the last one.
+static Async::Task<> pingAllAsync(Vec<Sys::TcpConnection> conns) {
+    struct State {
+        usize remaining;
+        Res<> res = Ok();
+        Async::Promise<> done;
+    };
+
+    State state{conns.len()};
+    auto future = state.done.future();
+    for (auto &conn : conns) {
+        Async::detach(pingAsync(std::move(conn)), [s = &state](Res<> res) {
+            if (not res)
+                s->res = res;
+            if (--s->remaining == 0)
+                s->done.resolve(Ok());
+        });
+    }
+
+    co_trya$(future);
+    co_return state.res;
+}
+
+Async::Task<> entryPointAsync(Sys::Context &) {
+    auto listener = co_try$(Sys::TcpListener::listen(Sys::Ip4::localhost(9090)));
+
+    Vec<Sys::TcpConnection> conns;
+    for (usize i = 0; i < CLIENTS; i++)
+        conns.pushBack(co_try$(Sys::TcpConnection::connect(listener.addr())));
+
+    co_trya$(serveAsync(listener));
+
+    auto start = Sys::now();
+    co_trya$(pingAllAsync(std::move(conns)));
+    auto elapsed = Sys::now() - start;
+
+    usize trips = CLIENTS * ROUNDS;
+    Sys::println("echo: {} clients, {} round trips of {} bytes", CLIENTS, trips, MSG_LEN);
+    Sys::println("  elapsed: {}", elapsed);
+    Sys::println("  round trips/s: {}", (usize)(trips / (elapsed.toUSecs() / 1e6)));
+    co_return Ok();
+}
@@ -8,6 +8,20 @@ Res<Strong<Fd>> Fd::unpack(Io::PackScan &s) {
     return _Embed::unpackFd(s);
 }
 
+Res<usize> transfer(Strong<Fd> from, Strong<Fd> to, usize size) {
+    return _Embed::transfer(from, to, size);
+}
+
+Opt<Res<usize>> _copyDirect(Opt<Strong<Fd>> from, Opt<Strong<Fd>> to, usize size) {
+    if (not from or not to)
+        return NONE;
+
+    auto res = transfer(from.take(), to.take(), size);
+    if (not res and res.none() == Error::NOT_IMPLEMENTED)
+        return NONE;
+    return res;
+}
+
 Res<usize> NullFd::read(MutBytes) {
     return Ok(0uz);
 }
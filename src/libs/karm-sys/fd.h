@@ -78,4 +78,30 @@ concept AsFd = requires(T t) {
     { t.fd() } -> Meta::Same<Strong<Fd>>;
 };
 
+// MARK: Direct Transfer -------------------------------------------------------
+
+// Move up to `size` bytes from `from` to `to` without copying them
+// through user space, stops early at the end of `from`. Fails with
+// NOT_IMPLEMENTED when the system can't do it for these two.
+Res<usize> transfer(Strong<Fd> from, Strong<Fd> to, usize size);
+
+// The descriptor behind `t`, if the bytes read from
+// or written to it go through unchanged.
+Opt<Strong<Fd>> directFd(auto &t) {
+    if constexpr (requires { { t.directFd() } -> Meta::Same<Opt<Strong<Fd>>>; })
+        return t.directFd();
+    else if constexpr (AsFd<decltype(t)>)
+        return t.fd();
+    else
+        return NONE;
+}
+
+Opt<Res<usize>> _copyDirect(Opt<Strong<Fd>> from, Opt<Strong<Fd>> to, usize size);
+
+// Picked up by Io::copy(), falls back on a
+// plain copy when there is no direct way.
+Opt<Res<usize>> copyDirect(auto &reader, auto &writer, usize size) {
+    return _copyDirect(directFd(reader), directFd(writer), size);
+}
+
 } // namespace Karm::Sys
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <karm-async/promise.h>
+#include <karm-base/limits.h>
 #include <karm-base/rc.h>
 
 #include "async.h"
@@ -29,7 +31,7 @@ struct _File :
         return _fd->flush();
     }
 
-    auto flushAsync(auto &sched = globalSched()) {
+    auto flushAsync(Sched &sched = globalSched()) {
         return sched.flushAsync(_fd);
     }
 
@@ -52,9 +54,13 @@ struct FileReader :
         return _fd->read(bytes);
     }
 
-    auto readAsync(MutBytes bytes, auto &sched = globalSched()) {
+    auto readAsync(MutBytes bytes, Sched &sched = globalSched()) {
         return sched.readAsync(_fd, bytes);
     }
+
+    auto preadAsync(MutBytes bytes, usize offset, Sched &sched = globalSched()) {
+        return sched.preadAsync(_fd, bytes, offset);
+    }
 };
 
 struct FileWriter :
@@ -67,9 +73,13 @@ struct FileWriter :
         return _fd->write(bytes);
     }
 
-    auto writeAsync(Bytes bytes, auto &sched = globalSched()) {
+    auto writeAsync(Bytes bytes, Sched &sched = globalSched()) {
         return sched.writeAsync(_fd, bytes);
     }
+
+    auto pwriteAsync(Bytes bytes, usize offset, Sched &sched = globalSched()) {
+        return sched.pwriteAsync(_fd, bytes, offset);
+    }
 };
 
 struct File :
@@ -86,6 +96,105 @@ struct File :
     static Res<File> openOrCreate(Mime::Url url);
 };
 
+// MARK: Read Ahead ------------------------------------------------------------
+
+// Reads a file front to back while keeping up to `depth` positional
+// reads of `chunk` bytes in flight, so the disk is busy fetching what
+// comes next while the current chunk is being consumed.
+//
+// NOTE: Only regular files that report a size are read ahead. Pipes,
+//       devices and files like the ones in /proc are read one chunk
+//       at a time until a read comes back empty.
+struct ReadAhead : Meta::NoCopy {
+    struct _Chunk {
+        Vec<u8> buf;
+        usize off = 0;
+        Opt<Async::Future<usize>> future = NONE;
+    };
+
+    Strong<Fd> _fd;
+    Sched &_sched;
+    usize _depth;
+    usize _chunk;
+    usize _next = 0;
+    usize _end = Limits<usize>::MAX;
+    bool _sized = false;
+    bool _seekable = true;
+    Vec<Strong<_Chunk>> _queue;
+
+    ReadAhead(Strong<Fd> fd, usize depth = 4, usize chunk = 64 * 1024, Sched &sched = globalSched())
+        : _fd(fd), _sched(sched), _depth(max(depth, 1uz)), _chunk(max(chunk, 1uz)) {
+        // Don't read ahead past the end, if we know where it is.
+        if (auto stat = _fd->stat()) {
+            _seekable = stat.unwrap().type != Type::OTHER;
+            _sized = stat.unwrap().type == Type::FILE and stat.unwrap().size > 0;
+            if (_sized)
+                _end = stat.unwrap().size;
+        }
+    }
+
+    ReadAhead(_File &file, usize depth = 4, usize chunk = 64 * 1024, Sched &sched = globalSched())
+        : ReadAhead(file.fd(), depth, chunk, sched) {}
+
+    void _fill() {
+        // Without a size, where the next read starts is
+        // only known once the previous one is done.
+        usize depth = _sized ? _depth : 1;
+        while (_queue.len() < depth and _next < _end) {
+            auto chunk = makeStrong<_Chunk>();
+            chunk->buf.resize(min(_chunk, _end - _next));
+
+            // The read owns the chunk until it completes,
+            // even if the reader is gone by then.
+            Async::Promise<usize> promise;
+            chunk->future = promise.future();
+            Async::detach(
+                _seekable
+                    ? _sched.preadAsync(_fd, mutBytes(chunk->buf), _next)
+                    : _sched.readAsync(_fd, mutBytes(chunk->buf)),
+                [chunk, promise = std::move(promise)](Res<usize> res) mutable {
+                    promise.resolve(res);
+                }
+            );
+
+            if (_sized)
+                _next += chunk->buf.len();
+            _queue.pushBack(chunk);
+        }
+    }
+
+    Async::Task<usize> readAsync(MutBytes bytes) {
+        _fill();
+        if (not _queue.len())
+            co_return Ok(0uz);
+
+        auto chunk = first(_queue);
+        usize len = co_trya$(*chunk->future);
+        if (len == 0) {
+            // The end, or the file got shorter.
+            _queue.clear();
+            _end = _next;
+            co_return Ok(0uz);
+        }
+
+        usize n = copy(sub(chunk->buf, chunk->off, len), bytes);
+        chunk->off += n;
+        if (chunk->off == len) {
+            _queue.popFront();
+            if (not _sized) {
+                // Short reads don't mean much here, only an empty one ends it.
+                _next += len;
+            } else if (len < chunk->buf.len()) {
+                // Short read, the rest of the queue is past the end.
+                _queue.clear();
+                _end = _next;
+            }
+        }
+
+        co_return Ok(n);
+    }
+};
+
 /// Read the entire file as a UTF-8 string.
 static inline Res<String> readAllUtf8(Mime::Url const &url) {
     auto file = try$(Sys::File::open(url));
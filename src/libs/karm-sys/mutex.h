@@ -3,6 +3,8 @@
 #include <karm-base/rc.h>
 #include <karm-base/res.h>
 
+#include "_embed.h"
+
 namespace Karm::Sys {
 
 struct Mutex {
@@ -18,17 +20,19 @@ struct Mutex {
 };
 
 struct Sema {
-    Res<Strong<Sema>> create();
+    static Res<Strong<Sema>> create(usize count = 0);
 
     virtual ~Sema() = default;
 
+    // Block until the count is positive and decrement it.
     virtual void wait() = 0;
 
-    virtual void tryWait() = 0;
+    // Decrement the count if it's positive, without blocking.
+    virtual bool tryWait() = 0;
 
     virtual void signal(usize n = 1) = 0;
 
-    virtual void count() = 0;
+    virtual usize count() = 0;
 };
 
 struct CondVar {
@@ -43,4 +47,8 @@ struct CondVar {
     virtual void broadcast() = 0;
 };
 
+inline Res<Strong<Sema>> Sema::create(usize count) {
+    return _Embed::createSema(count);
+}
+
 } // namespace Karm::Sys
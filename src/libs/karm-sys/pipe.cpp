@@ -7,10 +7,11 @@ namespace Karm::Sys {
 
 Res<Pipe> Pipe::create() {
     try$(ensureUnrestricted());
+    // The read end comes first, like with pipe(2)
     auto pipe = try$(_Embed::createPipe());
     return Ok(Pipe{
-        FileWriter{pipe.car, "pipe:"_url},
-        FileReader{pipe.cdr, "pipe:"_url},
+        FileWriter{pipe.cdr, "pipe:"_url},
+        FileReader{pipe.car, "pipe:"_url},
     });
 }
 
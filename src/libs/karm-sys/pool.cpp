@@ -0,0 +1,217 @@
+#include <karm-base/_embed.h>
+
+#include "_embed.h"
+#include "pool.h"
+
+namespace Karm::Sys {
+
+// MARK: Deque -----------------------------------------------------------------
+
+bool _Deque::push(_Job *job) {
+    isize b = _bottom.load(RELAXED);
+    isize t = _top.load(ACQUIRE);
+    if (b - t >= (isize)CAP)
+        return false;
+
+    _buf[b % CAP].store(job, RELAXED);
+    _bottom.store(b + 1, RELEASE);
+    return true;
+}
+
+_Job *_Deque::pop() {
+    isize b = _bottom.load(RELAXED) - 1;
+    _bottom.store(b, RELAXED);
+    memoryBarier(SEQ_CST);
+    isize t = _top.load(RELAXED);
+
+    if (t > b) {
+        _bottom.store(b + 1, RELAXED);
+        return nullptr;
+    }
+
+    _Job *job = _buf[b % CAP].load(RELAXED);
+    if (t == b) {
+        // Last one, race against the thieves
+        if (not _top.cmpxchg(t, t + 1, SEQ_CST))
+            job = nullptr;
+        _bottom.store(b + 1, RELAXED);
+    }
+    return job;
+}
+
+_Job *_Deque::steal() {
+    isize t = _top.load(ACQUIRE);
+    memoryBarier(SEQ_CST);
+    isize b = _bottom.load(ACQUIRE);
+
+    if (t >= b)
+        return nullptr;
+
+    _Job *job = _buf[t % CAP].load(RELAXED);
+    if (not _top.cmpxchg(t, t + 1, SEQ_CST))
+        return nullptr;
+    return job;
+}
+
+// MARK: Thread Pool -----------------------------------------------------------
+
+ThreadPool &ThreadPool::global() {
+    static ThreadPool pool{concurrency() - 1};
+    return pool;
+}
+
+ThreadPool::ThreadPool(usize workers) {
+    if (workers == 0)
+        return;
+
+    // Without a way to put idle workers to sleep
+    // the calling thread does all the work.
+    auto sema = Sema::create();
+    if (not sema)
+        return;
+    _sema = sema.take();
+
+    for (usize i = 0; i < workers; i++)
+        _workers.pushBack(makeStrong<_Worker>(*this, i, _Deque{}, (u64)i * 0x9E3779B97F4A7C15 + 1));
+
+    for (auto &worker : _workers) {
+        auto thread = spawn([this, &w = *worker] {
+            _workerMain(w);
+        });
+
+        // Not being able to spawn more threads is fine,
+        // the other threads will steal the work of the ones
+        // that are missing.
+        if (not thread)
+            break;
+
+        _threads.pushBack(thread.take());
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    _stop.store(true);
+    if (_sema)
+        (*_sema)->signal(_threads.len());
+
+    for (auto &t : _threads)
+        t->join().unwrap("could not join worker");
+}
+
+ThreadPool::_Worker *ThreadPool::_current() {
+    // Only threads of a pool ever set it
+    if (_threads.len() == 0)
+        return nullptr;
+
+    auto *worker = static_cast<_Worker *>(_Embed::currentWorker());
+    if (worker and &worker->pool == this)
+        return worker;
+    return nullptr;
+}
+
+void ThreadPool::_submit(_Job &job) {
+    auto *self = _current();
+    if (self and self->deque.push(&job)) {
+        _wake();
+        return;
+    }
+
+    {
+        LockScope scope{_lock};
+        if (_injector.rem()) {
+            _injector.pushBack(&job);
+            _wake();
+            return;
+        }
+    }
+
+    // Everything is full, nobody will miss this one.
+    job.exec();
+}
+
+void ThreadPool::_wake() {
+    memoryBarier();
+    if (_sleeping.load() > 0)
+        (*_sema)->signal();
+}
+
+_Job *ThreadPool::_findWork(_Worker *self) {
+    if (self) {
+        if (auto *job = self->deque.pop())
+            return job;
+    }
+
+    {
+        LockScope scope{_lock};
+        if (_injector.len())
+            return _injector.popFront();
+    }
+
+    // Steal from the others, starting from a random one
+    // so the thieves don't all go after the same worker.
+    usize len = _workers.len();
+    usize start = 0;
+    if (self) {
+        self->seed ^= self->seed << 13;
+        self->seed ^= self->seed >> 7;
+        self->seed ^= self->seed << 17;
+        start = self->seed % len;
+    }
+
+    for (usize i = 0; i < len; i++) {
+        auto &victim = *_workers[(start + i) % len];
+        if (&victim == self)
+            continue;
+        if (auto *job = victim.deque.steal())
+            return job;
+    }
+
+    return nullptr;
+}
+
+void ThreadPool::_workerMain(_Worker &self) {
+    // Spin for a little while before going to sleep,
+    // more work usually shows up shortly after.
+    static constexpr usize SPINS = 64;
+
+    _Embed::setCurrentWorker(&self);
+    while (not _stop.load(RELAXED)) {
+        _Job *job = nullptr;
+        for (usize i = 0; i < SPINS and not job; i++) {
+            job = _findWork(&self);
+            if (not job)
+                Karm::_Embed::relaxe();
+        }
+
+        if (job) {
+            job->exec();
+            continue;
+        }
+
+        _sleeping.inc();
+        // Work submitted before we went to sleep must not be missed
+        job = _findWork(&self);
+        if (job) {
+            _sleeping.dec();
+            job->exec();
+            continue;
+        }
+
+        if (not _stop.load())
+            (*_sema)->wait();
+        _sleeping.dec();
+    }
+    _Embed::setCurrentWorker(nullptr);
+}
+
+void ThreadPool::_waitFor(_Job &job) {
+    auto *self = _current();
+    while (not job.done()) {
+        if (auto *other = _findWork(self))
+            other->exec();
+        else
+            Karm::_Embed::relaxe();
+    }
+}
+
+} // namespace Karm::Sys
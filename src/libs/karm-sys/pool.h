@@ -0,0 +1,294 @@
+#pragma once
+
+#include <karm-base/array.h>
+#include <karm-base/atomic.h>
+#include <karm-base/lock.h>
+#include <karm-base/ring.h>
+#include <karm-base/slice.h>
+#include <karm-base/vec.h>
+
+#include "mutex.h"
+#include "thread.h"
+
+namespace Karm::Sys {
+
+// A unit of work that can be picked up by any thread of the pool.
+//
+// NOTE: Jobs are not owned by the pool, whoever submits a job must keep
+//       it alive until it is done.
+struct _Job {
+    Atomic<bool> _done{};
+
+    virtual ~_Job() = default;
+
+    virtual void run() = 0;
+
+    void exec() {
+        run();
+        _done.store(true, RELEASE);
+    }
+
+    bool done() {
+        return _done.load(ACQUIRE);
+    }
+};
+
+template <typename F>
+struct _FnJob : public _Job {
+    F _fn;
+
+    _FnJob(F fn) : _fn(std::forward<F>(fn)) {}
+
+    void run() override {
+        _fn();
+    }
+};
+
+// A bounded work-stealing deque, the owner pushes and pops at the bottom
+// while the other threads steal from the top.
+// See "Correct and Efficient Work-Stealing for Weak Memory Models", Lê et al.
+struct _Deque {
+    static constexpr usize CAP = 1024;
+
+    Atomic<isize> _top{};
+    Atomic<isize> _bottom{};
+    Array<Atomic<_Job *>, CAP> _buf{};
+
+    // Owner only, returns false if the deque is full.
+    bool push(_Job *job);
+
+    // Owner only.
+    _Job *pop();
+
+    // Any thread, returns nullptr if the deque is empty
+    // or if another thread got there first.
+    _Job *steal();
+};
+
+// A pool of worker threads with one deque per worker and work stealing.
+//
+// Threads waiting on a job don't block, they help by running other jobs
+// until theirs is done, so forking from inside a job is fine and the
+// thread calling into the pool is one of the threads doing the work.
+struct ThreadPool : Meta::Pinned {
+    struct _Worker {
+        ThreadPool &pool;
+        usize index;
+        _Deque deque{};
+        u64 seed;
+    };
+
+    Vec<Strong<_Worker>> _workers;
+    Vec<Strong<Thread>> _threads;
+    Lock _lock;
+    Ring<_Job *> _injector{_Deque::CAP};
+    Opt<Strong<Sema>> _sema = NONE;
+    Atomic<usize> _sleeping{};
+    Atomic<bool> _stop{};
+
+    // The pool used by the parallel algorithms, it has one
+    // worker less than there are cores since the calling
+    // thread also does some of the work.
+    static ThreadPool &global();
+
+    ThreadPool(usize workers);
+
+    ~ThreadPool();
+
+    // Number of threads that can work at the same time,
+    // the workers and the calling thread.
+    usize parallelism() const {
+        return _threads.len() + 1;
+    }
+
+    _Worker *_current();
+
+    void _submit(_Job &job);
+
+    _Job *_findWork(_Worker *self);
+
+    void _wake();
+
+    void _workerMain(_Worker &self);
+
+    // Help with the other jobs until this one is done.
+    void _waitFor(_Job &job);
+
+    // MARK: Fork-Join ---------------------------------------------------------
+
+    // Run `a` and `b`, possibly in parallel, and
+    // return once both of them are done.
+    void join(auto &&a, auto &&b) {
+        if (_threads.len() == 0) {
+            a();
+            b();
+            return;
+        }
+
+        _FnJob<decltype(b)> job{std::forward<decltype(b)>(b)};
+        _submit(job);
+        a();
+        _waitFor(job);
+    }
+
+    // MARK: Parallel Algorithms -----------------------------------------------
+
+    void _parallelFor(usize start, usize end, usize grain, auto &fn) {
+        if (end - start <= grain) {
+            for (usize i = start; i < end; i++)
+                fn(i);
+            return;
+        }
+
+        usize mid = start + (end - start) / 2;
+        join(
+            [&] {
+                _parallelFor(start, mid, grain, fn);
+            },
+            [&] {
+                _parallelFor(mid, end, grain, fn);
+            }
+        );
+    }
+
+    usize _grain(usize len) const {
+        // A few chunks per thread, so the threads that are
+        // done early can steal from the others.
+        return max(len / (parallelism() * 8), (usize)1);
+    }
+
+    // Call `fn(i)` for every i in [0, len).
+    void parallelFor(usize len, auto fn) {
+        parallelFor(len, _grain(len), fn);
+    }
+
+    // Call `fn(i)` for every i in [0, len), in chunks of at least `grain`.
+    void parallelFor(usize len, usize grain, auto fn) {
+        if (len == 0)
+            return;
+        _parallelFor(0, len, max(grain, (usize)1), fn);
+    }
+
+    // Map every element of the slice with `fn`.
+    template <Sliceable S>
+    auto parallelMap(S const &slice, auto fn) -> Vec<decltype(fn(slice[0]))> {
+        using U = decltype(fn(slice[0]));
+        Vec<U> res;
+        res._buf.ensure(slice.len());
+        parallelFor(slice.len(), [&](usize i) {
+            res._buf._buf[i].ctor(fn(slice[i]));
+        });
+        res._buf._len = slice.len();
+        return res;
+    }
+
+    template <typename T>
+    void _parallelSort(T *buf, usize len, auto &cmp, usize depth) {
+        // Below that it isn't worth to fork anymore
+        static constexpr usize SEQUENTIAL = 8192;
+
+        if (len <= SEQUENTIAL or depth == 0) {
+            MutSlice<T> slice{buf, len};
+            sort(slice, cmp);
+            return;
+        }
+
+        _sort3(buf, len / 2, 0, len - 1, cmp);
+        auto [pos, _] = _partitionRight(buf, len, cmp);
+        join(
+            [&] {
+                _parallelSort(buf, pos, cmp, depth - 1);
+            },
+            [&] {
+                _parallelSort(buf + pos + 1, len - pos - 1, cmp, depth - 1);
+            }
+        );
+    }
+
+    // Sort the slice, the order of equal elements isn't kept.
+    void parallelSort(MutSliceable auto &slice, auto cmp) {
+        // Too many unbalanced partitions only means less parallelism,
+        // the sequential sort takes over when the budget runs out.
+        usize depth = 0;
+        for (usize n = slice.len(); n; n >>= 1)
+            depth++;
+
+        _parallelSort(slice.buf(), slice.len(), cmp, depth);
+    }
+
+    void parallelSort(MutSliceable auto &slice) {
+        parallelSort(slice, [](auto const &a, auto const &b) {
+            return a <=> b;
+        });
+    }
+};
+
+// Jobs spawned in a group can be waited on all at once.
+struct Group : Meta::Pinned {
+    ThreadPool &_pool;
+    Lock _lock;
+    Vec<Strong<_Job>> _jobs;
+
+    Group(ThreadPool &pool = ThreadPool::global())
+        : _pool(pool) {}
+
+    ~Group() {
+        wait();
+    }
+
+    // Run `fn` on the pool.
+    void spawn(auto fn) {
+        auto job = makeStrong<_FnJob<decltype(fn)>>(std::move(fn));
+        {
+            LockScope scope{_lock};
+            _jobs.pushBack(job);
+        }
+        _pool._submit(*job);
+    }
+
+    // Wait for all the spawned jobs to be done, including the ones
+    // spawned while waiting, helping in the meantime.
+    void wait() {
+        while (true) {
+            Vec<Strong<_Job>> jobs;
+            {
+                LockScope scope{_lock};
+                std::swap(jobs, _jobs);
+            }
+
+            if (jobs.len() == 0)
+                return;
+
+            for (auto &job : jobs)
+                _pool._waitFor(*job);
+        }
+    }
+};
+
+// MARK: Helpers ---------------------------------------------------------------
+
+inline void join(auto &&a, auto &&b) {
+    ThreadPool::global().join(std::forward<decltype(a)>(a), std::forward<decltype(b)>(b));
+}
+
+inline void parallelFor(usize len, auto fn) {
+    ThreadPool::global().parallelFor(len, fn);
+}
+
+inline void parallelFor(usize len, usize grain, auto fn) {
+    ThreadPool::global().parallelFor(len, grain, fn);
+}
+
+inline auto parallelMap(Sliceable auto const &slice, auto fn) {
+    return ThreadPool::global().parallelMap(slice, fn);
+}
+
+inline void parallelSort(MutSliceable auto &slice, auto cmp) {
+    ThreadPool::global().parallelSort(slice, cmp);
+}
+
+inline void parallelSort(MutSliceable auto &slice) {
+    ThreadPool::global().parallelSort(slice);
+}
+
+} // namespace Karm::Sys
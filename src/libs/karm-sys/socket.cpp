@@ -5,6 +5,12 @@
 
 namespace Karm::Sys {
 
+// MARK: Abstract Socket -------------------------------------------------------
+
+Res<> shutdown(Strong<Fd> fd) {
+    return _Embed::shutdown(std::move(fd));
+}
+
 // MARK: Udp Socket ------------------------------------------------------------
 
 Res<UdpConnection> UdpConnection::listen(SocketAddr addr) {
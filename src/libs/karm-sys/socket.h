@@ -8,6 +8,10 @@ namespace Karm::Sys {
 
 // MARK: Abstract Socket -------------------------------------------------------
 
+// Stop both directions of a connected socket, pending reads
+// on it complete as if the peer had closed the connection.
+Res<> shutdown(Strong<Fd> fd);
+
 struct _Connection :
     public Io::Reader,
     public Io::Writer,
@@ -19,6 +23,12 @@ struct _Connection :
     virtual Async::Task<usize> writeAsync(Bytes buf) = 0;
 
     virtual Async::Task<usize> flushAsync() = 0;
+
+    // The descriptor behind the connection, NONE when the
+    // bytes get transformed on the way, like with TLS.
+    virtual Opt<Strong<Fd>> directFd() {
+        return NONE;
+    }
 };
 
 struct Connection :
@@ -57,6 +67,10 @@ struct Connection :
         return globalSched().flushAsync(_fd);
     }
 
+    Opt<Strong<Fd>> directFd() override {
+        return _fd;
+    }
+
     Strong<Fd> fd() { return _fd; }
 };
 
@@ -7,6 +7,7 @@ namespace Karm::Sys {
 enum struct Type {
     FILE,
     DIR,
+    OTHER, // Pipes, sockets and devices
 };
 
 struct Stat {
@@ -0,0 +1,160 @@
+#include <karm-io/funcs.h>
+#include <karm-sys/file.h>
+#include <karm-sys/pipe.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Sys::Tests {
+
+static constexpr usize LEN = 100000;
+
+static u8 _pattern(usize i) {
+    return (i * 7 + i / 251) & 0xff;
+}
+
+Async::Task<> positionalIo() {
+#ifdef __ck_sys_skift__
+    co_return Error::skipped();
+#endif
+
+    auto file = co_try$(File::openOrCreate("file:///tmp/karm-test-async-file"_url));
+
+    Vec<u8> data;
+    for (usize i = 0; i < LEN; i++)
+        data.pushBack(_pattern(i));
+
+    // Write the two halves out of order
+    usize half = LEN / 2;
+    co_trya$(file.pwriteAsync(sub(data, half, LEN), half));
+    co_trya$(file.pwriteAsync(sub(data, 0, half), 0));
+
+    Array<u8, 16> a{}, b{};
+    Array<MutBytes, 2> bufs = {mutBytes(a), mutBytes(b)};
+    auto n = co_trya$(globalSched().readvAsync(file.fd(), bufs, 1000));
+    if (n != 32)
+        co_return Error::other("short vectored read");
+    for (usize i = 0; i < 16; i++)
+        if (a[i] != _pattern(1000 + i) or b[i] != _pattern(1016 + i))
+            co_return Error::other("vectored read mismatch");
+
+    // Small chunks so the reads overlap and end with a short one
+    ReadAhead reader{file, 3, 4096};
+    Vec<u8> out;
+    Array<u8, 1500> buf;
+    while (true) {
+        auto len = co_trya$(reader.readAsync(mutBytes(buf)));
+        if (len == 0)
+            break;
+        auto got = sub(buf, 0, len);
+        out.pushBack(got);
+    }
+
+    if (out.len() != LEN)
+        co_return Error::other("read ahead length mismatch");
+    for (usize i = 0; i < LEN; i++)
+        if (out[i] != data[i])
+            co_return Error::other("read ahead mismatch");
+
+    co_return Ok();
+}
+
+testAsync$("async-file-positional") {
+    return positionalIo();
+}
+
+static Async::Task<> _expectPattern(Mime::Url const &url, usize len) {
+    auto file = co_try$(File::open(url));
+    Vec<u8> buf;
+    buf.resize(len + 1);
+    auto n = co_trya$(file.preadAsync(mutBytes(buf), 0));
+    if (n != len)
+        co_return Error::other("transfer length mismatch");
+    for (usize i = 0; i < len; i++)
+        if (buf[i] != _pattern(i))
+            co_return Error::other("transfer mismatch");
+    co_return Ok();
+}
+
+Async::Task<> transfer() {
+#ifdef __ck_sys_skift__
+    co_return Error::skipped();
+#endif
+
+    Vec<u8> data;
+    for (usize i = 0; i < LEN; i++)
+        data.pushBack(_pattern(i));
+
+    {
+        auto file = co_try$(File::create("file:///tmp/karm-test-transfer-src"_url));
+        co_trya$(file.pwriteAsync(bytes(data), 0));
+    }
+
+    // Io::copy() goes around the buffer when both ends are files
+    {
+        auto src = co_try$(File::open("file:///tmp/karm-test-transfer-src"_url));
+        auto dst = co_try$(File::create("file:///tmp/karm-test-transfer-copy"_url));
+        auto n = co_try$(Io::copy(src, dst));
+        if (n != LEN)
+            co_return Error::other("short copy");
+    }
+    co_trya$(_expectPattern("file:///tmp/karm-test-transfer-copy"_url, LEN));
+
+    // More than a pipe can hold, so it takes a few splices
+    {
+        auto src = co_try$(File::open("file:///tmp/karm-test-transfer-src"_url));
+        auto dst = co_try$(File::create("file:///tmp/karm-test-transfer-async"_url));
+        auto n = co_trya$(globalSched().transferAsync(src.fd(), dst.fd(), 0, LEN));
+        if (n != LEN)
+            co_return Error::other("short transfer");
+    }
+    co_trya$(_expectPattern("file:///tmp/karm-test-transfer-async"_url, LEN));
+
+    co_return Ok();
+}
+
+testAsync$("async-file-transfer") {
+    return transfer();
+}
+
+Async::Task<> pipeReadAhead() {
+#ifdef __ck_sys_skift__
+    co_return Error::skipped();
+#endif
+
+    auto pipe = co_try$(Pipe::create());
+    auto out = std::move(pipe.out);
+
+    // Less than a pipe can hold, closing the writer marks the end
+    Vec<u8> data;
+    for (usize i = 0; i < 10000; i++)
+        data.pushBack(_pattern(i));
+    {
+        auto in = std::move(pipe.in);
+        co_try$(in.write(data));
+    }
+
+    // Reads come back short, but only an empty one ends the pipe
+    ReadAhead reader{out, 3, 4096};
+    Vec<u8> got;
+    Array<u8, 1500> buf;
+    while (true) {
+        auto len = co_trya$(reader.readAsync(mutBytes(buf)));
+        if (len == 0)
+            break;
+        auto chunk = sub(buf, 0, len);
+        got.pushBack(chunk);
+    }
+
+    if (got.len() != data.len())
+        co_return Error::other("read ahead length mismatch");
+    for (usize i = 0; i < data.len(); i++)
+        if (got[i] != data[i])
+            co_return Error::other("read ahead mismatch");
+
+    co_return Ok();
+}
+
+testAsync$("async-pipe-read-ahead") {
+    return pipeReadAhead();
+}
+
+} // namespace Karm::Sys::Tests
@@ -0,0 +1,112 @@
+#include <karm-sys/pool.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Sys::Tests {
+
+static usize _fib(ThreadPool &pool, usize n) {
+    if (n < 2)
+        return n;
+
+    usize a = 0, b = 0;
+    pool.join(
+        [&] {
+            a = _fib(pool, n - 1);
+        },
+        [&] {
+            b = _fib(pool, n - 2);
+        }
+    );
+    return a + b;
+}
+
+test$("pool-join") {
+    ThreadPool pool{3};
+    expectEq$(_fib(pool, 20), 6765uz);
+    return Ok();
+}
+
+test$("pool-parallel-for") {
+    ThreadPool pool{3};
+
+    Vec<Atomic<usize>> hits;
+    hits.resize(10000);
+    pool.parallelFor(hits.len(), [&](usize i) {
+        hits[i].fetchInc();
+    });
+
+    for (auto &h : hits)
+        expectEq$(h.load(), 1uz);
+
+    return Ok();
+}
+
+test$("pool-parallel-map") {
+    ThreadPool pool{3};
+
+    Vec<usize> input;
+    for (usize i = 0; i < 10000; i++)
+        input.pushBack(i);
+
+    auto res = pool.parallelMap(input, [](usize v) {
+        return v * 2;
+    });
+
+    expectEq$(res.len(), input.len());
+    for (usize i = 0; i < res.len(); i++)
+        expectEq$(res[i], i * 2);
+
+    return Ok();
+}
+
+test$("pool-parallel-sort") {
+    ThreadPool pool{3};
+
+    Vec<u32> v;
+    u32 state = 1;
+    for (usize i = 0; i < 100000; i++) {
+        state = state * 1664525 + 1013904223;
+        v.pushBack(state >> 8);
+    }
+
+    pool.parallelSort(v);
+    for (usize i = 1; i < v.len(); i++)
+        expect$(v[i - 1] <= v[i]);
+
+    return Ok();
+}
+
+test$("pool-group") {
+    ThreadPool pool{3};
+    Atomic<usize> count{};
+
+    {
+        Group group{pool};
+        for (usize i = 0; i < 100; i++) {
+            group.spawn([&] {
+                count.fetchInc();
+            });
+        }
+        group.wait();
+        expectEq$(count.load(), 100uz);
+    }
+
+    return Ok();
+}
+
+test$("pool-no-workers") {
+    ThreadPool pool{0};
+    expectEq$(pool.parallelism(), 1uz);
+    expectEq$(_fib(pool, 10), 55uz);
+
+    Group group{pool};
+    usize count = 0;
+    group.spawn([&] {
+        count++;
+    });
+    group.wait();
+    expectEq$(count, 1uz);
+
+    return Ok();
+}
+
+} // namespace Karm::Sys::Tests
@@ -0,0 +1,77 @@
+#include <karm-base/mpmc.h>
+#include <karm-base/spsc.h>
+#include <karm-sys/thread.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Sys::Tests {
+
+static constexpr usize ITEMS = 10000;
+
+test$("spsc-threads") {
+    Spsc<usize> q{1024};
+
+    auto producer = try$(spawn([&] {
+        for (usize i = 0; i < ITEMS; i++)
+            while (not q.tryPush(i))
+                ;
+    }));
+
+    bool ordered = true;
+    for (usize i = 0; i < ITEMS; i++) {
+        Opt<usize> v = NONE;
+        while (not v)
+            v = q.tryPop();
+        ordered = ordered and *v == i;
+    }
+
+    try$(producer->join());
+    expect$(ordered);
+    expect$(q.empty());
+
+    return Ok();
+}
+
+test$("mpmc-threads") {
+    static constexpr usize PRODUCERS = 3;
+    static constexpr usize CONSUMERS = 3;
+
+    Mpmc<usize> q{1024};
+    Atomic<usize> sum{};
+    Atomic<usize> count{};
+
+    Vec<Strong<Thread>> threads;
+    for (usize p = 0; p < PRODUCERS; p++) {
+        threads.pushBack(try$(spawn([&] {
+            Array<usize, 4> batch;
+            for (usize i = 1; i <= ITEMS; i += batch.len()) {
+                for (usize j = 0; j < batch.len(); j++)
+                    batch[j] = i + j;
+
+                usize pushed = 0;
+                while (pushed < batch.len())
+                    pushed += q.tryPushMany(mutSub(batch, pushed, batch.len()));
+            }
+        })));
+    }
+
+    for (usize c = 0; c < CONSUMERS; c++) {
+        threads.pushBack(try$(spawn([&] {
+            while (count.load() < PRODUCERS * ITEMS) {
+                if (auto v = q.tryPop()) {
+                    sum.fetchAdd(*v);
+                    count.fetchInc();
+                }
+            }
+        })));
+    }
+
+    for (auto &t : threads)
+        try$(t->join());
+
+    expectEq$(count.load(), PRODUCERS * ITEMS);
+    expectEq$(sum.load(), PRODUCERS * ITEMS * (ITEMS + 1) / 2);
+
+    return Ok();
+}
+
+} // namespace Karm::Sys::Tests
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <karm-base/clamp.h>
+#include <karm-base/func.h>
+#include <karm-base/rc.h>
+#include <karm-base/res.h>
+
+#include "_embed.h"
+
+namespace Karm::Sys {
+
+struct Thread {
+    virtual ~Thread() = default;
+
+    // Wait for the thread to finish.
+    virtual Res<> join() = 0;
+};
+
+// Run the given function on a new thread of execution.
+inline Res<Strong<Thread>> spawn(Func<void()> fn) {
+    return _Embed::spawnThread(std::move(fn));
+}
+
+// Number of threads that can run in parallel on this system,
+// always at least one.
+inline usize concurrency() {
+    return max(_Embed::concurrency(), (usize)1);
+}
+
+} // namespace Karm::Sys
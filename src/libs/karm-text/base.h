@@ -2,6 +2,7 @@
 
 #include <karm-base/checked.h>
 #include <karm-base/distinct.h>
+#include <karm-base/hash.h>
 #include <karm-base/string.h>
 #include <karm-io/emit.h>
 
@@ -20,6 +21,10 @@ struct Glyph {
     bool operator==(Glyph const &other) const = default;
 
     auto operator<=>(Glyph const &other) const = default;
+
+    Hash hash() const {
+        return Karm::hash(index, font);
+    }
 };
 
 constexpr Glyph Glyph::TOFU{0, 0};
@@ -72,7 +72,7 @@ struct BoxStyle {
 
         g.push();
         if (shadowStyle)
-            shadowStyle->paint(g, bound);
+            shadowStyle->paint(g, bound, borderRadii);
 
         if (backgroundFill) {
             g.fillStyle(*backgroundFill);
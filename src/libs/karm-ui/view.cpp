@@ -303,6 +303,7 @@ Child icon(Mdi::Icon i, f64 size, Opt<Gfx::Color> color) {
 struct Image : public View<Image> {
     Karm::Image::Picture _image;
     Opt<Math::Radiif> _radii;
+    Opt<Gfx::Mipmap> _mipmap = NONE; // Built on the first paint
 
     Image(Karm::Image::Picture image, Opt<Math::Radiif> radii = NONE)
         : _image(image), _radii(radii) {}
@@ -314,7 +315,9 @@ struct Image : public View<Image> {
             g.fillStyle(_image.pixels());
             g.fill(bound(), *_radii);
         } else {
-            g.blit(bound(), _image);
+            if (not _mipmap)
+                _mipmap = Gfx::Mipmap::build(_image._surface);
+            g.blit(bound(), *_mipmap);
         }
 
         g.pop();
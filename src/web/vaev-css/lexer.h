@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/atom.h>
 #include <karm-base/ctype.h>
 #include <karm-base/func.h>
 #include <karm-base/res.h>
@@ -69,6 +70,12 @@ struct Token {
         return type != NIL;
     }
 
+    // The data of the token as an atom, for identifiers and names that
+    // are going to be compared a lot.
+    Atom atom() const {
+        return data;
+    }
+
     void repr(Io::Emit &e) const;
 
     bool operator==(Type type) const {
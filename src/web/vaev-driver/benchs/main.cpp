@@ -0,0 +1,164 @@
+#include <karm-base/atomic.h>
+#include <karm-io/fmt.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+#include <vaev-driver/render.h>
+#include <vaev-markup/html.h>
+
+#include <stdlib.h>
+
+// MARK: Allocation Counting ---------------------------------------------------
+
+// NOTE: Default constructed so they are ready before
+//       any static constructor allocates.
+static Atomic<usize> _allocs;
+static Atomic<usize> _bytes;
+
+void *operator new(usize size) {
+    _allocs.inc();
+    _bytes.fetchAdd(size);
+    void *ptr = malloc(size ? size : 1);
+    if (not ptr)
+        panic("out of memory");
+    return ptr;
+}
+
+void *operator new[](usize size) {
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, usize) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr, usize) noexcept {
+    free(ptr);
+}
+
+struct Counts {
+    usize allocs;
+    usize bytes;
+    TimeSpan time;
+};
+
+static Counts measure(auto fn) {
+    usize allocs = _allocs.load();
+    usize bytes = _bytes.load();
+    auto start = Sys::now();
+    fn();
+    return {
+        _allocs.load() - allocs,
+        _bytes.load() - bytes,
+        Sys::now() - start,
+    };
+}
+
+static void report(Str name, Counts counts) {
+    Sys::println("{}:", name);
+    Sys::println("  allocations: {}", counts.allocs);
+    Sys::println("  bytes: {}", counts.bytes);
+    Sys::println("  time: {}", counts.time);
+    Sys::println("");
+}
+
+// MARK: Document --------------------------------------------------------------
+
+static constexpr usize SECTIONS = 200;
+
+// A page made of the kind of content that is common on the web: lots
+// of small elements with a couple of classes and short attribute values.
+static String _page() {
+    StringBuilder sb;
+    sb.append(R"(<!DOCTYPE html><html lang="en"><head><title>Bench</title><style>
+        .card { margin: 8px; padding: 4px 8px; border: 1px solid #ccc; }
+        .card.featured { background: #fef; }
+        .title { font-weight: bold; font-size: 1.2em; }
+        .meta span { color: gray; margin-right: 4px; }
+        ul.tags li { display: inline; padding: 0 2px; }
+    </style></head><body>)"s);
+
+    for (usize i = 0; i < SECTIONS; i++) {
+        auto card = Io::format(
+            R"(<div class="card{}" id="card-{}" data-index="{}">
+                <p class="title">Item <b>{}</b> &amp; <i>friends</i></p>
+                <p class="meta"><span>by</span><a href="/u/{}" title="user">user{}</a><span>today</span></p>
+                <ul class="tags"><li>a</li><li>bb</li><li>ccc</li></ul>
+            </div>)",
+            i % 7 == 0 ? " featured"s : ""s, i, i, i, i, i
+        );
+        sb.append(card.unwrap());
+    }
+
+    sb.append("</body></html>"s);
+    return sb.take();
+}
+
+static Vaev::Style::Media _media() {
+    using namespace Vaev;
+    return {
+        .type = MediaType::SCREEN,
+        .width = 1280_px,
+        .height = 720_px,
+        .aspectRatio = 16.0 / 9.0,
+        .orientation = Print::Orientation::LANDSCAPE,
+
+        .resolution = Resolution::fromDpi(96),
+        .scan = Scan::PROGRESSIVE,
+        .grid = false,
+        .update = Update::FAST,
+        .overflowBlock = OverflowBlock::SCROLL,
+        .overflowInline = OverflowInline::SCROLL,
+
+        .color = 8,
+        .colorIndex = 0,
+        .monochrome = 0,
+        .colorGamut = ColorGamut::SRGB,
+        .pointer = Pointer::FINE,
+        .hover = Hover::HOVER,
+        .anyPointer = Pointer::FINE,
+        .anyHover = Hover::HOVER,
+
+        .prefersReducedMotion = ReducedMotion::NO_PREFERENCE,
+        .prefersReducedTransparency = ReducedTransparency::NO_PREFERENCE,
+        .prefersContrast = Contrast::NO_PREFERENCE,
+        .forcedColors = Colors::NONE,
+        .prefersColorScheme = ColorScheme::LIGHT,
+        .prefersReducedData = ReducedData::NO_PREFERENCE,
+    };
+}
+
+Async::Task<> entryPointAsync(Sys::Context &) {
+    using namespace Vaev;
+
+    auto page = _page();
+    auto media = _media();
+    auto dom = makeStrong<Markup::Document>(Mime::Url{});
+
+    auto parse = measure([&] {
+        Markup::HtmlParser parser{dom};
+        parser.write(page);
+    });
+    report("parse", parse);
+
+    auto render = measure([&] {
+        auto result = Driver::render(*dom, media, {.small = {1280_px, 720_px}});
+    });
+    report("render", render);
+
+    // The second render hits the warm caches (fonts, user agent
+    // stylesheet), which is what matters for relayouts.
+    auto warm = measure([&] {
+        auto result = Driver::render(*dom, media, {.small = {1280_px, 720_px}});
+    });
+    report("render-warm", warm);
+
+    co_return Ok();
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/atom.h>
 #include <karm-base/list.h>
 #include <karm-base/map.h>
 #include <karm-base/rc.h>
@@ -184,6 +185,10 @@ struct Node :
     auto operator<=>(Node const &other) const {
         return this <=> &other;
     }
+
+    Hash hash() const {
+        return Karm::hash(this);
+    }
 };
 
 // MARK: Document --------------------------------------------------------------
@@ -312,33 +317,39 @@ struct Attr : public Node {
 
 // https://dom.spec.whatwg.org/#domtokenlist
 struct TokenList {
-    Vec<String> _tokens;
+    InlineVec<Atom, 4> _tokens;
 
     usize length() const {
         return _tokens.len();
     }
 
-    Opt<String> item(usize index) const {
+    Opt<Atom> item(usize index) const {
         if (index >= _tokens.len())
             return NONE;
         return _tokens[index];
     }
 
-    bool contains(Str token) const {
+    bool contains(Atom token) const {
         return ::contains(_tokens, token);
     }
 
-    void add(Str token) {
-        if (not::contains(_tokens, token))
+    bool contains(Str token) const {
+        // A string that was never interned can't be in the list
+        auto atom = Atom::lookup(token);
+        return atom and contains(*atom);
+    }
+
+    void add(Atom token) {
+        if (not contains(token))
             _tokens.pushBack(token);
     }
 
-    void remove(Str token) {
+    void remove(Atom token) {
         _tokens.removeAll(token);
     }
 
-    bool toggle(Str token) {
-        if (::contains(_tokens, token)) {
+    bool toggle(Atom token) {
+        if (contains(token)) {
             _tokens.removeAll(token);
             return false;
         }
@@ -346,8 +357,8 @@ struct TokenList {
         return true;
     }
 
-    bool replace(Str oldToken, Str newToken) {
-        if (not::contains(_tokens, oldToken))
+    bool replace(Atom oldToken, Atom newToken) {
+        if (not contains(oldToken))
             return false;
         _tokens.removeAll(oldToken);
         _tokens.pushBack(newToken);
@@ -366,8 +377,9 @@ struct Element : public Node {
     }
 
     TagName tagName;
+    Atom idAtom; // Interned value of the id attribute, for selector matching
     // NOSPEC: Should be a NamedNodeMap
-    Map<AttrName, Strong<Attr>> attributes;
+    OrderedMap<AttrName, Strong<Attr>> attributes;
     TokenList classList;
 
     Element(TagName tagName)
@@ -411,6 +423,8 @@ struct Element : public Node {
             }
             return;
         }
+        if (name == Html::ID_ATTR)
+            this->idAtom = value;
         auto attr = makeStrong<Attr>(name, value);
         this->attributes.put(name, attr);
     }
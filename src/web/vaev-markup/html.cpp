@@ -1,5 +1,6 @@
 #include <karm-base/array.h>
 #include <karm-base/cons.h>
+#include <karm-base/phf.h>
 
 #include "html.h"
 
@@ -9,22 +10,21 @@ static constexpr bool DEBUG_HTML_PARSER = false;
 
 // MARK: Lexer -----------------------------------------------------------------
 
-struct Entity {
-    Str name;
-    Rune const *runes;
-
-    operator bool() {
-        return runes != nullptr;
-    }
-};
-
-[[maybe_unused]] static Array const ENTITIES = {
-#define ENTITY(NAME, ...) \
-    Entity{#NAME, (Rune[]){__VA_ARGS__ __VA_OPT__(, ) 0}},
+// Named character references, with the leading ampersand,
+// the second rune is zero for the ones that only have one.
+static constexpr PerfectMap ENTITIES = Array{
+#define ENTITY(NAME, ...) Cons<Str, Pair<Rune>>{NAME, {__VA_ARGS__}},
 #include "defs/ns-html-entities.inc"
 #undef ENTITY
 };
 
+static constexpr usize MAX_ENTITY_LEN = [] {
+    usize len = 0;
+    for (auto const &entity : ENTITIES._entries)
+        len = max(len, entity.car.len());
+    return len;
+}();
+
 void HtmlLexer::_raise(Str msg) {
     logError("{}: {}", _state, msg);
 }
@@ -234,7 +234,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // string. Reconsume in the tag name state.
         else if (isAsciiAlpha(rune)) {
             _begin(HtmlToken::START_TAG);
-            _reconsumeIn(State::TAG_NAME, rune);
+            _reconsumeIn(State::TAG_NAME, rune, isEof);
         }
 
         // U+003F QUESTION MARK (?)
@@ -244,7 +244,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else if (rune == '?') {
             _raise("unexpected-question-mark-instead-of-tag-name");
             _begin(HtmlToken::COMMENT);
-            _reconsumeIn(State::BOGUS_COMMENT, rune);
+            _reconsumeIn(State::BOGUS_COMMENT, rune, isEof);
         }
 
         // EOF
@@ -264,7 +264,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _raise("invalid-first-character-of-tag-name");
             _emit('<');
-            _reconsumeIn(State::DATA, rune);
+            _reconsumeIn(State::DATA, rune, isEof);
         }
 
         break;
@@ -279,7 +279,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Reconsume in the tag name state.
         if (isAsciiAlpha(rune)) {
             _begin(HtmlToken::END_TAG);
-            _reconsumeIn(State::TAG_NAME, rune);
+            _reconsumeIn(State::TAG_NAME, rune, isEof);
         }
 
         // U+003E GREATER-THAN SIGN (>)
@@ -309,7 +309,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _raise("invalid-first-character-of-tag-name");
             _begin(HtmlToken::COMMENT);
-            _reconsumeIn(State::BOGUS_COMMENT, rune);
+            _reconsumeIn(State::BOGUS_COMMENT, rune, isEof);
         }
 
         break;
@@ -325,21 +325,21 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // U+0020 SPACE
         // Switch to the before attribute name state.
         if (rune == '\t' or rune == '\n' or rune == '\f' or rune == ' ') {
-            _ensure().name = _builder.take();
+            _ensure().name = _takeBuilder();
             _switchTo(State::BEFORE_ATTRIBUTE_NAME);
         }
 
         // U+002F SOLIDUS (/)
         // Switch to the self-closing start tag state.
         else if (rune == '/') {
-            _ensure().name = _builder.take();
+            _ensure().name = _takeBuilder();
             _switchTo(State::SELF_CLOSING_START_TAG);
         }
 
         // U+003E GREATER-THAN SIGN (>)
         // Switch to the data state. Emit the current tag token.
         else if (rune == '>') {
-            _ensure().name = _builder.take();
+            _ensure().name = _takeBuilder();
             _switchTo(State::DATA);
             _emit();
         }
@@ -396,7 +396,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // RCDATA state.
         else {
             _emit('<');
-            _reconsumeIn(State::RCDATA, rune);
+            _reconsumeIn(State::RCDATA, rune, isEof);
         }
 
         break;
@@ -411,7 +411,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Reconsume in the RCDATA end tag name state.
         if (isAsciiAlpha(rune)) {
             _begin(HtmlToken::END_TAG);
-            _reconsumeIn(State::RCDATA_END_TAG_NAME, rune);
+            _reconsumeIn(State::RCDATA_END_TAG_NAME, rune, isEof);
         }
 
         // Anything else
@@ -420,7 +420,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _emit('<');
             _emit('/');
-            _reconsumeIn(State::RCDATA, rune);
+            _reconsumeIn(State::RCDATA, rune, isEof);
         }
 
         break;
@@ -439,7 +439,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // treat it as per the "anything else" entry below.
         if ((rune == '\t' or rune == '\n' or rune == '\f' or rune == ' ') and
             _isAppropriateEndTagToken()) {
-            _ensure().name = _builder.take();
+            _ensure().name = _takeBuilder();
             _switchTo(State::BEFORE_ATTRIBUTE_NAME);
         }
 
@@ -448,7 +448,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // then switch to the self-closing start tag state. Otherwise,
         // treat it as per the "anything else" entry below.
         else if (rune == '/' and _isAppropriateEndTagToken()) {
-            _ensure().name = _builder.take();
+            _ensure().name = _takeBuilder();
             _switchTo(State::SELF_CLOSING_START_TAG);
         }
 
@@ -457,7 +457,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // then switch to the data state and emit the current tag token.
         // Otherwise, treat it as per the "anything else" entry below.
         else if (rune == '>' and _isAppropriateEndTagToken()) {
-            _ensure().name = _builder.take();
+            _ensure().name = _takeBuilder();
             _switchTo(State::DATA);
             _emit();
         }
@@ -492,7 +492,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
             for (Rune rune : iterRunes(_temp.str()))
                 _emit(rune);
 
-            _reconsumeIn(State::RCDATA, rune);
+            _reconsumeIn(State::RCDATA, rune, isEof);
         }
 
         break;
@@ -514,7 +514,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // RAWTEXT state.
         else {
             _emit('<');
-            _reconsumeIn(State::RAWTEXT, rune);
+            _reconsumeIn(State::RAWTEXT, rune, isEof);
         }
 
         break;
@@ -529,7 +529,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Reconsume in the RAWTEXT end tag name state.
         if (isAsciiAlpha(rune)) {
             _begin(HtmlToken::END_TAG);
-            _reconsumeIn(State::RAWTEXT_END_TAG_NAME, rune);
+            _reconsumeIn(State::RAWTEXT_END_TAG_NAME, rune, isEof);
         }
 
         // Anything else
@@ -538,7 +538,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _emit('<');
             _emit('/');
-            _reconsumeIn(State::RAWTEXT, rune);
+            _reconsumeIn(State::RAWTEXT, rune, isEof);
         }
 
         break;
@@ -605,7 +605,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
             _emit('/');
             for (Rune rune : iterRunes(_temp.str()))
                 _emit(rune);
-            _reconsumeIn(State::RAWTEXT, rune);
+            _reconsumeIn(State::RAWTEXT, rune, isEof);
         }
 
         break;
@@ -638,7 +638,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // script data state.
         else {
             _emit('<');
-            _reconsumeIn(State::SCRIPT_DATA, rune);
+            _reconsumeIn(State::SCRIPT_DATA, rune, isEof);
         }
         break;
     }
@@ -652,7 +652,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Reconsume in the script data end tag name state.
         if (isAsciiAlpha(rune)) {
             _begin(HtmlToken::END_TAG);
-            _reconsumeIn(State::SCRIPT_DATA_END_TAG_NAME, rune);
+            _reconsumeIn(State::SCRIPT_DATA_END_TAG_NAME, rune, isEof);
         }
 
         // Anything else
@@ -661,7 +661,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _emit('<');
             _emit('/');
-            _reconsumeIn(State::SCRIPT_DATA, rune);
+            _reconsumeIn(State::SCRIPT_DATA, rune, isEof);
         }
 
         break;
@@ -731,7 +731,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
             _emit('/');
             for (Rune rune : iterRunes(_temp.str()))
                 _emit(rune);
-            _reconsumeIn(State::SCRIPT_DATA, rune);
+            _reconsumeIn(State::SCRIPT_DATA, rune, isEof);
         }
 
         break;
@@ -752,7 +752,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Anything else
         // Reconsume in the script data state.
         else {
-            _reconsumeIn(State::SCRIPT_DATA, rune);
+            _reconsumeIn(State::SCRIPT_DATA, rune, isEof);
         }
 
         break;
@@ -773,7 +773,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Anything else
         // Reconsume in the script data state.
         else {
-            _reconsumeIn(State::SCRIPT_DATA, rune);
+            _reconsumeIn(State::SCRIPT_DATA, rune, isEof);
         }
 
         break;
@@ -914,7 +914,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else if (isAsciiAlpha(rune)) {
             _temp.clear();
             _emit('<');
-            _reconsumeIn(State::SCRIPT_DATA_DOUBLE_ESCAPE_START, rune);
+            _reconsumeIn(State::SCRIPT_DATA_DOUBLE_ESCAPE_START, rune, isEof);
         }
 
         // Anything else
@@ -922,7 +922,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // script data escaped state.
         else {
             _emit('<');
-            _reconsumeIn(State::SCRIPT_DATA_ESCAPED, rune);
+            _reconsumeIn(State::SCRIPT_DATA_ESCAPED, rune, isEof);
         }
 
         break;
@@ -937,7 +937,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Reconsume in the script data escaped end tag name state.
         if (isAsciiAlpha(rune)) {
             _begin(HtmlToken::END_TAG);
-            _reconsumeIn(State::SCRIPT_DATA_ESCAPED_END_TAG_NAME, rune);
+            _reconsumeIn(State::SCRIPT_DATA_ESCAPED_END_TAG_NAME, rune, isEof);
         }
 
         // Anything else
@@ -946,7 +946,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _emit('<');
             _emit('/');
-            _reconsumeIn(State::SCRIPT_DATA_ESCAPED, rune);
+            _reconsumeIn(State::SCRIPT_DATA_ESCAPED, rune, isEof);
         }
 
         break;
@@ -1013,7 +1013,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
             _emit('/');
             for (Rune rune : iterRunes(_temp.str()))
                 _emit(rune);
-            _reconsumeIn(State::SCRIPT_DATA_ESCAPED, rune);
+            _reconsumeIn(State::SCRIPT_DATA_ESCAPED, rune, isEof);
         }
 
         break;
@@ -1063,7 +1063,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Anything else
         // Reconsume in the script data escaped state.
         else {
-            _reconsumeIn(State::SCRIPT_DATA_ESCAPED, rune);
+            _reconsumeIn(State::SCRIPT_DATA_ESCAPED, rune, isEof);
         }
 
         break;
@@ -1238,7 +1238,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Anything else
         // Reconsume in the script data double escaped state.
         else {
-            _reconsumeIn(State::SCRIPT_DATA_DOUBLE_ESCAPED, rune);
+            _reconsumeIn(State::SCRIPT_DATA_DOUBLE_ESCAPED, rune, isEof);
         }
 
         break;
@@ -1288,7 +1288,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Anything else
         // Reconsume in the script data double escaped state.
         else {
-            _reconsumeIn(State::SCRIPT_DATA_DOUBLE_ESCAPED, rune);
+            _reconsumeIn(State::SCRIPT_DATA_DOUBLE_ESCAPED, rune, isEof);
         }
         break;
     }
@@ -1311,7 +1311,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // EOF
         // Reconsume in the after attribute name state.
         else if (rune == '/' or rune == '>' or isEof) {
-            _reconsumeIn(State::AFTER_ATTRIBUTE_NAME, rune);
+            _reconsumeIn(State::AFTER_ATTRIBUTE_NAME, rune, isEof);
         }
 
         // U+003D EQUALS SIGN (=)
@@ -1332,7 +1332,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // attribute name state.
         else {
             _beginAttribute();
-            _reconsumeIn(State::ATTRIBUTE_NAME, rune);
+            _reconsumeIn(State::ATTRIBUTE_NAME, rune, isEof);
         }
 
         break;
@@ -1352,14 +1352,14 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Reconsume in the after attribute name state.
         if (rune == '\t' or rune == '\n' or rune == '\f' or rune == ' ' or
             rune == '/' or rune == '>' or isEof) {
-            _lastAttr().name = _builder.take();
-            _reconsumeIn(State::AFTER_ATTRIBUTE_NAME, rune);
+            _lastAttr().name = _takeBuilder();
+            _reconsumeIn(State::AFTER_ATTRIBUTE_NAME, rune, isEof);
         }
 
         // U+003D EQUALS SIGN (=)
         // Switch to the before attribute value state.
         else if (rune == '=') {
-            _lastAttr().name = _builder.take();
+            _lastAttr().name = _takeBuilder();
             _switchTo(State::BEFORE_ATTRIBUTE_VALUE);
         }
 
@@ -1455,7 +1455,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // attribute name state.
         else {
             _beginAttribute();
-            _reconsumeIn(State::ATTRIBUTE_NAME, rune);
+            _reconsumeIn(State::ATTRIBUTE_NAME, rune, isEof);
         }
 
         break;
@@ -1498,7 +1498,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Anything else
         // Reconsume in the attribute value (unquoted) state.
         else {
-            _reconsumeIn(State::ATTRIBUTE_VALUE_UNQUOTED, rune);
+            _reconsumeIn(State::ATTRIBUTE_VALUE_UNQUOTED, rune, isEof);
         }
 
         break;
@@ -1511,7 +1511,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // U+0022 QUOTATION MARK (")
         // Switch to the after attribute value (quoted) state.
         if (rune == '"') {
-            _lastAttr().value = _builder.take();
+            _lastAttr().value = _takeBuilder();
             _switchTo(State::AFTER_ATTRIBUTE_VALUE_QUOTED);
         }
 
@@ -1556,7 +1556,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // U+0027 APOSTROPHE (')
         // Switch to the after attribute value (quoted) state.
         if (rune == '\'') {
-            _lastAttr().value = _builder.take();
+            _lastAttr().value = _takeBuilder();
             _switchTo(State::AFTER_ATTRIBUTE_VALUE_QUOTED);
         }
 
@@ -1603,7 +1603,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // U+0020 SPACE
         // Switch to the before attribute name state.
         if (rune == '\t' or rune == '\n' or rune == '\f' or rune == ' ') {
-            _lastAttr().value = _builder.take();
+            _lastAttr().value = _takeBuilder();
             _switchTo(State::BEFORE_ATTRIBUTE_NAME);
         }
 
@@ -1618,7 +1618,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // U+003E GREATER-THAN SIGN (>)
         // Switch to the data state. Emit the current tag token.
         else if (rune == '>') {
-            _lastAttr().value = _builder.take();
+            _lastAttr().value = _takeBuilder();
             _switchTo(State::DATA);
             _emit();
         }
@@ -1700,7 +1700,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Reconsume in the before attribute name state.
         else {
             _raise("missing-whitespace-between-attributes");
-            _reconsumeIn(State::BEFORE_ATTRIBUTE_NAME, rune);
+            _reconsumeIn(State::BEFORE_ATTRIBUTE_NAME, rune, isEof);
         }
 
         break;
@@ -1732,7 +1732,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // the before attribute name state.
         else {
             _raise("unexpected-solidus-in-tag");
-            _reconsumeIn(State::BEFORE_ATTRIBUTE_NAME, rune);
+            _reconsumeIn(State::BEFORE_ATTRIBUTE_NAME, rune, isEof);
         }
 
         break;
@@ -1744,7 +1744,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // U+003E GREATER-THAN SIGN (>)
         // Switch to the data state. Emit the current comment token.
         if (rune == '>') {
-            _ensure(HtmlToken::COMMENT).data = _builder.take();
+            _ensure(HtmlToken::COMMENT).data = _takeBuilder();
             _switchTo(State::DATA);
             _emit();
         }
@@ -1827,7 +1827,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
             _temp.clear();
             _raise("incorrectly-opened-comment");
             _begin(HtmlToken::COMMENT);
-            _reconsumeIn(State::BOGUS_COMMENT, rune);
+            _reconsumeIn(State::BOGUS_COMMENT, rune, isEof);
         }
         break;
     }
@@ -1854,7 +1854,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Anything else
         // Reconsume in the comment state.
         else {
-            _reconsumeIn(State::COMMENT, rune);
+            _reconsumeIn(State::COMMENT, rune, isEof);
         }
 
         break;
@@ -1894,7 +1894,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // data. Reconsume in the comment state.
         else {
             _builder.append('-');
-            _reconsumeIn(State::COMMENT, rune);
+            _reconsumeIn(State::COMMENT, rune, isEof);
         }
 
         break;
@@ -1967,7 +1967,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Anything else
         // Reconsume in the comment state.
         else {
-            _reconsumeIn(State::COMMENT, rune);
+            _reconsumeIn(State::COMMENT, rune, isEof);
         }
 
         break;
@@ -1986,7 +1986,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Anything else
         // Reconsume in the comment state.
         else {
-            _reconsumeIn(State::COMMENT, rune);
+            _reconsumeIn(State::COMMENT, rune, isEof);
         }
 
         break;
@@ -2005,7 +2005,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Anything else
         // Reconsume in the comment end dash state.
         else {
-            _reconsumeIn(State::COMMENT_END_DASH, rune);
+            _reconsumeIn(State::COMMENT_END_DASH, rune, isEof);
         }
 
         break;
@@ -2019,7 +2019,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // EOF
         // Reconsume in the comment end state.
         if (rune == '>' or isEof) {
-            _reconsumeIn(State::COMMENT_END, rune);
+            _reconsumeIn(State::COMMENT_END, rune, isEof);
         }
 
         // Anything else
@@ -2027,7 +2027,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // end state.
         else {
             _raise("nested-comment");
-            _reconsumeIn(State::COMMENT_END, rune);
+            _reconsumeIn(State::COMMENT_END, rune, isEof);
         }
 
         break;
@@ -2058,7 +2058,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // data. Reconsume in the comment state.
         else {
             _builder.append('-');
-            _reconsumeIn(State::COMMENT, rune);
+            _reconsumeIn(State::COMMENT, rune, isEof);
         }
 
         break;
@@ -2104,7 +2104,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _builder.append('-');
             _builder.append('-');
-            _reconsumeIn(State::COMMENT, rune);
+            _reconsumeIn(State::COMMENT, rune, isEof);
         }
 
         break;
@@ -2152,7 +2152,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
             _builder.append('-');
             _builder.append('-');
             _builder.append('!');
-            _reconsumeIn(State::COMMENT, rune);
+            _reconsumeIn(State::COMMENT, rune, isEof);
         }
 
         break;
@@ -2174,7 +2174,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // U+003E GREATER-THAN SIGN (>)
         // Reconsume in the before DOCTYPE name state.
         else if (rune == '>') {
-            _reconsumeIn(State::BEFORE_DOCTYPE_NAME, rune);
+            _reconsumeIn(State::BEFORE_DOCTYPE_NAME, rune, isEof);
         }
 
         // EOF
@@ -2195,7 +2195,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Reconsume in the before DOCTYPE name state.
         else {
             _raise("missing-whitespace-before-doctype-name");
-            _reconsumeIn(State::BEFORE_DOCTYPE_NAME, rune);
+            _reconsumeIn(State::BEFORE_DOCTYPE_NAME, rune, isEof);
         }
 
         break;
@@ -2282,14 +2282,14 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // U+0020 SPACE
         // Switch to the after DOCTYPE name state.
         if (rune == '\t' or rune == '\n' or rune == '\f' or rune == ' ') {
-            _ensure(HtmlToken::DOCTYPE).name = _builder.take();
+            _ensure(HtmlToken::DOCTYPE).name = _takeBuilder();
             _switchTo(State::AFTER_DOCTYPE_NAME);
         }
 
         // U+003E GREATER-THAN SIGN (>)
         // Switch to the data state. Emit the current DOCTYPE token.
         else if (rune == '>') {
-            _ensure(HtmlToken::DOCTYPE).name = _builder.take();
+            _ensure(HtmlToken::DOCTYPE).name = _takeBuilder();
             _switchTo(State::DATA);
             _emit();
         }
@@ -2389,7 +2389,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _raise("invalid-character-sequence-after-doctype-name");
             _ensure(HtmlToken::DOCTYPE).forceQuirks = true;
-            _reconsumeIn(State::BOGUS_DOCTYPE, rune);
+            _reconsumeIn(State::BOGUS_DOCTYPE, rune, isEof);
         }
 
         break;
@@ -2458,7 +2458,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _raise("missing-quote-before-doctype-public-identifier");
             _ensure(HtmlToken::DOCTYPE).forceQuirks = true;
-            _reconsumeIn(State::BOGUS_DOCTYPE, rune);
+            _reconsumeIn(State::BOGUS_DOCTYPE, rune, isEof);
         }
 
         break;
@@ -2523,7 +2523,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _raise("missing-quote-before-doctype-public-identifier");
             _ensure(HtmlToken::DOCTYPE).forceQuirks = true;
-            _reconsumeIn(State::BOGUS_DOCTYPE, rune);
+            _reconsumeIn(State::BOGUS_DOCTYPE, rune, isEof);
         }
 
         break;
@@ -2536,7 +2536,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // U+0022 QUOTATION MARK (")
         // Switch to the after DOCTYPE public identifier state.
         if (rune == '"') {
-            _ensure(HtmlToken::DOCTYPE).publicIdent = _builder.take();
+            _ensure(HtmlToken::DOCTYPE).publicIdent = _takeBuilder();
             _switchTo(State::AFTER_DOCTYPE_PUBLIC_IDENTIFIER);
         }
 
@@ -2555,7 +2555,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // data state. Emit the current DOCTYPE token.
         else if (rune == '>') {
             _raise("abrupt-doctype-public-identifier");
-            _ensure(HtmlToken::DOCTYPE).publicIdent = _builder.take();
+            _ensure(HtmlToken::DOCTYPE).publicIdent = _takeBuilder();
             _ensure(HtmlToken::DOCTYPE).forceQuirks = true;
             _switchTo(State::DATA);
             _emit();
@@ -2590,7 +2590,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // U+0027 APOSTROPHE (')
         // Switch to the after DOCTYPE public identifier state.
         if (rune == '\'') {
-            _ensure(HtmlToken::DOCTYPE).publicIdent = _builder.take();
+            _ensure(HtmlToken::DOCTYPE).publicIdent = _takeBuilder();
             _switchTo(State::AFTER_DOCTYPE_PUBLIC_IDENTIFIER);
         }
 
@@ -2609,7 +2609,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // data state. Emit the current DOCTYPE token.
         else if (rune == '>') {
             _raise("abrupt-doctype-public-identifier");
-            _ensure(HtmlToken::DOCTYPE).publicIdent = _builder.take();
+            _ensure(HtmlToken::DOCTYPE).publicIdent = _takeBuilder();
             _ensure(HtmlToken::DOCTYPE).forceQuirks = true;
             _switchTo(State::DATA);
             _emit();
@@ -2698,7 +2698,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _raise("missing-quote-before-doctype-system-identifier");
             _ensure(HtmlToken::DOCTYPE).forceQuirks = true;
-            _reconsumeIn(State::BOGUS_DOCTYPE, rune);
+            _reconsumeIn(State::BOGUS_DOCTYPE, rune, isEof);
         }
 
         break;
@@ -2759,7 +2759,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _raise("missing-quote-before-doctype-system-identifier");
             _ensure(HtmlToken::DOCTYPE).forceQuirks = true;
-            _reconsumeIn(State::BOGUS_DOCTYPE, rune);
+            _reconsumeIn(State::BOGUS_DOCTYPE, rune, isEof);
         }
 
         break;
@@ -2828,7 +2828,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _raise("missing-quote-before-doctype-system-identifier");
             _ensure(HtmlToken::DOCTYPE).forceQuirks = true;
-            _reconsumeIn(State::BOGUS_DOCTYPE, rune);
+            _reconsumeIn(State::BOGUS_DOCTYPE, rune, isEof);
         }
 
         break;
@@ -2893,7 +2893,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _raise("missing-quote-before-doctype-system-identifier");
             _ensure(HtmlToken::DOCTYPE).forceQuirks = true;
-            _reconsumeIn(State::BOGUS_DOCTYPE, rune);
+            _reconsumeIn(State::BOGUS_DOCTYPE, rune, isEof);
         }
 
         break;
@@ -3041,7 +3041,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // set the current DOCTYPE token's force-quirks flag to on.)
         else {
             _raise("unexpected-character-after-doctype-system-identifier");
-            _reconsumeIn(State::BOGUS_DOCTYPE, rune);
+            _reconsumeIn(State::BOGUS_DOCTYPE, rune, isEof);
         }
 
         break;
@@ -3128,7 +3128,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // the CDATA section state.
         else {
             _emit(']');
-            _reconsumeIn(State::CDATA_SECTION, rune);
+            _reconsumeIn(State::CDATA_SECTION, rune, isEof);
         }
 
         break;
@@ -3156,7 +3156,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _emit(']');
             _emit(']');
-            _reconsumeIn(State::CDATA_SECTION, rune);
+            _reconsumeIn(State::CDATA_SECTION, rune, isEof);
         }
 
         break;
@@ -3174,7 +3174,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // ASCII alphanumeric
         // Reconsume in the named character reference state.
         if (isAsciiAlphaNum(rune)) {
-            _reconsumeIn(State::NAMED_CHARACTER_REFERENCE, rune);
+            _reconsumeIn(State::NAMED_CHARACTER_REFERENCE, rune, isEof);
         }
 
         // U+0023 NUMBER SIGN (#)
@@ -3191,14 +3191,13 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // the return state.
         else {
             _flushCodePointsConsumedAsACharacterReference();
-            _reconsumeIn(_returnState, rune);
+            _reconsumeIn(_returnState, rune, isEof);
         }
 
         break;
     }
 
     case State::NAMED_CHARACTER_REFERENCE: {
-        notImplemented();
         // 13.2.5.73 MARK: Named character reference state
 
         // Consume the maximum number of characters possible, where the
@@ -3206,29 +3205,98 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // column of the named character references table. Append each
         // character to the temporary buffer when it's consumed.
 
+        // NOTE: Runes come in one at a time, so they are accumulated in the
+        //       temporary buffer for as long as they could be part of a name,
+        //       then the longest prefix that is a name is looked up.
+        if (isAsciiAlphaNum(rune) and _temp.len() < MAX_ENTITY_LEN) {
+            _temp.append(rune);
+            break;
+        }
+
+        bool consumed = rune == ';';
+        if (consumed)
+            _temp.append(rune);
+
+        Str name = _temp.str();
+        usize matched = name.len();
+        Opt<Pair<Rune>> runes = NONE;
+        while (matched > 1) {
+            runes = ENTITIES.get(sub(name, 0, matched));
+            if (runes)
+                break;
+            matched--;
+        }
+
         // If there is a match
-        // If the character reference was consumed as part of an attribute,
-        // and the last character matched is not a U+003B SEMICOLON
-        // character (;), and the next input character is either a U+003D
-        // EQUALS SIGN character (=) or an ASCII alphanumeric, then, for
-        // historical reasons, flush code points consumed as a character
-        // reference and switch to the return state.
+        if (runes) {
+            // NOTE: The runes past the match are not part of the
+            //       reference, they go back to the return state.
+            String rest = sub(name, matched, name.len());
+            Rune next = rest.len() ? rest[0] : rune;
+            bool semicolon = name[matched - 1] == ';';
+
+            // If the character reference was consumed as part of an attribute,
+            // and the last character matched is not a U+003B SEMICOLON
+            // character (;), and the next input character is either a U+003D
+            // EQUALS SIGN character (=) or an ASCII alphanumeric, then, for
+            // historical reasons, flush code points consumed as a character
+            // reference and switch to the return state.
+            if (_consumedAsPartOfAnAttribute() and
+                not semicolon and
+                (next == '=' or isAsciiAlphaNum(next))) {
+                _flushCodePointsConsumedAsACharacterReference();
+                _switchTo(_returnState);
+                if (not consumed)
+                    consume(rune, isEof);
+                break;
+            }
+
+            // Otherwise:
 
-        // Otherwise:
+            // If the last character matched is not a U+003B SEMICOLON character
+            // (;), then this is a missing-semicolon-after-character-reference
+            // parse error.
+            if (not semicolon)
+                _raise("missing-semicolon-after-character-reference");
 
-        // If the last character matched is not a U+003B SEMICOLON character
-        // (;), then this is a missing-semicolon-after-character-reference
-        // parse error.
+            // Set the temporary buffer to the empty string. Append one or two
+            // characters corresponding to the character reference name (as
+            // given by the second column of the named character references
+            // table) to the temporary buffer.
+            _temp.clear();
+            _temp.append(runes->car);
+            if (runes->cdr)
+                _temp.append(runes->cdr);
 
-        // Set the temporary buffer to the empty string. Append one or two
-        // characters corresponding to the character reference name (as
-        // given by the second column of the named character references
-        // table) to the temporary buffer.
+            // Flush code points consumed as a character reference. Switch to
+            // the return state.
+            _flushCodePointsConsumedAsACharacterReference();
+            _switchTo(_returnState);
 
+            for (auto r : iterRunes(rest))
+                consume(r);
+            if (not consumed)
+                consume(rune, isEof);
+        }
+
+        // Otherwise
         // Flush code points consumed as a character reference. Switch to
-        // the return state. Otherwise Flush code points consumed as a
-        // character reference. Switch to the ambiguous ampersand state. If
-        // the markup contains (not in an attribute) the string I'm &notit;
+        // the ambiguous ampersand state.
+        else {
+            _flushCodePointsConsumedAsACharacterReference();
+
+            // NOTE: The ambiguous ampersand state would have let
+            //       the semicolon through to the return state.
+            if (consumed) {
+                _raise("unknown-named-character-reference");
+                _switchTo(_returnState);
+            } else {
+                _switchTo(State::AMBIGUOUS_AMPERSAND);
+                consume(rune, isEof);
+            }
+        }
+
+        // If the markup contains (not in an attribute) the string I'm &notit;
         // I tell you, the character reference is parsed as "not", as in,
         // I'm ¬it; I tell you (and this is a parse error). But if the
         // markup was I'm &notin; I tell you, the character reference would
@@ -3251,9 +3319,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // attribute's value. Otherwise, emit the current input character as
         // a character token.
         if (isAsciiAlphaNum(rune)) {
-            if (_returnState == State::ATTRIBUTE_VALUE_DOUBLE_QUOTED ||
-                _returnState == State::ATTRIBUTE_VALUE_SINGLE_QUOTED ||
-                _returnState == State::ATTRIBUTE_VALUE_UNQUOTED) {
+            if (_consumedAsPartOfAnAttribute()) {
                 _builder.append(rune);
             } else {
                 _emit(rune);
@@ -3265,13 +3331,13 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Reconsume in the return state.
         else if (rune == ';') {
             _raise("unknown-named-character-reference");
-            _reconsumeIn(_returnState, rune);
+            _reconsumeIn(_returnState, rune, isEof);
         }
 
         // Anything else
         // Reconsume in the return state.
         else {
-            _reconsumeIn(_returnState, rune);
+            _reconsumeIn(_returnState, rune, isEof);
         }
 
         break;
@@ -3280,6 +3346,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
     case State::NUMERIC_CHARACTER_REFERENCE: {
         // 13.2.5.75 MARK: Numeric character reference state
         // Set the character reference code to zero (0).
+        _currChar = 0;
 
         // Consume the next input character:
 
@@ -3288,13 +3355,14 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Append the current input character to the temporary buffer.
         // Switch to the hexadecimal character reference start state.
         if (rune == 'x' or rune == 'X') {
+            _temp.append(rune);
             _switchTo(State::HEXADECIMAL_CHARACTER_REFERENCE_START);
         }
 
         // Anything else
         // Reconsume in the decimal character reference start state.
         else {
-            _reconsumeIn(State::DECIMAL_CHARACTER_REFERENCE_START, rune);
+            _reconsumeIn(State::DECIMAL_CHARACTER_REFERENCE_START, rune, isEof);
         }
 
         break;
@@ -3307,7 +3375,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // ASCII hex digit
         // Reconsume in the hexadecimal character reference state.
         if (isAsciiHexDigit(rune)) {
-            _reconsumeIn(State::HEXADECIMAL_CHARACTER_REFERENCE, rune);
+            _reconsumeIn(State::HEXADECIMAL_CHARACTER_REFERENCE, rune, isEof);
         }
 
         // Anything else
@@ -3317,7 +3385,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _raise("absence-of-digits-in-numeric-character-reference");
             _flushCodePointsConsumedAsACharacterReference();
-            _reconsumeIn(_returnState, rune);
+            _reconsumeIn(_returnState, rune, isEof);
         }
 
         break;
@@ -3330,7 +3398,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // ASCII digit
         // Reconsume in the decimal character reference state.
         if (isAsciiDigit(rune)) {
-            _reconsumeIn(State::DECIMAL_CHARACTER_REFERENCE, rune);
+            _reconsumeIn(State::DECIMAL_CHARACTER_REFERENCE, rune, isEof);
         }
 
         // Anything else
@@ -3340,7 +3408,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         else {
             _raise("absence-of-digits-in-numeric-character-reference");
             _flushCodePointsConsumedAsACharacterReference();
-            _reconsumeIn(_returnState, rune);
+            _reconsumeIn(_returnState, rune, isEof);
         }
 
         break;
@@ -3355,7 +3423,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // version of the current input character (subtract 0x0030 from the
         // character's code point) to the character reference code.
         if (isAsciiDigit(rune)) {
-            _currChar = _currChar * 16 + rune - '0';
+            _currChar = min(_currChar * 16 + rune - '0', 0x110000u);
         }
 
         // ASCII upper hex digit
@@ -3364,7 +3432,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // (subtract 0x0037 from the character's code point) to the
         // character reference code.
         else if (isAsciiUpper(rune)) {
-            _currChar = _currChar * 16 + rune - '7';
+            _currChar = min(_currChar * 16 + rune - '7', 0x110000u);
         }
 
         // ASCII lower hex digit
@@ -3373,7 +3441,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // (subtract 0x0057 from the character's code point) to the
         // character reference code.
         else if (isAsciiLower(rune)) {
-            _currChar = _currChar * 16 + rune - 'W';
+            _currChar = min(_currChar * 16 + rune - 'W', 0x110000u);
         }
 
         // U+003B SEMICOLON
@@ -3387,7 +3455,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // error. Reconsume in the numeric character reference end state.
         else {
             _raise("missing-semicolon-after-character-reference");
-            _reconsumeIn(State::NUMERIC_CHARACTER_REFERENCE_END, rune);
+            _reconsumeIn(State::NUMERIC_CHARACTER_REFERENCE_END, rune, isEof);
         }
 
         break;
@@ -3402,7 +3470,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // version of the current input character (subtract 0x0030 from the
         // character's code point) to the character reference code.
         if (isAsciiDigit(rune)) {
-            _currChar = _currChar * 10 + rune - '0';
+            _currChar = min(_currChar * 10 + rune - '0', 0x110000u);
         }
 
         // U+003B SEMICOLON
@@ -3416,7 +3484,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // error. Reconsume in the numeric character reference end state.
         else {
             _raise("missing-semicolon-after-character-reference");
-            _reconsumeIn(State::NUMERIC_CHARACTER_REFERENCE_END, rune);
+            _reconsumeIn(State::NUMERIC_CHARACTER_REFERENCE_END, rune, isEof);
         }
 
         break;
@@ -3436,7 +3504,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // If the number is greater than 0x10FFFF, then this is a
         // character-reference-outside-unicode-range parse error. Set the
         // character reference code to 0xFFFD.
-        else if (isUnicode(rune)) {
+        else if (_currChar > 0x10FFFF) {
             _raise("character-reference-outside-unicode-range");
             _currChar = 0xFFFD;
         }
@@ -3444,7 +3512,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // If the number is a surrogate, then this is a
         // surrogate-character-reference parse error. Set the character
         // reference code to 0xFFFD.
-        else if (isUnicodeSurrogate(rune)) {
+        else if (isUnicodeSurrogate(_currChar)) {
             _raise("surrogate-character-reference");
             _currChar = 0xFFFD;
         }
@@ -3539,7 +3607,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         _temp.clear();
         _temp.append(_currChar);
         _flushCodePointsConsumedAsACharacterReference();
-        _switchTo(_returnState);
+        _reconsumeIn(_returnState, rune, isEof);
 
         break;
     }
@@ -4006,7 +4074,7 @@ void HtmlParser::_handleBeforeHead(HtmlToken const &t) {
     else {
         HtmlToken headToken;
         headToken.type = HtmlToken::START_TAG;
-        headToken.name = String{"head"};
+        headToken.name = "head"s;
         _headElement = insertHtmlElement(*this, headToken);
         _switchTo(Mode::IN_HEAD);
         accept(t);
@@ -4220,7 +4288,7 @@ void HtmlParser::_handleAfterHead(HtmlToken const &t) {
     auto anythingElse = [&] {
         HtmlToken bodyToken;
         bodyToken.type = HtmlToken::START_TAG;
-        bodyToken.name = String{"body"};
+        bodyToken.name = "body"s;
         insertHtmlElement(*this, bodyToken);
         _switchTo(Mode::IN_BODY);
         accept(t);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/arena.h>
 #include <karm-base/ctype.h>
 #include <karm-base/func.h>
 #include <karm-base/res.h>
@@ -33,18 +34,20 @@ struct HtmlToken {
             _LEN,
     };
 
+    // NOTE: Strings and attributes live in the arena of the
+    //       lexer and are only valid until the next token is emitted.
     struct Attr {
-        String name{};
-        String value{};
+        Str name{};
+        Str value{};
     };
 
     Type type = NIL;
-    String name;
+    Str name;
     Rune rune = '\0';
-    String data;
-    String publicIdent;
-    String systemIdent;
-    Vec<Attr> attrs;
+    Str data;
+    Str publicIdent;
+    Str systemIdent;
+    ArenaVec<Attr> attrs;
     bool forceQuirks{false};
     bool selfClosing{false};
 
@@ -101,12 +104,28 @@ struct HtmlLexer {
     StringBuilder _builder;
     StringBuilder _temp;
 
+    // Tokens are built in the two arenas in turn, so that the
+    // last emitted token stays valid while the next one is built.
+    Array<Arena, 2> _arenas{};
+    usize _emitted = 0;
+
+    Arena &_arena() {
+        return _arenas[_emitted % 2];
+    }
+
     HtmlToken &_begin(HtmlToken::Type type) {
         _token = HtmlToken{};
         _token->type = type;
+        _token->attrs = ArenaBuf<HtmlToken::Attr>{_arena()};
         return *_token;
     }
 
+    Str _takeBuilder() {
+        auto str = _arena().copy(_builder.str());
+        _builder.clear();
+        return str;
+    }
+
     HtmlToken &_ensure() {
         if (not _token)
             panic("unexpected-token");
@@ -125,6 +144,8 @@ struct HtmlLexer {
             panic("no sink");
         _sink->accept(_ensure());
         _last = std::move(_token);
+        _emitted++;
+        _arena().reset();
     }
 
     void _emit(Rune rune) {
@@ -143,9 +164,9 @@ struct HtmlLexer {
         return last(token.attrs);
     }
 
-    void _reconsumeIn(State state, Rune rune) {
+    void _reconsumeIn(State state, Rune rune, bool isEof) {
         _switchTo(state);
-        consume(rune);
+        consume(rune, isEof);
     }
 
     void _switchTo(State state) {
@@ -160,8 +181,21 @@ struct HtmlLexer {
         return _last->name == _token->name;
     }
 
+    bool _consumedAsPartOfAnAttribute() const {
+        return _returnState == State::ATTRIBUTE_VALUE_DOUBLE_QUOTED or
+               _returnState == State::ATTRIBUTE_VALUE_SINGLE_QUOTED or
+               _returnState == State::ATTRIBUTE_VALUE_UNQUOTED;
+    }
+
+    // https://html.spec.whatwg.org/multipage/parsing.html#flush-code-points-consumed-as-a-character-reference
     void _flushCodePointsConsumedAsACharacterReference() {
-        debug("flushing code points consumed as a character reference");
+        if (_consumedAsPartOfAnAttribute()) {
+            _builder.append(_temp.str());
+            return;
+        }
+
+        for (auto r : iterRunes(_temp.str()))
+            _emit(r);
     }
 
     void bind(HtmlSink &sink) {
@@ -266,8 +300,13 @@ struct HtmlParser : public HtmlSink {
     void accept(HtmlToken const &t) override;
 
     void write(Str str) {
-        for (auto r : iterRunes(str))
-            _lexer.consume(r);
+        Cursor<Utf8::Unit> in{str};
+        Array<Rune, 256> runes;
+        while (not in.ended()) {
+            usize n = Utf8::decode(in, runes);
+            for (usize i = 0; i < n; i++)
+                _lexer.consume(runes[i]);
+        }
     }
 };
 
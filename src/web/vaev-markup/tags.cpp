@@ -1,3 +1,5 @@
+#include <karm-base/phf.h>
+
 #include "tags.h"
 
 namespace Vaev::Html {
@@ -26,25 +28,24 @@ Str _attrName(AttrId id) {
     }
 }
 
-Opt<TagId> _tagId(Str name) {
-#define TAG(IDENT, NAME) \
-    if (name == #NAME)   \
-        return TagId::IDENT;
+static constexpr PerfectMap _TAG_IDS = Array{
+#define TAG(IDENT, NAME) Cons<Str, TagId>{#NAME, TagId::IDENT},
 #include "defs/ns-html-tag-names.inc"
 #undef TAG
+};
 
-    return NONE;
+Opt<TagId> _tagId(Str name) {
+    return _TAG_IDS.get(name);
 }
 
-Opt<AttrId> _attrId(Str name) {
-#define ATTR(IDENT, NAME) \
-    if (name == #NAME)    \
-        return AttrId::IDENT;
-
+static constexpr PerfectMap _ATTR_IDS = Array{
+#define ATTR(IDENT, NAME) Cons<Str, AttrId>{#NAME, AttrId::IDENT},
 #include "defs/ns-html-attr-names.inc"
 #undef ATTR
+};
 
-    return NONE;
+Opt<AttrId> _attrId(Str name) {
+    return _ATTR_IDS.get(name);
 }
 
 } // namespace Vaev::Html
@@ -75,25 +76,24 @@ Str _attrName(AttrId id) {
     }
 }
 
-Opt<TagId> _tagId(Str name) {
-#define TAG(IDENT, NAME) \
-    if (name == #NAME)   \
-        return TagId::IDENT;
+static constexpr PerfectMap _TAG_IDS = Array{
+#define TAG(IDENT, NAME) Cons<Str, TagId>{#NAME, TagId::IDENT},
 #include "defs/ns-mathml-tag-names.inc"
 #undef TAG
+};
 
-    return NONE;
+Opt<TagId> _tagId(Str name) {
+    return _TAG_IDS.get(name);
 }
 
-Opt<AttrId> _attrId(Str name) {
-#define ATTR(IDENT, NAME) \
-    if (name == #NAME)    \
-        return AttrId::IDENT;
-
+static constexpr PerfectMap _ATTR_IDS = Array{
+#define ATTR(IDENT, NAME) Cons<Str, AttrId>{#NAME, AttrId::IDENT},
 #include "defs/ns-mathml-attr-names.inc"
 #undef ATTR
+};
 
-    return NONE;
+Opt<AttrId> _attrId(Str name) {
+    return _ATTR_IDS.get(name);
 }
 
 } // namespace Vaev::MathMl
@@ -124,25 +124,24 @@ Str _attrName(AttrId id) {
     }
 }
 
-Opt<TagId> _tagId(Str name) {
-#define TAG(IDENT, NAME) \
-    if (name == #NAME)   \
-        return TagId::IDENT;
+static constexpr PerfectMap _TAG_IDS = Array{
+#define TAG(IDENT, NAME) Cons<Str, TagId>{#NAME, TagId::IDENT},
 #include "defs/ns-svg-tag-names.inc"
 #undef TAG
+};
 
-    return NONE;
+Opt<TagId> _tagId(Str name) {
+    return _TAG_IDS.get(name);
 }
 
-Opt<AttrId> _attrId(Str name) {
-#define ATTR(IDENT, NAME) \
-    if (name == #NAME)    \
-        return AttrId::IDENT;
-
+static constexpr PerfectMap _ATTR_IDS = Array{
+#define ATTR(IDENT, NAME) Cons<Str, AttrId>{#NAME, AttrId::IDENT},
 #include "defs/ns-svg-attr-names.inc"
 #undef ATTR
+};
 
-    return NONE;
+Opt<AttrId> _attrId(Str name) {
+    return _ATTR_IDS.get(name);
 }
 
 } // namespace Vaev::Svg
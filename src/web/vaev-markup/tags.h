@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/hash.h>
 #include <karm-base/string.h>
 #include <karm-io/emit.h>
 
@@ -119,6 +120,10 @@ struct Ns {
         }
     }
 
+    Hash hash() const {
+        return Karm::hash(_id);
+    }
+
     constexpr bool operator==(Ns const &other) const {
         return _id == other._id;
     }
@@ -256,6 +261,10 @@ struct AttrName {
 
     constexpr bool operator==(AttrName const &other) const = default;
 
+    Hash hash() const {
+        return Karm::hash(id, ns);
+    }
+
     void repr(Io::Emit &e) const {
         e("{}", name());
     }
@@ -0,0 +1,105 @@
+#include <karm-test/macros.h>
+#include <vaev-markup/html.h>
+
+namespace Vaev::Markup::Tests {
+
+// Collects the characters and the attribute values the lexer emits.
+struct TestSink : public HtmlSink {
+    StringBuilder text;
+    Vec<String> values;
+    bool ended = false;
+
+    void accept(HtmlToken const &token) override {
+        if (token.type == HtmlToken::CHARACTER)
+            text.append(token.rune);
+        else if (token.type == HtmlToken::START_TAG)
+            for (auto const &attr : token.attrs)
+                values.pushBack(attr.value);
+        else if (token.type == HtmlToken::END_OF_FILE)
+            ended = true;
+    }
+};
+
+static void _lex(TestSink &sink, Str str) {
+    HtmlLexer lexer;
+    lexer.bind(sink);
+    for (auto rune : iterRunes(str))
+        lexer.consume(rune);
+
+    // NOTE: NULL is checked for before EOF, so the end of
+    //       input comes with a rune that can't be in it.
+    lexer.consume(static_cast<Rune>(-1), true);
+}
+
+static String _lexText(Str str) {
+    TestSink sink;
+    _lex(sink, str);
+    return sink.text.take();
+}
+
+static String _lexAttr(Str str) {
+    TestSink sink;
+    _lex(sink, str);
+    if (sink.values.len() != 1)
+        return ""s;
+    return sink.values[0];
+}
+
+test$("html-lexer-named-reference") {
+    expectEq$(_lexText("&amp;"), "&"s);
+    expectEq$(_lexText("a&lt;b&gt;c"), "a<b>c"s);
+    expectEq$(_lexText("&NotEqualTilde;"), "≂̸"s);
+    expectEq$(_lexText("&unknown;"), "&unknown;"s);
+    expectEq$(_lexText("&"), "&"s);
+    expectEq$(_lexText("& b"), "& b"s);
+    return Ok();
+}
+
+test$("html-lexer-named-reference-longest-prefix") {
+    expectEq$(_lexText("I'm &notit; I tell you"), "I'm ¬it; I tell you"s);
+    expectEq$(_lexText("I'm &notin; I tell you"), "I'm ∉ I tell you"s);
+    expectEq$(_lexText("&ampx"), "&x"s);
+    return Ok();
+}
+
+test$("html-lexer-named-reference-in-attribute") {
+    expectEq$(_lexAttr("<a href=\"?a=1&amp;b=2\">"), "?a=1&b=2"s);
+    expectEq$(_lexAttr("<a href=\"?a=1&amp=2\">"), "?a=1&amp=2"s);
+    expectEq$(_lexAttr("<a href=\"?a=1&ampx=2\">"), "?a=1&ampx=2"s);
+    expectEq$(_lexAttr("<a title='&amp b'>"), "& b"s);
+    expectEq$(_lexAttr("<a title=&amp>"), "&"s);
+    return Ok();
+}
+
+test$("html-lexer-numeric-reference") {
+    expectEq$(_lexText("&#65;"), "A"s);
+    expectEq$(_lexText("&#x41;&#X61;"), "Aa"s);
+    expectEq$(_lexText("&#65 b"), "A b"s);
+    expectEq$(_lexText("&#x20AC;"), "€"s);
+    expectEq$(_lexText("&#;"), "&#;"s);
+    expectEq$(_lexText("&#x;"), "&#x;"s);
+    return Ok();
+}
+
+test$("html-lexer-numeric-reference-replacement") {
+    expectEq$(_lexText("&#x110000;"), "�"s);
+    expectEq$(_lexText("&#99999999999999999999;"), "�"s);
+    expectEq$(_lexText("&#xD800;"), "�"s);
+    expectEq$(_lexText("&#0;"), "�"s);
+    return Ok();
+}
+
+test$("html-lexer-reference-at-end-of-input") {
+    TestSink sink;
+    _lex(sink, "a&amp");
+    expectEq$(sink.text.take(), "a&"s);
+    expect$(sink.ended);
+
+    expectEq$(_lexText("&notit"), "¬it"s);
+    expectEq$(_lexText("&#65"), "A"s);
+    expectEq$(_lexText("&#x"), "&#x"s);
+    expectEq$(_lexText("a&"), "a&"s);
+    return Ok();
+}
+
+} // namespace Vaev::Markup::Tests
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/atom.h>
 #include <karm-base/cow.h>
 #include <vaev-base/align.h>
 #include <vaev-base/background.h>
@@ -66,7 +67,7 @@ struct Computed {
     Cow<FlexProps> flex;
     Cow<BreakProps> break_;
 
-    Cow<Map<String, Css::Content>> variables;
+    Cow<Map<Atom, Css::Content>> variables;
 
     Float float_ = Float::NONE;
     Clear clear = Clear::NONE;
@@ -112,11 +113,11 @@ struct Computed {
         e(")");
     }
 
-    void setCustomProp(Str varName, Css::Content value) {
+    void setCustomProp(Atom varName, Css::Content value) {
         variables.cow().put(varName, value);
     }
 
-    Css::Content getCustomProp(Str varName) const {
+    Css::Content getCustomProp(Atom varName) const {
         auto value = variables->access(varName);
         if (value)
             return *value;
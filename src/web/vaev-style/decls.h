@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/phf.h>
 #include <vaev-css/parser.h>
 #include <vaev-style/styles.h>
 
@@ -79,6 +80,19 @@ static inline Res<P> _parseDefaulted(Css::Sst const &sst) {
     return res;
 }
 
+template <typename... Ts>
+static constexpr auto _propIndex(Union<Ts...> const *) {
+    Array<Str, sizeof...(Ts)> names = {Ts::name()...};
+    Array<Cons<Str, usize>, sizeof...(Ts)> entries{};
+    for (usize i = 0; i < names.len(); i++)
+        entries[i] = {names[i], i};
+    return PerfectMap{entries};
+}
+
+// Maps the name of each property of P to its index in the union.
+template <typename P>
+static constexpr auto PROP_INDEX = _propIndex(static_cast<P const *>(nullptr));
+
 template <typename P>
 Res<P> parseDeclaration(Css::Sst const &sst, bool allowDeferred = true) {
     if (sst != Css::Sst::DECL)
@@ -89,42 +103,37 @@ Res<P> parseDeclaration(Css::Sst const &sst, bool allowDeferred = true) {
 
     Res<P> resDecl = Error::invalidData("unknown declaration");
 
-    P::any(
-        Visitor{
-            [&](Meta::Type<CustomProp>) -> bool {
-                if constexpr (requires(P &p) { p.template unwrap<CustomProp>(); }) {
-                    if (startWith(sst.token.data, "--"s) == Match::NO) {
-                        return false;
-                    }
-
-                    resDecl = Ok(CustomProp(sst.token.data, sst.content));
-                    return true;
-                }
-                return false;
-            },
-            [&]<typename T>(Meta::Type<T>) -> bool {
-                if (sst.token != Css::Token::ident(T::name())) {
-                    return false;
-                }
-
-                resDecl = _parseDeclaration<P, T>(sst);
+    if constexpr (requires(P &p) { p.template unwrap<CustomProp>(); }) {
+        if (startWith(sst.token.data, "--"s) == Match::YES)
+            return Ok(CustomProp(sst.token.atom(), sst.content));
+    }
 
-                if constexpr (Meta::Constructible<P, DefaultedProp>) {
-                    if (not resDecl) {
-                        resDecl = _parseDefaulted<P>(sst);
+    auto index = PROP_INDEX<P>.get(sst.token.data);
+    if (index) {
+        P::any(
+            *index,
+            Visitor{
+                [&](Meta::Type<CustomProp>) {
+                    // Handled above, its name is only a placeholder
+                },
+                [&]<typename T>(Meta::Type<T>) {
+                    resDecl = _parseDeclaration<P, T>(sst);
+
+                    if constexpr (Meta::Constructible<P, DefaultedProp>) {
+                        if (not resDecl) {
+                            resDecl = _parseDefaulted<P>(sst);
+                        }
                     }
-                }
 
-                if constexpr (Meta::Constructible<P, DeferredProp>) {
-                    if (not resDecl and allowDeferred) {
-                        resDecl = Ok(_deferProperty<P>(sst));
+                    if constexpr (Meta::Constructible<P, DeferredProp>) {
+                        if (not resDecl and allowDeferred) {
+                            resDecl = Ok(_deferProperty<P>(sst));
+                        }
                     }
                 }
-
-                return true;
             }
-        }
-    );
+        );
+    }
 
     if (not resDecl)
         logWarnIf(DEBUG_DECL, "failed to parse declaration: {} - {}", sst, resDecl);
@@ -46,7 +46,7 @@ struct FontFace {
 struct FontFamilyDesc {
     String value = initial();
 
-    static Str name() { return "font-family"; }
+    static constexpr Str name() { return "font-family"; }
 
     static String initial() { return "serif"s; }
 
@@ -72,7 +72,7 @@ struct FontFamilyDesc {
 struct SrcDesc {
     Vec<FontSource> value;
 
-    static Str name() { return "src"; }
+    static constexpr Str name() { return "src"; }
 
     static auto initial() {
         return Vec<FontSource>{};
@@ -88,7 +88,7 @@ struct SrcDesc {
 struct FontStyleDesc {
     Union<None, FontStyle, Range<Angle>> value;
 
-    static Str name() { return "font-style"; }
+    static constexpr Str name() { return "font-style"; }
 
     static auto initial() { return FontStyle::NORMAL; }
 
@@ -124,7 +124,7 @@ struct FontStyleDesc {
 struct FontWeightDesc {
     Opt<Range<FontWeight>> value;
 
-    static Str name() { return "font-weight"; }
+    static constexpr Str name() { return "font-weight"; }
 
     static auto initial() { return FontWeight::NORMAL; }
 
@@ -157,7 +157,7 @@ struct FontWeightDesc {
 struct FontWidthDesc {
     Opt<Range<FontWidth>> value = initial();
 
-    static Str name() { return "font-width"; }
+    static constexpr Str name() { return "font-width"; }
 
     static Opt<Range<FontWidth>> initial() { return NONE; }
 
@@ -190,7 +190,7 @@ struct FontWidthDesc {
 struct UnicodeRangeDesc {
     Vec<Range<Rune>> value;
 
-    static Str name() { return "unicode-range"; }
+    static constexpr Str name() { return "unicode-range"; }
 
     static auto initial() {
         return Vec<Range<Rune>>{};
@@ -206,7 +206,7 @@ struct UnicodeRangeDesc {
 struct FontFeatureSettingsDesc {
     Vec<FontFeature> value;
 
-    static Str name() { return "font-feature-settings"; }
+    static constexpr Str name() { return "font-feature-settings"; }
 
     static Vec<FontFeature> initial() { return {}; }
 
@@ -220,7 +220,7 @@ struct FontFeatureSettingsDesc {
 struct FontVariationSettingsDesc {
     Vec<FontVariation> value;
 
-    static Str name() { return "font-variation-settings"; }
+    static constexpr Str name() { return "font-variation-settings"; }
 
     static Vec<FontVariation> initial() { return {}; }
 
@@ -234,7 +234,7 @@ struct FontVariationSettingsDesc {
 struct FontNamedInstanceDesc {
     Opt<String> value = initial();
 
-    static Str name() { return "font-named-instance"; }
+    static constexpr Str name() { return "font-named-instance"; }
 
     static Opt<String> initial() { return NONE; }
 
@@ -258,7 +258,7 @@ struct FontNamedInstanceDesc {
 struct FontDisplayDesc {
     FontDisplay value = initial();
 
-    static Str name() { return "font-display"; }
+    static constexpr Str name() { return "font-display"; }
 
     static FontDisplay initial() { return FontDisplay::AUTO; }
 
@@ -291,7 +291,7 @@ struct FontDisplayDesc {
 struct AscentOverrideDesc {
     Opt<Percent> value = initial();
 
-    static Str name() { return "ascent-override"; }
+    static constexpr Str name() { return "ascent-override"; }
 
     // NOTE: normal is NONE
     static Opt<Percent> initial() { return NONE; }
@@ -316,7 +316,7 @@ struct AscentOverrideDesc {
 struct DescentOverrideStyleProp {
     Opt<Percent> value = initial();
 
-    static Str name() { return "descent-override"; }
+    static constexpr Str name() { return "descent-override"; }
 
     // NOTE: normal is NONE
     static Opt<Percent> initial() { return NONE; }
@@ -341,7 +341,7 @@ struct DescentOverrideStyleProp {
 struct LineGapOverrideDesc {
     Opt<Percent> value = initial();
 
-    static Str name() { return "line-gap-override"; }
+    static constexpr Str name() { return "line-gap-override"; }
 
     static Opt<Percent> initial() { return NONE; }
 
@@ -365,7 +365,7 @@ struct LineGapOverrideDesc {
 struct SizeAdjustDesc {
     Percent value = initial();
 
-    static Str name() { return "size-adjust"; }
+    static constexpr Str name() { return "size-adjust"; }
 
     static Percent initial() { return Percent{100}; }
 
@@ -161,7 +161,7 @@ static bool _match(TypeSelector const &s, Markup::Element const &el) {
 }
 
 static bool _match(IdSelector const &s, Markup::Element const &el) {
-    return el.id() == s.id;
+    return el.idAtom == s.id;
 }
 
 static bool _match(ClassSelector const &s, Markup::Element const &el) {
@@ -463,7 +463,7 @@ static Res<Selector> _parseSelectorElement(Cursor<Css::Sst> &cur, OpCode current
         case Css::Token::DELIM:
             if (cur->token.data == ".") {
                 cur.next();
-                val = ClassSelector{cur->token.data};
+                val = ClassSelector{cur->token.atom()};
             } else if (cur->token.data == "*") {
                 val = UniversalSelector{};
             }
@@ -486,7 +486,7 @@ static Res<Selector> _parseSelectorElement(Cursor<Css::Sst> &cur, OpCode current
             }
             break;
         default:
-            val = ClassSelector{cur->token.data};
+            val = ClassSelector{cur->token.atom()};
             break;
         }
     } else if (cur->type == Css::Sst::BLOCK) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/atom.h>
 #include <karm-base/box.h>
 #include <karm-base/vec.h>
 #include <vaev-css/parser.h>
@@ -141,7 +142,7 @@ struct TypeSelector {
 };
 
 struct IdSelector {
-    String id;
+    Atom id;
 
     void repr(Io::Emit &e) const {
         e("#{}", id);
@@ -151,7 +152,7 @@ struct IdSelector {
 };
 
 struct ClassSelector {
-    String class_;
+    Atom class_;
 
     void repr(Io::Emit &e) const {
         e(".{}", class_);
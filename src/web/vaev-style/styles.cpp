@@ -8,7 +8,7 @@ static bool DEBUG_PROPS = false;
 
 // MARK: DeferredProp ----------------------------------------------------------
 
-bool DeferredProp::_expandVariable(Cursor<Css::Sst> &c, Map<String, Css::Content> const &env, Css::Content &out) {
+bool DeferredProp::_expandVariable(Cursor<Css::Sst> &c, Map<Atom, Css::Content> const &env, Css::Content &out) {
     if (not(c->type == Css::Sst::FUNC and
             c->prefix == Css::Token::function("var(")))
         return false;
@@ -22,11 +22,13 @@ bool DeferredProp::_expandVariable(Cursor<Css::Sst> &c, Map<String, Css::Content
     if (content.peek() != Css::Token::IDENT)
         return true;
 
-    Str varName = content->token.data;
-    if (auto ref = env.access(varName)) {
-        Cursor<Css::Sst> varContent = *ref;
-        _expandContent(varContent, env, out);
-        return true;
+    // A name that was never interned can't have been defined
+    if (auto varName = Atom::lookup(content->token.data)) {
+        if (auto ref = env.access(*varName)) {
+            Cursor<Css::Sst> varContent = *ref;
+            _expandContent(varContent, env, out);
+            return true;
+        }
     }
     content.next();
 
@@ -39,7 +41,7 @@ bool DeferredProp::_expandVariable(Cursor<Css::Sst> &c, Map<String, Css::Content
     return true;
 }
 
-bool DeferredProp::_expandFunction(Cursor<Css::Sst> &c, Map<String, Css::Content> const &env, Css::Content &out) {
+bool DeferredProp::_expandFunction(Cursor<Css::Sst> &c, Map<Atom, Css::Content> const &env, Css::Content &out) {
     if (c->type != Css::Sst::FUNC)
         return false;
 
@@ -51,7 +53,7 @@ bool DeferredProp::_expandFunction(Cursor<Css::Sst> &c, Map<String, Css::Content
     return true;
 }
 
-void DeferredProp::_expandContent(Cursor<Css::Sst> &c, Map<String, Css::Content> const &env, Css::Content &out) {
+void DeferredProp::_expandContent(Cursor<Css::Sst> &c, Map<Atom, Css::Content> const &env, Css::Content &out) {
     // NOTE: Hint that we will add all the remaining elements
     out.ensure(out.len() + c.rem());
 
@@ -83,31 +85,26 @@ void DeferredProp::apply(Computed const &parent, Computed &c) const {
 // MARK: DefaultedProp ---------------------------------------------------------
 
 void DefaultedProp::apply(Computed const &parent, Computed &c) const {
+    auto index = PROP_INDEX<StyleProp>.get(propName);
+    if (not index)
+        return;
+
     if (value == Default::INITIAL) {
-        StyleProp::any([&]<typename T>(Meta::Type<T>) {
-            if (T::name() != propName)
-                return false;
+        StyleProp::any(*index, [&]<typename T>(Meta::Type<T>) {
             if constexpr (requires { T::initial(); })
                 StyleProp{T{T::initial()}}.apply(parent, c);
-            return true;
         });
     } else if (value == Default::INHERIT) {
-        StyleProp::any([&]<typename T>(Meta::Type<T>) {
-            if (T::name() != propName)
-                return false;
+        StyleProp::any(*index, [&]<typename T>(Meta::Type<T>) {
             if constexpr (requires { T::load(parent); })
                 StyleProp{T{T::load(parent)}}.apply(parent, c);
-            return true;
         });
     } else if (value == Default::UNSET) {
-        StyleProp::any([&]<typename T>(Meta::Type<T>) {
-            if (T::name() != propName)
-                return false;
+        StyleProp::any(*index, [&]<typename T>(Meta::Type<T>) {
             if constexpr (requires { T::inherit;  T::load(parent); })
                 StyleProp{T{T::load(parent)}}.apply(parent, c);
             else if constexpr (requires { T::initial(); })
                 StyleProp{T{T::initial()}}.apply(parent, c);
-            return true;
         });
     } else {
         logDebug("defaulted: unsupported value '{}'", value);
@@ -1772,7 +1772,7 @@ struct LineHeightProp {
 struct MarginTopProp {
     Width value = initial();
 
-    static Str name() { return "margin-top"; }
+    static constexpr Str name() { return "margin-top"; }
 
     static Width initial() { return Length{}; }
 
@@ -1793,7 +1793,7 @@ struct MarginTopProp {
 struct MarginRightProp {
     Width value = initial();
 
-    static Str name() { return "margin-right"; }
+    static constexpr Str name() { return "margin-right"; }
 
     static Width initial() { return Length{}; }
 
@@ -1835,7 +1835,7 @@ struct MarginBottomProp {
 struct MarginLeftProp {
     Width value = initial();
 
-    static Str name() { return "margin-left"; }
+    static constexpr Str name() { return "margin-left"; }
 
     static Width initial() { return Length{}; }
 
@@ -1856,7 +1856,7 @@ struct MarginLeftProp {
 struct MarginProp {
     Math::Insets<Width> value = initial();
 
-    static Str name() { return "margin"; }
+    static constexpr Str name() { return "margin"; }
 
     static Math::Insets<Width> initial() { return {}; }
 
@@ -1879,7 +1879,7 @@ struct MarginProp {
 struct MarginInlineStartProp {
     Width value = initial();
 
-    static Str name() { return "margin-inline-start"; }
+    static constexpr Str name() { return "margin-inline-start"; }
 
     static Width initial() { return Length{}; }
 
@@ -1901,7 +1901,7 @@ struct MarginInlineStartProp {
 struct MarginInlineEndProp {
     Width value = initial();
 
-    static Str name() { return "margin-inline-end"; }
+    static constexpr Str name() { return "margin-inline-end"; }
 
     static Width initial() { return Length{}; }
 
@@ -1923,7 +1923,7 @@ struct MarginInlineEndProp {
 struct MarginInlineProp {
     Math::Insets<Width> value = initial();
 
-    static Str name() { return "margin-inline"; }
+    static constexpr Str name() { return "margin-inline"; }
 
     static Math::Insets<Width> initial() { return {}; }
 
@@ -1949,7 +1949,7 @@ struct MarginInlineProp {
 struct MarginBlockStartProp {
     Width value = initial();
 
-    static Str name() { return "margin-block-start"; }
+    static constexpr Str name() { return "margin-block-start"; }
 
     static Width initial() { return Length{}; }
 
@@ -1971,7 +1971,7 @@ struct MarginBlockStartProp {
 struct MarginBlockEndProp {
     Width value = initial();
 
-    static Str name() { return "margin-block-end"; }
+    static constexpr Str name() { return "margin-block-end"; }
 
     static Width initial() { return Length{}; }
 
@@ -1993,7 +1993,7 @@ struct MarginBlockEndProp {
 struct MarginBlockProp {
     Math::Insets<Width> value = initial();
 
-    static Str name() { return "margin-block"; }
+    static constexpr Str name() { return "margin-block"; }
 
     static Math::Insets<Width> initial() { return {}; }
 
@@ -2021,7 +2021,7 @@ struct MarginBlockProp {
 struct OpacityProp {
     Number value = initial();
 
-    static Str name() { return "opacity"; }
+    static constexpr Str name() { return "opacity"; }
 
     static f64 initial() { return 1; }
 
@@ -2050,7 +2050,7 @@ struct OpacityProp {
 struct OverflowXProp {
     Overflow value = initial();
 
-    static Str name() { return "overflow-x"; }
+    static constexpr Str name() { return "overflow-x"; }
 
     static Overflow initial() { return Overflow::VISIBLE; }
 
@@ -2072,7 +2072,7 @@ struct OverflowXProp {
 struct OverflowYProp {
     Overflow value = initial();
 
-    static Str name() { return "overflow-y"; }
+    static constexpr Str name() { return "overflow-y"; }
 
     static Overflow initial() { return Overflow::VISIBLE; }
 
@@ -2094,7 +2094,7 @@ struct OverflowYProp {
 struct OverflowBlockProp {
     Overflow value = initial();
 
-    static Str name() { return "overflow-block"; }
+    static constexpr Str name() { return "overflow-block"; }
 
     static Overflow initial() { return Overflow::VISIBLE; }
 
@@ -2116,7 +2116,7 @@ struct OverflowBlockProp {
 struct OverflowInlineProp {
     Overflow value = initial();
 
-    static Str name() { return "overflow-inline"; }
+    static constexpr Str name() { return "overflow-inline"; }
 
     static Overflow initial() { return Overflow::VISIBLE; }
 
@@ -2141,7 +2141,7 @@ struct OverflowInlineProp {
 struct PaddingTopProp {
     CalcValue<PercentOr<Length>> value = initial();
 
-    static Str name() { return "padding-top"; }
+    static constexpr Str name() { return "padding-top"; }
 
     static Length initial() { return Length{}; }
 
@@ -2162,7 +2162,7 @@ struct PaddingTopProp {
 struct PaddingRightProp {
     CalcValue<PercentOr<Length>> value = initial();
 
-    static Str name() { return "padding-right"; }
+    static constexpr Str name() { return "padding-right"; }
 
     static Length initial() { return Length{}; }
 
@@ -2183,7 +2183,7 @@ struct PaddingRightProp {
 struct PaddingBottomProp {
     CalcValue<PercentOr<Length>> value = initial();
 
-    static Str name() { return "padding-bottom"; }
+    static constexpr Str name() { return "padding-bottom"; }
 
     static Length initial() { return Length{}; }
 
@@ -2204,7 +2204,7 @@ struct PaddingBottomProp {
 struct PaddingLeftProp {
     CalcValue<PercentOr<Length>> value = initial();
 
-    static Str name() { return "padding-left"; }
+    static constexpr Str name() { return "padding-left"; }
 
     static Length initial() { return {}; }
 
@@ -2225,7 +2225,7 @@ struct PaddingLeftProp {
 struct PaddingProp {
     Math::Insets<CalcValue<PercentOr<Length>>> value = initial();
 
-    static Str name() { return "padding"; }
+    static constexpr Str name() { return "padding"; }
 
     static Math::Insets<CalcValue<PercentOr<Length>>> initial() { return {}; }
 
@@ -2247,7 +2247,7 @@ struct PaddingProp {
 struct OrderProp {
     Integer value = initial();
 
-    static Str name() { return "order"; }
+    static constexpr Str name() { return "order"; }
 
     static Integer initial() { return 0; }
 
@@ -2271,7 +2271,7 @@ struct OrderProp {
 struct PositionProp {
     Position value = initial();
 
-    static Str name() { return "position"; }
+    static constexpr Str name() { return "position"; }
 
     static Position initial() { return Position::STATIC; }
 
@@ -2293,7 +2293,7 @@ struct PositionProp {
 struct TopProp {
     Width value = initial();
 
-    static Str name() { return "top"; }
+    static constexpr Str name() { return "top"; }
 
     static Width initial() { return Width::AUTO; }
 
@@ -2315,7 +2315,7 @@ struct TopProp {
 struct RightProp {
     Width value = initial();
 
-    static Str name() { return "right"; }
+    static constexpr Str name() { return "right"; }
 
     static Width initial() { return Width::AUTO; }
 
@@ -2337,7 +2337,7 @@ struct RightProp {
 struct BottomProp {
     Width value = initial();
 
-    static Str name() { return "bottom"; }
+    static constexpr Str name() { return "bottom"; }
 
     static Width initial() { return Width::AUTO; }
 
@@ -2359,7 +2359,7 @@ struct BottomProp {
 struct LeftProp {
     Width value = initial();
 
-    static Str name() { return "left"; }
+    static constexpr Str name() { return "left"; }
 
     static Width initial() { return Width::AUTO; }
 
@@ -2688,10 +2688,10 @@ struct ZIndexProp {
 // https://drafts.csswg.org/css-variables/#defining-variables
 // this symbolizes a custom property, it starts with `--` and can be used to store a value that can be reused in the stylesheet
 struct CustomProp {
-    String varName;
+    Atom varName;
     Css::Content value;
 
-    CustomProp(String varName, Css::Content value)
+    CustomProp(Atom varName, Css::Content value)
         : varName(varName), value(value) {
     }
 
@@ -2714,11 +2714,11 @@ struct DeferredProp {
 
     static constexpr Str name() { return "deferred prop"; }
 
-    static bool _expandVariable(Cursor<Css::Sst> &c, Map<String, Css::Content> const &env, Css::Content &out);
+    static bool _expandVariable(Cursor<Css::Sst> &c, Map<Atom, Css::Content> const &env, Css::Content &out);
 
-    static bool _expandFunction(Cursor<Css::Sst> &c, Map<String, Css::Content> const &env, Css::Content &out);
+    static bool _expandFunction(Cursor<Css::Sst> &c, Map<Atom, Css::Content> const &env, Css::Content &out);
 
-    static void _expandContent(Cursor<Css::Sst> &c, Map<String, Css::Content> const &env, Css::Content &out);
+    static void _expandContent(Cursor<Css::Sst> &c, Map<Atom, Css::Content> const &env, Css::Content &out);
 
     // static void inherit(Computed const &parent, Computed &child) {
     //     child.variables = parent.variables;